@@ -0,0 +1,52 @@
+// Heap-allocated array with a controlled alignment. The benchmarks use it instead of stack VLAs
+// so that aligned loads are well-defined and sizes are not capped by the stack limit.
+//
+// data() is the start of an `alignment`-aligned block plus `offset` bytes. With offset 0 the
+// address is aligned to at least `alignment`; a non-zero offset deliberately misaligns the data,
+// e.g. alignment 4096 and offset 4 makes every other 32-byte load split a cache line.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+template <class T>
+class aligned_buffer {
+ public:
+  explicit aligned_buffer(std::size_t n, std::size_t alignment = 64, std::size_t offset = 0) : size_(n) {
+    if (alignment < alignof(T) || (alignment & (alignment - 1)) != 0)
+      throw std::invalid_argument("aligned_buffer: alignment must be a power of two >= alignof(T)");
+    if (offset % alignof(T) != 0)
+      throw std::invalid_argument("aligned_buffer: offset must keep elements naturally aligned");
+
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    std::size_t bytes = (offset + n * sizeof(T) + alignment - 1) / alignment * alignment;
+    void* p = std::aligned_alloc(alignment, bytes ? bytes : alignment);
+    if (!p) throw std::bad_alloc();
+    memory_.reset(static_cast<std::byte*>(p));
+    data_ = reinterpret_cast<T*>(memory_.get() + offset);
+  }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+  T& operator[](std::size_t i) { return data_[i]; }
+  const T& operator[](std::size_t i) const { return data_[i]; }
+
+ private:
+  struct free_deleter {
+    void operator()(std::byte* p) const { std::free(p); }
+  };
+
+  std::unique_ptr<std::byte[], free_deleter> memory_;
+  T* data_;
+  std::size_t size_;
+};
+
+} // namespace
@@ -0,0 +1,76 @@
+//TO COMPILE: ./build-all.sh
+
+// The main of all-backends, which links the benchmarks of every backend file into one executable
+// (see backend-registry.h) and controls the noise around them (see runner.h). It pins itself to a
+// quiet CPU, records the governor and turbo state, waits for the clock to settle, and turns on
+// --benchmark_enable_random_interleaving unless told otherwise: the repetitions of all selected
+// benchmarks then run in a shuffled order instead of one benchmark's back to back, so slow drift in
+// clock speed and temperature spreads over every backend rather than favouring whichever ran first.
+//
+//   ./all-backends --benchmark_filter='^(intrinsics|xsimd)/BM_AddVectors/' --runner_out_dir=.
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "backend-registry.h"
+#include "cycle-timer.h"
+#include "perf-counters.h"
+#include "runner.h"
+
+// The state every backend shares lives in this file, built with baseline flags: the backend list
+// here, and through the two headers above the tsc and perf_counters context lines.
+std::vector<std::string>& Backends() {
+  static std::vector<std::string> names;
+  return names;
+}
+
+bool RegisterBackend(const char* name) {
+  Backends().push_back(name);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  RunnerOptions options = ParseRunnerFlags(&argc, argv);
+  std::vector<char*> args(argv, argv + argc);
+  char interleave[] = "--benchmark_enable_random_interleaving=true";
+  bool has_interleave = false;
+  for (char* arg : args)
+    has_interleave |= std::strncmp(arg, "--benchmark_enable_random_interleaving", 38) == 0;
+  if (!has_interleave) args.push_back(interleave);
+  argc = int(args.size());
+  args.push_back(nullptr);
+  argv = args.data();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+  std::vector<int> cpus = PinToCpus(options);
+  std::string governor = Governors(cpus.empty() ? ParseCpuList(ReadSysfs("/sys/devices/system/cpu/online")) : cpus);
+  std::string turbo = TurboState();
+  bool quiet = governor == "performance" && turbo != "on";
+  if (!quiet) {
+    std::fprintf(stderr, "***WARNING*** governor %s, turbo %s: expect frequency noise.\n", governor.c_str(), turbo.c_str());
+    if (options.require_quiet) return 1;
+  }
+  double settled = WarmUp(options.warmup_max);
+
+  std::string backends;
+  for (const std::string& name : Backends())
+    backends += (backends.empty() ? "" : ",") + name;
+  benchmark::AddCustomContext("backends", backends);
+  benchmark::AddCustomContext("cpus", cpus.empty() ? "not pinned" : FormatCpuList(cpus));
+  benchmark::AddCustomContext("governor", governor);
+  benchmark::AddCustomContext("turbo", turbo);
+  benchmark::AddCustomContext("warmup", settled < 0 ? "not settled after " + std::to_string(options.warmup_max) + " s" : "settled after " + std::to_string(settled) + " s");
+
+  if (options.out_dir.empty()) {
+    benchmark::RunSpecifiedBenchmarks();
+  } else {
+    BackendFilesReporter reporter(options.out_dir);
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+  }
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,56 @@
+// Registration of a backend's benchmarks, in its own executable or in the all-backends one.
+//
+// Built on its own as in its //TO COMPILE: line, a backend file is one executable whose benchmarks
+// keep their plain names, as in the *-data files. build-all.sh instead compiles every backend file
+// with its own flags plus -DBENCH_BACKEND='"<backend>"' and links them into one executable,
+// all-backends. There each file registers its benchmarks as <backend>/<name>, for example
+// intrinsics/BM_AddVectors/avx2/1/2/3/4, so one --benchmark_filter picks backends and kernels
+// together, and its BACKEND_MAIN() adds the backend to Backends() instead of defining main.
+//
+// The backend files keep their code in an anonymous namespace, so their identically named
+// benchmarks and helpers do not collide when linked together. The helper headers they share
+// (bench-utils.h, validate.h, perf-counters.h, cycle-timer.h, aligned-buffer.h) do the same: each
+// backend is compiled with other -march and vectorizer flags, and one inline definition shared by
+// all of them would leave the linker to pick a single backend's code for everyone. Only the list
+// below and the context lines those headers record live once, in all-backends.cpp.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// The backends linked into this executable, in the order their files were initialized. Defined in
+// all-backends.cpp, the one file built with baseline flags, so that all backends share one list.
+std::vector<std::string>& Backends();
+bool RegisterBackend(const char* name);
+
+#ifdef BENCH_BACKEND
+
+// For benchmarks that set their name with ->Name(BENCH_NAME("BM_X")).
+#define BENCH_NAME(name) BENCH_BACKEND "/" name
+
+// Google Benchmark's own BENCHMARK and BENCHMARK_CAPTURE, with the backend in front of the name.
+#undef BENCHMARK
+#define BENCHMARK(...)                                               \
+  BENCHMARK_PRIVATE_DECLARE(_benchmark_) =                           \
+      (::benchmark::internal::RegisterBenchmarkInternal(             \
+          new ::benchmark::internal::FunctionBenchmark(BENCH_BACKEND "/" #__VA_ARGS__, \
+                                                       &__VA_ARGS__)))
+
+#undef BENCHMARK_CAPTURE
+#define BENCHMARK_CAPTURE(func, test_case_name, ...)     \
+  BENCHMARK_PRIVATE_DECLARE(func) =                      \
+      (::benchmark::internal::RegisterBenchmarkInternal( \
+          new ::benchmark::internal::FunctionBenchmark(  \
+              BENCH_BACKEND "/" #func "/" #test_case_name, \
+              [](::benchmark::State& st) { func(st, __VA_ARGS__); })))
+
+#define BACKEND_MAIN() static const bool kBackendRegistered BENCHMARK_UNUSED = RegisterBackend(BENCH_BACKEND)
+
+#else
+
+#define BENCH_NAME(name) name
+#define BACKEND_MAIN() BENCHMARK_MAIN()
+
+#endif
@@ -0,0 +1,447 @@
+// Benchmark helpers shared by every backend.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <sched.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "aligned-buffer.h"
+#include "backend-registry.h"
+#include "cycle-timer.h"
+#include "perf-counters.h"
+#include "validate.h"
+
+namespace {
+
+// Working-set sweep from 1 KiB (fits in L1) to 1 GiB (DRAM) of int, in steps of 4x. Register it
+// with ->Apply(FindSweep) or ->Apply(RangeSweep) next to the fixed 4096-element arguments.
+constexpr int64_t kSweepMinBytes = int64_t(1) << 10;
+constexpr int64_t kSweepMaxBytes = int64_t(1) << 30;
+
+// {target, N, position} with the target in the last element, so every size is a full scan.
+inline void FindSweep(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes = kSweepMinBytes; bytes <= kSweepMaxBytes; bytes *= 4) {
+    int64_t n = bytes / sizeof(int);
+    b->Args({456, n, n - 1});
+  }
+}
+
+// {start, end} for the iota-filled kernels.
+inline void RangeSweep(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes = kSweepMinBytes; bytes <= kSweepMaxBytes; bytes *= 4)
+    b->Args({0, int64_t(bytes / sizeof(int))});
+}
+
+// {start, end} for the cached versus non-temporal store comparison: 64 KiB to 512 MiB of T per
+// array in steps of 2x, finer than RangeSweep around the last-level cache size where they cross.
+template <class T>
+void StreamSweep(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes = int64_t(1) << 16; bytes <= int64_t(1) << 29; bytes *= 2)
+    b->Args({0, int64_t(bytes / sizeof(T))});
+}
+
+// Reports items/s and bytes/s. bytes is everything the kernel reads plus everything it writes in
+// one iteration, so an in-place reverse of N ints counts 8 * N.
+inline void SetThroughput(benchmark::State& state, int64_t items, int64_t bytes) {
+  state.SetItemsProcessed(state.iterations() * items);
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+// {alignment, offset, N} for the alignment benchmarks. The first block checks that the base
+// alignment alone makes no difference; the second misaligns a page-aligned buffer by offset bytes
+// (4, 16 and 60 split every other 32-byte load across cache lines, 32 splits only 64-byte loads,
+// and every non-zero offset splits each 64-byte load). N covers an L1-resident (16 KiB) and an
+// L2-resident (1 MiB) working set.
+inline void AlignmentArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {int64_t(4096), int64_t(1) << 18}) {
+    for (int64_t alignment : {16, 32, 64, 4096})
+      b->Args({alignment, 0, n});
+    for (int64_t offset : {4, 16, 32, 60})
+      b->Args({4096, offset, n});
+  }
+}
+
+// CPUs in the affinity mask of the calling thread, which taskset, cgroup cpusets and the pinning of
+// all-backends (runner.h) narrow, unlike std::thread::hardware_concurrency().
+inline int64_t AllowedCpus() {
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return std::max(1u, std::thread::hardware_concurrency());
+  return CPU_COUNT(&allowed);
+}
+
+// 1, 2, 4, ... threads up to every CPU the process may use, always including the full count.
+inline std::vector<int64_t> ThreadCounts() {
+  int64_t max_threads = AllowedCpus();
+  std::vector<int64_t> counts;
+  for (int64_t t = 1; t < max_threads; t *= 2)
+    counts.push_back(t);
+  counts.push_back(max_threads);
+  return counts;
+}
+
+// Thread-scaling benchmarks call `if (SkipOversubscribed(state, threads)) return;` first: with
+// fewer allowed CPUs than threads the workers would time-slice, and the run would be no scaling point.
+inline bool SkipOversubscribed(benchmark::State& state, int64_t threads) {
+  int64_t cpus = AllowedCpus();
+  if (threads <= cpus) return false;
+  state.SkipWithError(("needs " + std::to_string(threads) + " CPUs, the affinity mask allows " + std::to_string(cpus)).c_str());
+  return true;
+}
+
+// Match positions for the early-exit comparison: start, middle, end, and -1 for no match at all.
+inline std::vector<int64_t> MatchPositions(int64_t n) {
+  return {0, n / 2, n - 1, -1};
+}
+
+// Elements a first-match scan has to look at when the target sits at position (-1: absent).
+inline int64_t ScannedElements(int64_t position, int64_t n) {
+  return position < 0 ? n : position + 1;
+}
+
+// Inputs of the find scenario benchmarks. With the target at one fixed index the branch predictor
+// learns where the scan exits, and the result is that one case; here every iteration moves the
+// target to the next of kFindScenarioDraws placements drawn from a fixed seed, far more exit points
+// than the predictor can remember.
+//
+//   random_position  one target anywhere in the array, on a background of zeros: the expected case
+//   absent           no target, so every call scans the whole array: the worst case
+//   near_start       one target among the first kFindScenarioNearStart elements
+//   duplicates       kFindScenarioDuplicates targets anywhere; the first of them ends the scan
+//   random_data      one target anywhere, on random values instead of zeros
+enum class FindScenario { random_position, absent, near_start, duplicates, random_data };
+
+constexpr int kFindScenarioDraws = 4096;
+constexpr int kFindScenarioNearStart = 64;
+constexpr int kFindScenarioDuplicates = 8;
+
+// {target, N} for the scenarios: an L1-resident (16 KiB) and an L2-resident (1 MiB) array.
+inline void FindScenarioArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {int64_t(4096), int64_t(1) << 18})
+    b->Args({456, n});
+}
+
+// The array of a scenario. Call Next() in the timed loop before each call to the kernel; moving the
+// target costs a few stores, next to a scan of at least a few dozen elements.
+class FindScenarioInput {
+ public:
+  FindScenarioInput(FindScenario scenario, int target, int64_t n) : buffer_(n), target_(target) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> other(-1000, 1000);
+    for (int64_t i = 0; i < n; ++i) {
+      int x = scenario == FindScenario::random_data ? other(rng) : 0;
+      buffer_[i] = x == target ? x + 1 : x;
+    }
+
+    per_draw_ = scenario == FindScenario::absent || n == 0 ? 0 : scenario == FindScenario::duplicates ? kFindScenarioDuplicates : 1;
+    std::uniform_int_distribution<int64_t> position(0, (scenario == FindScenario::near_start ? std::min<int64_t>(n, kFindScenarioNearStart) : n) - 1);
+    positions_.resize(kFindScenarioDraws * per_draw_);
+    scanned_per_draw_.resize(kFindScenarioDraws);
+    for (int d = 0; d < kFindScenarioDraws; ++d) {
+      int64_t first = -1;
+      for (int k = 0; k < per_draw_; ++k) {
+        int64_t p = positions_[d * per_draw_ + k] = position(rng);
+        first = first < 0 ? p : std::min(first, p);
+      }
+      scanned_per_draw_[d] = ScannedElements(first, n);
+    }
+    saved_.resize(per_draw_);
+  }
+
+  int* data() { return buffer_.data(); }
+
+  // Puts back the elements the previous placement overwrote, in reverse so that a position drawn
+  // twice gets its background value, and writes the target at the next placement.
+  void Next() {
+    const int64_t* p = positions_.data() + draw_ * per_draw_;
+    if (calls_ > 0) {
+      for (int k = per_draw_ - 1; k >= 0; --k)
+        buffer_[p[k]] = saved_[k];
+    }
+    draw_ = calls_++ % kFindScenarioDraws;
+    p = positions_.data() + draw_ * per_draw_;
+    for (int k = 0; k < per_draw_; ++k) {
+      saved_[k] = buffer_[p[k]];
+      buffer_[p[k]] = target_;
+    }
+    scanned_ += scanned_per_draw_[draw_];
+  }
+
+  // Reports items/s and bytes/s for the elements the kernel had to look at, summed over every call,
+  // and their mean per call as the scanned counter.
+  void SetThroughput(benchmark::State& state) const {
+    state.SetItemsProcessed(scanned_);
+    state.SetBytesProcessed(scanned_ * int64_t(sizeof(int)));
+    state.counters["scanned"] = calls_ ? double(scanned_) / double(calls_) : 0;
+  }
+
+ private:
+  aligned_buffer<int> buffer_;
+  int target_;
+  int per_draw_;
+  std::vector<int64_t> positions_;  // per_draw_ positions for each draw
+  std::vector<int64_t> scanned_per_draw_;
+  std::vector<int> saved_;
+  int64_t draw_ = 0;
+  int64_t calls_ = 0;
+  int64_t scanned_ = 0;
+};
+
+// Thread-scaling arguments on arrays well past the LLC (16 MiB and 256 MiB of int), where a single
+// core cannot saturate the memory bandwidth. Find is {target, N, position, threads} for every
+// MatchPositions entry, the range kernels are {start, end, threads}.
+inline void ParallelFindArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {int64_t(1) << 22, int64_t(1) << 26}) {
+    for (int64_t position : MatchPositions(n)) {
+      for (int64_t threads : ThreadCounts())
+        b->Args({456, n, position, threads});
+    }
+  }
+}
+
+// The single-threaded baseline for ParallelFindArgs: {target, N, position}.
+inline void MatchPositionArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {int64_t(1) << 22, int64_t(1) << 26}) {
+    for (int64_t position : MatchPositions(n))
+      b->Args({456, n, position});
+  }
+}
+
+inline void ParallelRangeArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {int64_t(1) << 22, int64_t(1) << 26}) {
+    for (int64_t threads : ThreadCounts())
+      b->Args({0, n, threads});
+  }
+}
+
+// {target, N, matches per million} for the find-all benchmarks: selectivities from 0.01% to 100% on
+// an L2-resident (256 KiB) and an LLC-resident (16 MiB) array. Branchy code is fastest at either end
+// and mispredicts most around 50%.
+inline void SelectivityArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n : {int64_t(1) << 16, int64_t(1) << 22}) {
+    for (int64_t ppm : {100, 1000, 10000, 100000, 250000, 500000, 750000, 900000, 990000, 1000000})
+      b->Args({456, n, ppm});
+  }
+}
+
+// Each element is target with probability ppm / 10^6, otherwise a different value, from a fixed
+// seed. Returns the number of targets written.
+inline int64_t FillSelectivity(int* data, int64_t n, int target, int64_t ppm) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> draw(0, 999999);
+  std::uniform_int_distribution<int> other(1, 1000);
+  int64_t matches = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    bool hit = draw(rng) < ppm;
+    data[i] = hit ? target : target + other(rng);
+    matches += hit;
+  }
+  return matches;
+}
+
+// Find-all throughput plus the number of matches and the fraction of elements that matched.
+inline void SetSelectivityCounters(benchmark::State& state, int64_t n, int64_t matches) {
+  SetThroughput(state, n, n * sizeof(int) + matches * sizeof(uint32_t));
+  state.counters["matches"] = static_cast<double>(matches);
+  state.counters["selectivity"] = n ? static_cast<double>(matches) / n : 0;
+}
+
+// {K, N, position} for the multi-key find benchmarks: 1 to 64 keys on an L2-resident array, with the
+// last key at position (-1: none of them present). K = 8 is the largest set the vector kernels
+// still broadcast; from 16 on they go through the hash filter.
+inline void MembershipArgs(benchmark::internal::Benchmark* b) {
+  int64_t n = int64_t(1) << 16;
+  for (int64_t k : {1, 2, 4, 8, 16, 32, 64}) {
+    for (int64_t position : {n - 1, int64_t(-1)})
+      b->Args({k, n, position});
+  }
+}
+
+// The keys 1000, 1007, 1014, ... and a background of negative values from a fixed seed, so none of
+// them matches; keys[k - 1] is written at position unless it is -1.
+inline std::vector<int> FillMembership(int* data, int64_t n, int64_t k, int64_t position) {
+  std::vector<int> keys(k);
+  for (int64_t j = 0; j < k; ++j)
+    keys[j] = 1000 + 7 * j;
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> other(-1000000, -1);
+  for (int64_t i = 0; i < n; ++i)
+    data[i] = other(rng);
+  if (position >= 0) data[position] = keys[k - 1];
+  return keys;
+}
+
+// {N} for the sorted-search benchmarks: 16 keys to 64 MiB of keys in steps of 2x. The linear
+// scans stop at 64 KiB, well past the size where they lose to every tree search.
+inline void SortedSearchArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n = 16; n <= int64_t(1) << 24; n *= 2)
+    b->Args({n});
+}
+
+inline void LinearSearchArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t n = 16; n <= int64_t(1) << 14; n *= 2)
+    b->Args({n});
+}
+
+// Lookups per sorted-search iteration, so that one iteration is long enough to time.
+constexpr int64_t kSearchQueries = 1024;
+
+// The sorted keys 1, 3, 5, ... and kSearchQueries of them picked from a fixed seed, so every lookup
+// finds its key.
+inline std::vector<int> FillSortedSearch(int* data, int64_t n) {
+  for (int64_t i = 0; i < n; ++i)
+    data[i] = 2 * i + 1;
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> pick(0, n - 1);
+  std::vector<int> queries(kSearchQueries);
+  for (int& q : queries)
+    q = data[pick(rng)];
+  return queries;
+}
+
+// {N, position} for the byte-search benchmarks: 1 KiB to 64 MiB of text in steps of 4x, with the
+// delimiter or the last byte of the needle at the end, so every size is a full scan.
+inline void ByteSearchArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes = kSweepMinBytes; bytes <= int64_t(1) << 26; bytes *= 4)
+    b->Args({bytes, bytes - 1});
+}
+
+// The byte a memchr-style search looks for, and the needle of the substring searches. FillLogText
+// never writes the delimiter, but every needle byte is common in its output, so the first/last
+// byte filters see a realistic number of candidates.
+constexpr uint8_t kDelimiter = '\n';
+constexpr char kNeedle[] = "user=admin";
+constexpr int kNeedleSize = sizeof(kNeedle) - 1;
+
+// Log-like text from a fixed seed: lower-case letters, digits and " =:,.".
+inline void FillLogText(uint8_t* text, int64_t n) {
+  static constexpr char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 =:,.";
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> pick(0, sizeof(alphabet) - 2);
+  for (int64_t i = 0; i < n; ++i)
+    text[i] = alphabet[pick(rng)];
+}
+
+// Writes kNeedle so that it ends at text[end] and returns where it starts.
+inline int64_t PlaceNeedle(uint8_t* text, int64_t end) {
+  int64_t start = end - kNeedleSize + 1;
+  std::copy(kNeedle, kNeedle + kNeedleSize, text + start);
+  return start;
+}
+
+// Uniform values in [0, 1) from a fixed seed, the shape of a typical measurement column.
+template <class T>
+void FillColumn(T* data, int64_t n) {
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> value(0, 1);
+  for (int64_t i = 0; i < n; ++i)
+    data[i] = value(rng);
+}
+
+// Neumaier-compensated sum in long double, accurate far below float and double rounding.
+template <class T>
+long double ReferenceSum(const T* data, int64_t n) {
+  long double sum = 0, comp = 0;
+  for (int64_t i = 0; i < n; ++i) {
+    long double x = data[i];
+    long double t = sum + x;
+    comp += std::fabs(sum) >= std::fabs(x) ? (sum - t) + x : (x - t) + sum;
+    sum = t;
+  }
+  return sum + comp;
+}
+
+// Reports |result - reference| / |reference| as the rel_error counter.
+inline void SetRelativeError(benchmark::State& state, long double result, long double reference) {
+  long double error = reference != 0 ? std::fabs((result - reference) / reference) : std::fabs(result);
+  state.counters["rel_error"] = static_cast<double>(error);
+}
+
+// Values drawn uniformly from [start, end) with a fixed seed, converted to T. The running minimum
+// and maximum of random data only improve about ln(N) times, as in a real column; on iota data
+// every element would be a new maximum.
+template <class T>
+void FillRandomRange(T* data, int64_t start, int64_t end) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> value(start, end - 1);
+  for (int64_t i = 0; i < end - start; ++i)
+    data[i] = static_cast<T>(value(rng));
+}
+
+// Index of the first smallest (or largest) element, the reference for the min/max benchmarks.
+template <class T>
+int64_t ReferenceArgExtreme(const T* data, int64_t n, bool largest) {
+  return (largest ? std::max_element(data, data + n) : std::min_element(data, data + n)) - data;
+}
+
+// Row lengths in [0, 16) from a fixed seed, the input of an offsets-array prefix sum. The largest
+// RangeSweep array still totals less than 2^31, so no int32 scan overflows.
+inline void FillLengths(int* data, int64_t n) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> value(0, 15);
+  for (int64_t i = 0; i < n; ++i)
+    data[i] = value(rng);
+}
+
+// Checks out against a sequential prefix sum of in: int exactly, skipping the run with an error on
+// the first difference; float through the rel_error of the last output.
+template <class T>
+void CheckPrefixSum(benchmark::State& state, const T* in, const T* out, int64_t n, bool inclusive) {
+  if (n == 0) return;
+  if constexpr (std::is_integral_v<T>) {
+    int64_t acc = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      if (inclusive) acc += in[i];
+      if (out[i] != static_cast<T>(acc)) return state.SkipWithError("wrong prefix sum");
+      if (!inclusive) acc += in[i];
+    }
+  } else {
+    SetRelativeError(state, out[n - 1], ReferenceSum(in, inclusive ? n : n - 1));
+  }
+}
+
+// {N} doubles per array for the element-wise benchmarks (add, AXPY, FMA and triad): 2 KiB to
+// 128 MiB per array in steps of 4x, so their three or four arrays go from fitting in L1 to far
+// past the last-level cache.
+inline void ElementwiseSweep(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes = int64_t(1) << 11; bytes <= int64_t(1) << 27; bytes *= 4)
+    b->Args({bytes / int64_t(sizeof(double))});
+}
+
+// alpha of AXPY and q of the triad. AXPY updates y in place on every iteration; with x from
+// FillColumn it grows by less than 0.5 per call, far from any overflow.
+constexpr double kElementwiseScale = 0.5;
+
+// The operands of the element-wise benchmarks: a, b, c and out of n doubles each, from FillColumn.
+struct ElementwiseArrays {
+  explicit ElementwiseArrays(int64_t n) : a(n), b(n), c(n), out(n) {
+    FillColumn(a.data(), n);
+    FillColumn(b.data(), n);
+    FillColumn(c.data(), n);
+    FillColumn(out.data(), n);
+  }
+  aligned_buffer<double> a, b, c, out;
+};
+
+// Reports bytes/s and FLOP/s (the flops counter) of an element-wise kernel over n elements.
+// accesses is the arrays it reads plus the arrays it writes, so AXPY's y counts twice; as in STREAM,
+// the read-for-ownership of a separate output is left out. An FMA counts as two flops.
+inline void SetElementwiseCounters(benchmark::State& state, int64_t n, int64_t accesses, int64_t flops) {
+  SetThroughput(state, n, accesses * n * int64_t(sizeof(double)));
+  state.counters["flops"] = benchmark::Counter(double(flops * n) * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+// {N} records of 32 bytes (4 doubles or 8 floats) for the AoS/SoA layout benchmarks: 2 KiB to
+// 128 MiB of records in steps of 4x, the range of ElementwiseSweep.
+inline void RecordSweep(benchmark::internal::Benchmark* b) {
+  for (int64_t bytes = int64_t(1) << 11; bytes <= int64_t(1) << 27; bytes *= 4)
+    b->Args({bytes / 32});
+}
+
+} // namespace
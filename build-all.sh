@@ -0,0 +1,55 @@
+#!/bin/bash
+# Builds all-backends, one executable with the benchmarks of every backend (see backend-registry.h).
+# Each backend file is compiled on its own with the flags of its //TO COMPILE: line, so no-vec and
+# auto-vec still differ only in -ftree-vectorize, and then everything is linked together. The helper
+# headers every backend includes have internal linkage, so each object keeps the helpers compiled
+# with its own flags; all-backends.cpp, built with COMMON only, holds the little state they share.
+#
+#   ./build-all.sh                       every backend
+#   ./build-all.sh no-vec intrinsics     only these, e.g. where a library is not installed
+set -e
+COMMON="-isystem benchmark/include -std=c++2a -O3 -DNDEBUG"
+LIBS="-Lbenchmark/build/src -lbenchmark -lpthread"
+mkdir -p build-all
+
+declare -A FLAGS=(
+  [inline-asm]="-fno-tree-vectorize -march=native"
+  [intrinsics]="-fno-tree-vectorize"
+  [highway]="-fno-tree-vectorize -march=native -I. -I/usr/local/include/hwy"
+  [eve]="-fno-tree-vectorize -march=native -I/usr/local/include/eve"
+  [std::experimental::simd]="-fno-tree-vectorize -march=native"
+  [xsimd]="-fno-tree-vectorize -march=native -I/usr/local/include/xsimd"
+  [openmp-directives]="-fno-tree-vectorize -fopenmp -march=native"
+  [auto-vec]="-march=native -ftree-vectorize"
+  [no-vec]="-fno-tree-vectorize"
+)
+# The order of benchmark.sh, which is also the order the benchmarks run in.
+ALL=(inline-asm intrinsics highway eve std::experimental::simd xsimd openmp-directives auto-vec no-vec)
+BACKENDS=("${@:-${ALL[@]}}")
+
+OBJECTS=()
+for backend in "${BACKENDS[@]}"; do
+  if [ -z "${FLAGS[$backend]+set}" ]; then
+    echo "unknown backend: $backend" >&2
+    exit 1
+  fi
+  object="build-all/$(echo "$backend" | tr ':' '_').o"
+  g++ -c "$backend.cpp" $COMMON ${FLAGS[$backend]} -DBENCH_BACKEND="\"$backend\"" -o "$object" &
+  OBJECTS+=("$object")
+  case $backend in
+    intrinsics)
+      for kernels in kernels kernels-sse42 kernels-avx2 kernels-avx512 kernels-parallel kernels-search; do
+        g++ -c "$kernels.cpp" $COMMON ${FLAGS[intrinsics]} -o "build-all/$kernels.o" &
+        OBJECTS+=("build-all/$kernels.o")
+      done
+      ;;
+    highway) LIBS="$LIBS -lhwy" ;;
+    openmp-directives) LIBS="$LIBS -fopenmp" ;;
+  esac
+done
+g++ -c all-backends.cpp $COMMON -o build-all/all-backends.o &
+for job in $(jobs -p); do
+  wait "$job"
+done
+
+g++ build-all/all-backends.o "${OBJECTS[@]}" $LIBS -o all-backends
@@ -0,0 +1,123 @@
+// Call-by-call timing in TSC cycles, for kernels too short for per-iteration averages.
+//
+// BM_AddVectors takes 0.3 to 1.5 ns, a handful of cycles, and Google Benchmark reports the mean of
+// a loop whose own overhead is as large as the kernel. TimeCycles instead brackets every single call
+// with lfence; rdtsc and rdtscp; lfence, so no earlier instruction leaks into the timed region and
+// no later one starts before the second read. The median cost of an empty region, measured just
+// before the loop, is subtracted from every sample, and each run reports the distribution of the
+// rest as user counters:
+//
+//   call_cycles_{min,p10,p50,p90,p99,mean}     per call
+//   element_cycles_{min,p10,p50,p90,p99,mean}  the same divided by the elements of one call
+//   overhead_cycles                            what was subtracted
+//
+// The TSC ticks at the nominal frequency whatever the core clock does, so these are reference
+// cycles: with turbo on they undercount core cycles by the turbo ratio, the same for every backend.
+// The tsc context line says whether the TSC is invariant; when it is not, the counts also drift
+// with frequency changes. real_time and cpu_time of these runs include the fences and are not
+// comparable with the other benchmarks.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cpuid.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "perf-counters.h"
+
+namespace {
+
+// Samples, i.e. timed calls, per repetition. Register with ->Iterations(kCycleSamples).
+constexpr int64_t kCycleSamples = 100000;
+
+// Empty regions timed to estimate the harness overhead, after as many untimed warm-up ones.
+constexpr int kOverheadSamples = 10000;
+
+// rdtscp is in CPUID 0x80000001 EDX bit 27, the invariant TSC in 0x80000007 EDX bit 8.
+inline bool HasRdtscp() {
+  unsigned eax, ebx, ecx, edx;
+  return __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) && (edx & (1u << 27));
+}
+
+inline bool HasInvariantTsc() {
+  unsigned eax, ebx, ecx, edx;
+  return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8));
+}
+
+// Recorded by all-backends.cpp rather than by each backend file in all-backends, like perf_counters.
+#ifndef BENCH_BACKEND
+const bool kCycleTimerContext = (benchmark::AddCustomContext("tsc", !HasRdtscp() ? "no rdtscp, cycle benchmarks skipped" : HasInvariantTsc() ? "invariant" : "not invariant, cycle counts vary with frequency"), true);
+#endif
+
+// lfence waits for every earlier instruction to complete before rdtsc reads the counter, and the
+// asm is a compiler barrier for memory, so the kernel's loads cannot be hoisted above it.
+inline uint64_t CyclesBegin() {
+  uint32_t lo, hi;
+  asm volatile("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+  return (uint64_t(hi) << 32) | lo;
+}
+
+// rdtscp waits for the earlier instructions itself; the lfence keeps later ones from starting first.
+inline uint64_t CyclesEnd() {
+  uint32_t lo, hi;
+  asm volatile("rdtscp\n\tlfence" : "=a"(lo), "=d"(hi) : : "rcx", "memory");
+  return (uint64_t(hi) << 32) | lo;
+}
+
+// The q quantile of sorted samples, nearest rank.
+inline double Quantile(const std::vector<int64_t>& sorted, double q) {
+  return double(sorted[std::size_t(q * double(sorted.size() - 1) + 0.5)]);
+}
+
+// Runs the benchmark loop of state, timing each call to call() on its own. elements is the number
+// of elements one call processes, for the element_cycles counters.
+template <class F>
+void TimeCycles(benchmark::State& state, int64_t elements, F&& call) {
+  if (!HasRdtscp()) return state.SkipWithError("rdtscp not supported by this CPU");
+
+  // The first pass only warms up; the second overwrites it.
+  std::vector<int64_t> samples(kOverheadSamples);
+  for (int i = 0; i < kOverheadSamples; ++i) {
+    uint64_t start = CyclesBegin();
+    benchmark::ClobberMemory();
+    samples[i] = CyclesEnd() - start;
+  }
+  for (int i = 0; i < kOverheadSamples; ++i) {
+    uint64_t start = CyclesBegin();
+    benchmark::ClobberMemory();
+    samples[i] = CyclesEnd() - start;
+  }
+  std::nth_element(samples.begin(), samples.begin() + kOverheadSamples / 2, samples.end());
+  int64_t overhead = samples[kOverheadSamples / 2];
+
+  samples.clear();
+  samples.reserve(state.max_iterations);
+  for (auto _ : PerfLoop(state)) {
+    uint64_t start = CyclesBegin();
+    call();
+    uint64_t end = CyclesEnd();
+    samples.push_back(std::max<int64_t>(int64_t(end - start) - overhead, 0));
+  }
+  if (samples.empty()) return;
+
+  std::sort(samples.begin(), samples.end());
+  double mean = 0;
+  for (int64_t s : samples)
+    mean += double(s);
+  mean /= double(samples.size());
+
+  const std::pair<const char*, double> stats[] = {
+      {"min", double(samples.front())}, {"p10", Quantile(samples, 0.1)}, {"p50", Quantile(samples, 0.5)},
+      {"p90", Quantile(samples, 0.9)}, {"p99", Quantile(samples, 0.99)}, {"mean", mean},
+  };
+  for (const auto& [name, value] : stats) {
+    state.counters[std::string("call_cycles_") + name] = value;
+    state.counters[std::string("element_cycles_") + name] = value / double(elements);
+  }
+  state.counters["overhead_cycles"] = double(overhead);
+}
+
+} // namespace
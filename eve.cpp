@@ -1,162 +1,767 @@
 //TO COMPILE: g++ eve.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -march=native -DNDEBUG -I/usr/local/include/eve -o eve
 
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
 #include <algorithm>
 #include <eve/eve.hpp>
 #include <numeric>
 
+namespace {
+
+void AddVectors(const double* data_a, const double* data_b, double* result) {
+  eve::wide<double, eve::fixed<4>> a = {data_a[0], data_a[1], data_a[2], data_a[3]};
+  eve::wide<double, eve::fixed<4>> b = {data_b[0], data_b[1], data_b[2], data_b[3]};
+
+  eve::wide<double, eve::fixed<4>> res = eve::add(a, b);
+
+  for (int i = 0; i < res.size(); i++) {
+    result[i] = res.get(i);
+  }
+}
+
 void BM_AddVectors(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors)) return;
   double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double result[4];
 
-  for (auto _ : state) {
-    eve::wide<double, eve::fixed<4>> a = {data_a[0], data_a[1], data_a[2], data_a[3]};
-    eve::wide<double, eve::fixed<4>> b = {data_b[0], data_b[1], data_b[2], data_b[3]};
+  for (auto _ : PerfLoop(state)) {
+    AddVectors(data_a, data_b, result);
 
-    eve::wide<double, eve::fixed<4>> res = eve::add(a, b);
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
 
-    for (int i = 0; i < res.size(); i++) {
-      result[i] = res.get(i);
-    }
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors)) return;
+  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double result[4];
+
+  TimeCycles(state, 4, [&] {
+    AddVectors(data_a, data_b, result);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_AddVectorsCycles)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+int FindInVector(const int* vector, int N, int target) {
+  int res = -1;
+  eve::wide<int, eve::fixed<8>> simd_target(target);
+
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    eve::wide<int, eve::fixed<8>> simd_vector = eve::load(&vector[i]);
+    auto matches = simd_target == simd_vector;
+    if (eve::any(matches)) {
+      auto index = eve::first_true(matches);
+      res = i + *index;
+      break;
+    }
   }
+
+  // Scalar epilogue for the last N % 8 elements.
+  for (; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
+  }
+  return res;
 }
-BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
 
 void BM_FindInVector(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVector", FindInVector)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    eve::wide<int, eve::fixed<8>> simd_target(target);
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVector(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
 
-    for (int i = 0; i < N; i += 8) {
-      eve::wide<int, eve::fixed<8>> simd_vector = eve::load(&vector[i]);
-      auto matches = simd_target == simd_vector;
-      if (eve::any(matches)) {
-        auto index = eve::first_true(matches);
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVector)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+int FindInVectorFaster(const int* vector, int N, int target) {
+  int res = -1;
+  eve::wide<int, eve::fixed<8>> simd_target(target);
+
+  int i = 0;
+  for (; i + 32 <= N; i += 32) {
+    eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
+    eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[i + 8]);
+    eve::wide<int, eve::fixed<8>> simd_vector3 = eve::load(&vector[i + 16]);
+    eve::wide<int, eve::fixed<8>> simd_vector4 = eve::load(&vector[i + 24]);
+    auto mask1 = simd_vector1 == simd_target;
+    auto mask2 = simd_vector2 == simd_target;
+    auto mask12 = mask1 || mask2;
+    auto mask3 = simd_vector3 == simd_target;
+    auto mask4 = simd_vector4 == simd_target;
+    auto mask23 = mask3 || mask4;
+    auto mask = mask12 || mask23;
+    if (eve::any(mask)) {
+      if(eve::any(mask1)) {
+        auto index = eve::first_true(mask1);
         res = i + *index;
         break;
       }
+      if(eve::any(mask2)) {
+        auto index = eve::first_true(mask2);
+        res = i + *index + 8;
+        break;
+      }
+      if(eve::any(mask3)) {
+        auto index = eve::first_true(mask3);
+        res = i + *index + 16;
+        break;
+      }
+      if(eve::any(mask4)) {
+        auto index = eve::first_true(mask4);
+        res = i + *index + 24;
+        break;
+      }
     }
+  }
 
-    benchmark::DoNotOptimize(res);
-    benchmark::ClobberMemory();
+  // Scalar epilogue for the last N % 32 elements.
+  for (; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
   }
+  return res;
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_FindInVectorFaster(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    eve::wide<int, eve::fixed<8>> simd_target(target);
-
-    for (int i = 0; i < N; i += 32) {
-      eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
-      eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[i + 8]);
-      eve::wide<int, eve::fixed<8>> simd_vector3 = eve::load(&vector[i + 16]);
-      eve::wide<int, eve::fixed<8>> simd_vector4 = eve::load(&vector[i + 24]);
-      auto mask1 = simd_vector1 == simd_target;
-      auto mask2 = simd_vector2 == simd_target;
-      auto mask12 = mask1 || mask2;
-      auto mask3 = simd_vector3 == simd_target;
-      auto mask4 = simd_vector4 == simd_target;
-      auto mask23 = mask3 || mask4;
-      auto mask = mask12 || mask23;
-      if (eve::any(mask)) {
-        if(eve::any(mask1)) {
-          auto index = eve::first_true(mask1);
-          res = i + *index;
-          break;
-        }
-        if(eve::any(mask2)) {
-          auto index = eve::first_true(mask2);
-          res = i + *index + 8;
-          break;
-        }
-        if(eve::any(mask3)) {
-          auto index = eve::first_true(mask3);
-          res = i + *index + 16;
-          break;
-        }
-        if(eve::any(mask4)) {
-          auto index = eve::first_true(mask4);
-          res = i + *index + 24;
-          break;
-        }
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVectorFaster)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// The early-exit find on the FindScenario inputs, which move the target on every call so the exit
+// cannot be learned (see FindScenarioInput in bench-utils.h).
+void BM_FindInVectorScenario(benchmark::State& state, FindScenario scenario) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_position, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, absent, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, near_start, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, duplicates, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_data, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// memchr and a first/last-byte-filtered substring search over 32-byte wides. N counts bytes.
+using byte_wide = eve::wide<uint8_t, eve::fixed<32>>;
+
+int FindByte(const uint8_t* text, int N, uint8_t target) {
+  constexpr int L = byte_wide::size();
+  byte_wide simd_target(target);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto index = eve::first_true(byte_wide(&text[i]) == simd_target);
+    if (index) return i + *index;
+  }
+
+  // Scalar epilogue for the last N % 32 bytes.
+  for (; i < N; ++i) {
+    if (text[i] == target) return i;
+  }
+  return -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches M - 1
+// bytes further on; only those are compared in full.
+int FindSubstring(const uint8_t* text, int N, const uint8_t* needle, int M) {
+  if (M == 0) return 0;
+  constexpr int L = byte_wide::size();
+  byte_wide first(needle[0]);
+  byte_wide last(needle[M - 1]);
+  int i = 0;
+
+  for (; i + M - 1 + L <= N; i += L) {
+    auto mask = (byte_wide(&text[i]) == first) && (byte_wide(&text[i + M - 1]) == last);
+    if (eve::any(mask)) {
+      for (int j = 0; j < L; ++j) {
+        if (mask.get(j) && std::equal(needle + 1, needle + M, &text[i + j + 1])) return i + j;
       }
     }
-    
+  }
+
+  for (; i + M <= N; ++i) {
+    if (std::equal(needle, needle + M, &text[i])) return i;
+  }
+  return -1;
+}
+
+void BM_FindByte(benchmark::State& state) {
+  if (!ValidateFindByte(state, "BM_FindByte", FindByte)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindByte(text, N, kDelimiter);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(1)) state.SkipWithError("FindByte returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindByte)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstring(benchmark::State& state) {
+  if (!ValidateFindSubstring(state, "BM_FindSubstring", FindSubstring)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int start = PlaceNeedle(text, state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindSubstring(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != start) state.SkipWithError("FindSubstring returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstring)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+int SumVector(const int* vector, int N) {
+  int res = 0;
+  eve::wide<int, eve::fixed<8>> s1(0);
+  eve::wide<int, eve::fixed<8>> s2(0);
+  
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
+    eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[i + 8]);
+    s1 = s1 + simd_vector1;
+    s2 = s2 + simd_vector2;
+  }
+
+  eve::wide<int, eve::fixed<8>> s = s1 + s2;
+  int t[8];
+
+  eve::store(s, t); 
+  
+  for (int i = 0; i < 8; ++i) 
+    res += t[i];
+
+  // Scalar epilogue for the last N % 16 elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
 }
-BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_SumVector(benchmark::State& state) {
+  if (!ValidateSum(state, "BM_SumVector", SumVector)) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
   int res;
 
-  for (auto _ : state) {
-    res = 0;
-    eve::wide<int, eve::fixed<8>> s1(0);
-    eve::wide<int, eve::fixed<8>> s2(0);
-    
-    for (int i = 0; i < N; i += 16) {
-      eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
-      eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[i + 8]);
-      s1 = s1 + simd_vector1;
-      s2 = s2 + simd_vector2;
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = SumVector(vector, N);
 
-    eve::wide<int, eve::fixed<8>> s = s1 + s2;
-    int t[8];
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
 
-    eve::store(s, t); 
-    
-    for (int i = 0; i < 8; ++i) 
-      res += t[i];
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+int64_t SumVectorWide(const int* vector, int N) {
+  int64_t res = 0;
+  eve::wide<int64_t, eve::fixed<8>> s1(0);
+  eve::wide<int64_t, eve::fixed<8>> s2(0);
+
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
+    eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[i + 8]);
+    // Sign-extends each lane to 64 bits (vpmovsxdq).
+    s1 = s1 + eve::convert(simd_vector1, eve::as<int64_t>{});
+    s2 = s2 + eve::convert(simd_vector2, eve::as<int64_t>{});
+  }
+
+  eve::wide<int64_t, eve::fixed<8>> s = s1 + s2;
+  int64_t t[8];
+
+  eve::store(s, t);
+
+  for (int i = 0; i < 8; ++i)
+    res += t[i];
+
+  // Scalar epilogue for the last N % 16 elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
+}
+
+void BM_SumVectorWide(benchmark::State& state) {
+  if (!ValidateSumWide(state, "BM_SumVectorWide", SumVectorWide)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = SumVectorWide(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVectorWide)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVectorWide)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void ReverseVector(int* vector, int N) {
+  int i = 0;
+  for (; i + 8 <= N / 2; i += 8) {
+    eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
+    eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[N - i - 8]);
+
+    simd_vector1 = eve::reverse(simd_vector1);
+    simd_vector2 = eve::reverse(simd_vector2);
+
+    eve::store(simd_vector2, &vector[i]);
+    eve::store(simd_vector1, &vector[N - i - 8]);
+  }
+  std::reverse(&vector[i], &vector[N - i]);
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
 void BM_ReverseVector(benchmark::State& state) {
+  if (!ValidateReverse<int>(state, "BM_ReverseVector", ReverseVector)) return;
   int N = state.range(1) - state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
 
-  for (auto _ : state) {
-    for (int i = 0; i < N / 2; i += 8) {
-      eve::wide<int, eve::fixed<8>> simd_vector1 = eve::load(&vector[i]);
-      eve::wide<int, eve::fixed<8>> simd_vector2 = eve::load(&vector[N - i - 8]);
+  for (auto _ : PerfLoop(state)) {
+    ReverseVector(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_ReverseVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// 256-bit wides for every element width; eve::reverse picks the shuffle for each.
+template <class T>
+using Wide256 = eve::wide<T, eve::fixed<32 / sizeof(T)>>;
+
+// In-place reverse at any width. The middle uses two overlapping wides, both loaded before either
+// store, so only fewer than L elements go through the scalar loop.
+template <class T>
+void ReverseInPlace(T* vector, int N) {
+  constexpr int L = Wide256<T>::size();
+  int lo = 0, hi = N;
+
+  for (; hi - lo >= 2 * L; lo += L, hi -= L) {
+    Wide256<T> simd_vector1(&vector[lo]);
+    Wide256<T> simd_vector2(&vector[hi - L]);
+    eve::store(eve::reverse(simd_vector2), &vector[lo]);
+    eve::store(eve::reverse(simd_vector1), &vector[hi - L]);
+  }
+  if (hi - lo >= L) {
+    Wide256<T> simd_vector1(&vector[lo]);
+    Wide256<T> simd_vector2(&vector[hi - L]);
+    eve::store(eve::reverse(simd_vector2), &vector[lo]);
+    eve::store(eve::reverse(simd_vector1), &vector[hi - L]);
+    return;
+  }
+  std::reverse(&vector[lo], &vector[hi]);
+}
+
+// result[i] = vector[N - 1 - i]. The last N % L outputs come from one wide ending at result[N - 1].
+template <class T>
+void ReverseCopy(const T* vector, T* result, int N) {
+  constexpr int L = Wide256<T>::size();
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    eve::store(eve::reverse(Wide256<T>(&vector[N - i - L])), &result[i]);
+  if (i < N && N >= L) {
+    eve::store(eve::reverse(Wide256<T>(&vector[0])), &result[N - L]);
+    return;
+  }
+  std::reverse_copy(&vector[0], &vector[N - i], &result[i]);
+}
+
+// Reverse at every element width, in place and into a second buffer. N counts elements; compare
+// bytes_per_second across widths.
+template <class T>
+void BM_ReverseVectorWidth(benchmark::State& state, void (*reverse)(T*, int)) {
+  if (!ValidateReverse<T>(state, "BM_ReverseVectorWidth/" + TypeKey<T>(), reverse)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
 
-      eve::reverse(simd_vector1);
-      eve::reverse(simd_vector2);
+    benchmark::ClobberMemory();
+  }
 
-      eve::store(simd_vector2, &vector[i]);
-      eve::store(simd_vector1, &vector[N - i - 8]);
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ReverseCopyVector(benchmark::State& state, void (*reverse_copy)(const T*, T*, int)) {
+  if (!ValidateReverseCopy<T>(state, "BM_ReverseCopyVector/" + TypeKey<T>(), reverse_copy)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Min/max of a random column, and the index of its first smallest or largest element, for int,
+// float and double. N must be at least 1.
+template <class T, bool Max>
+Wide256<T> Better(Wide256<T> a, Wide256<T> b) {
+  return Max ? eve::max(a, b) : eve::min(a, b);
+}
+
+template <class T, bool Max>
+T Extreme(const T* vector, int N) {
+  constexpr int L = Wide256<T>::size();
+  if (N < L) return Max ? *std::max_element(vector, vector + N) : *std::min_element(vector, vector + N);
+
+  Wide256<T> r1(vector), r2 = r1, r3 = r1, r4 = r1;
+  int i = L;
+  for (; i + 4 * L <= N; i += 4 * L) {
+    r1 = Better<T, Max>(r1, Wide256<T>(&vector[i]));
+    r2 = Better<T, Max>(r2, Wide256<T>(&vector[i + L]));
+    r3 = Better<T, Max>(r3, Wide256<T>(&vector[i + 2 * L]));
+    r4 = Better<T, Max>(r4, Wide256<T>(&vector[i + 3 * L]));
+  }
+  for (; i + L <= N; i += L)
+    r1 = Better<T, Max>(r1, Wide256<T>(&vector[i]));
+  // Min and max are idempotent, so the last N % L elements come in as one wide ending at vector[N - 1].
+  if (i < N) r2 = Better<T, Max>(r2, Wide256<T>(&vector[N - L]));
+
+  Wide256<T> r = Better<T, Max>(Better<T, Max>(r1, r2), Better<T, Max>(r3, r4));
+  return Max ? eve::maximum(r) : eve::minimum(r);
+}
+
+// Two accumulators, each with the index every lane's best value came from. The indices are integers
+// as wide as T, so the compare mask converts straight to them. Both accumulators share one index wide
+// holding the indices of the first of the pair; the second adds L when the lanes are folded.
+template <class T, bool Max>
+int ArgExtreme(const T* vector, int N) {
+  using I = eve::as_integer_t<T>;
+  constexpr int L = Wide256<T>::size();
+  T res = vector[0];
+  int res_at = 0, i = 0;
+
+  if (N >= 2 * L) {
+    Wide256<T> b1(vector), b2(&vector[L]);
+    Wide256<I> base([](auto lane, auto) { return I(lane); }), a1 = base, a2 = base;
+    const Wide256<I> step(I(2 * L));
+
+    for (i = 2 * L; i + 2 * L <= N; i += 2 * L) {
+      base = base + step;
+      Wide256<T> x1(&vector[i]), x2(&vector[i + L]);
+      // Strict compares, so every lane keeps the first of equal values it sees.
+      auto m1 = Max ? b1 < x1 : x1 < b1;
+      auto m2 = Max ? b2 < x2 : x2 < b2;
+      b1 = eve::if_else(m1, x1, b1);
+      b2 = eve::if_else(m2, x2, b2);
+      a1 = eve::if_else(eve::convert(m1, eve::as<eve::logical<I>>{}), base, a1);
+      a2 = eve::if_else(eve::convert(m2, eve::as<eve::logical<I>>{}), base, a2);
     }
 
+    // Among equal values the smaller index wins, so the result is the first occurrence.
+    T best[2 * L];
+    I at[2 * L];
+    eve::store(b1, &best[0]);
+    eve::store(b2, &best[L]);
+    eve::store(a1, &at[0]);
+    eve::store(a2 + I(L), &at[L]);
+    for (int j = 0; j < 2 * L; ++j) {
+      if ((Max ? res < best[j] : best[j] < res) || (best[j] == res && at[j] < res_at)) {
+        res = best[j];
+        res_at = int(at[j]);
+      }
+    }
+  }
+
+  // Everything left comes after every index above, so only a strictly better value replaces it.
+  for (; i < N; ++i) {
+    if (Max ? res < vector[i] : vector[i] < res) {
+      res = vector[i];
+      res_at = i;
+    }
+  }
+  return res_at;
+}
+
+template <class T>
+void BM_MinMaxVector(benchmark::State& state, T (*extreme)(const T*, int), bool largest) {
+  if (!ValidateExtreme<T>(state, "BM_MinMaxVector/" + std::string(largest ? "max_" : "min_") + TypeKey<T>(), extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = extreme(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != vector[ReferenceArgExtreme(vector, N, largest)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ArgMinMaxVector(benchmark::State& state, int (*arg_extreme)(const T*, int), bool largest) {
+  if (!ValidateArgExtreme<T>(state, "BM_ArgMinMaxVector/" + std::string(largest ? "argmax_" : "argmin_") + TypeKey<T>(), arg_extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = arg_extreme(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != ReferenceArgExtreme(vector, N, largest)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Element-wise kernels from L1-resident to DRAM-sized arrays (ElementwiseSweep), with bytes/s and
+// FLOP/s to set against the machine's peaks: add out = a + b, AXPY y = alpha * x + y, FMA
+// out = a * x + b and the triad out = b + q * c.
+// One eve::fma per 256-bit wide, the library spelling of _mm256_fmadd_pd.
+void AddArrays(const double* a, const double* b, double* out, int N) {
+  constexpr int L = Wide256<double>::size();
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    Wide256<double> av(&a[i]), bv(&b[i]);
+    eve::store(av + bv, &out[i]);
+  }
+  for (; i < N; ++i)
+    out[i] = a[i] + b[i];
+}
+
+void Axpy(double alpha, const double* x, double* y, int N) {
+  constexpr int L = Wide256<double>::size();
+  const Wide256<double> va(alpha);
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    Wide256<double> xv(&x[i]), yv(&y[i]);
+    eve::store(eve::fma(va, xv, yv), &y[i]);
+  }
+  for (; i < N; ++i)
+    y[i] = alpha * x[i] + y[i];
+}
+
+void MultiplyAdd(const double* a, const double* x, const double* b, double* out, int N) {
+  constexpr int L = Wide256<double>::size();
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    Wide256<double> av(&a[i]), xv(&x[i]), bv(&b[i]);
+    eve::store(eve::fma(av, xv, bv), &out[i]);
+  }
+  for (; i < N; ++i)
+    out[i] = a[i] * x[i] + b[i];
+}
+
+void Triad(const double* b, const double* c, double q, double* out, int N) {
+  constexpr int L = Wide256<double>::size();
+  const Wide256<double> vq(q);
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    Wide256<double> bv(&b[i]), cv(&c[i]);
+    eve::store(eve::fma(vq, cv, bv), &out[i]);
+  }
+  for (; i < N; ++i)
+    out[i] = b[i] + q * c[i];
+}
+
+void BM_AddArrays(benchmark::State& state) {
+  if (!ValidateAdd(state, "BM_AddArrays", AddArrays)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    AddArrays(v.a.data(), v.b.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 1);
+}
+BENCHMARK(BM_AddArrays)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Axpy(benchmark::State& state) {
+  if (!ValidateAxpy(state, "BM_Axpy", Axpy)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Axpy(kElementwiseScale, v.a.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
     benchmark::ClobberMemory();
   }
-}BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
-BENCHMARK_MAIN();
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Axpy)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_MultiplyAdd(benchmark::State& state) {
+  if (!ValidateMultiplyAdd(state, "BM_MultiplyAdd", MultiplyAdd)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    MultiplyAdd(v.a.data(), v.b.data(), v.c.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 4, 2);
+}
+BENCHMARK(BM_MultiplyAdd)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Triad(benchmark::State& state) {
+  if (!ValidateTriad(state, "BM_Triad", Triad)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Triad(v.b.data(), v.c.data(), kElementwiseScale, v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Triad)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+} // namespace
+
+BACKEND_MAIN();
@@ -1,159 +1,1122 @@
-//TO COMPILE: sudo g++ highway.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -march=native -DNDEBUG -I/usr/local/include/hwy -o highway
+//TO COMPILE: sudo g++ highway.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -march=native -DNDEBUG -I. -I/usr/local/include/hwy -lhwy -o highway
 
+// Each kernel is compiled once per target in HWY_TARGETS via foreach_target.h, which re-includes
+// this file. The benchmarks at the bottom call hwy::N_AVX2:: and hwy::N_AVX3:: side by side.
+
+#include <cmath>
 #include <numeric>
-#define HWY_TARGETS N_AVX2
+#define HWY_TARGETS (HWY_AVX2 | HWY_AVX3)
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "highway.cpp"
+#include <hwy/foreach_target.h>
 #include <algorithm>
 #include <hwy/highway.h>
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+void AddVectors(const double* data_a, const double* data_b, double* result, int N) {
+  const HWY_FULL(double) d;
+  const int L = Lanes(d);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto av = LoadU(d, &data_a[i]);
+    auto bv = LoadU(d, &data_b[i]);
+    StoreU(Add(av, bv), d, &result[i]);
+  }
+  if (i < N) {
+    auto m = FirstN(d, N - i);
+    auto av = MaskedLoad(m, d, &data_a[i]);
+    auto bv = MaskedLoad(m, d, &data_b[i]);
+    BlendedStore(Add(av, bv), m, d, &result[i]);
+  }
+}
+
+int FindInVector(const int* vector, int N, int target) {
+  const HWY_FULL(int) d;
+  const int L = Lanes(d);
+  auto x = Set(d, target);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto m = Eq(x, LoadU(d, &vector[i]));
+    if (!AllFalse(d, m)) return i + FindFirstTrue(d, m);
+  }
+  if (i < N) {
+    // Masked-off lanes load as zero, so they are also masked out of the compare.
+    auto valid = FirstN(d, N - i);
+    auto m = And(valid, Eq(x, MaskedLoad(valid, d, &vector[i])));
+    if (!AllFalse(d, m)) return i + FindFirstTrue(d, m);
+  }
+  return -1;
+}
+
+int FindInVectorFaster(const int* vector, int N, int target) {
+  const HWY_FULL(int) d;
+  const int L = Lanes(d);
+  auto x = Set(d, target);
+  int i = 0;
+
+  for (; i + 4 * L <= N; i += 4 * L) {
+    auto m1 = Eq(x, LoadU(d, &vector[i]));
+    auto m2 = Eq(x, LoadU(d, &vector[i + L]));
+    auto m3 = Eq(x, LoadU(d, &vector[i + 2 * L]));
+    auto m4 = Eq(x, LoadU(d, &vector[i + 3 * L]));
+    auto m12 = Or(m1, m2);
+    auto m34 = Or(m3, m4);
+    auto m = Or(m12, m34);
+    if (!AllFalse(d, m)) {
+      if (!AllFalse(d, m1)) return i + FindFirstTrue(d, m1);
+      if (!AllFalse(d, m2)) return i + FindFirstTrue(d, m2) + L;
+      if (!AllFalse(d, m3)) return i + FindFirstTrue(d, m3) + 2 * L;
+      return i + FindFirstTrue(d, m4) + 3 * L;
+    }
+  }
+  int res = FindInVector(&vector[i], N - i, target);
+  return res < 0 ? res : res + i;
+}
+
+// Every matching index, in order. CompressStore packs the selected lanes of an index vector to
+// the front and may write a whole vector; the count never exceeds i, so that stays inside result.
+int FindAllInVector(const int* vector, int N, int target, uint32_t* result) {
+  const HWY_FULL(int) d;
+  const RebindToUnsigned<decltype(d)> du;
+  const int L = Lanes(d);
+  auto x = Set(d, target);
+  auto index = Iota(du, 0);
+  const auto step = Set(du, L);
+  int count = 0, i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto m = RebindMask(du, Eq(x, LoadU(d, &vector[i])));
+    count += CompressStore(index, m, du, &result[count]);
+    index = Add(index, step);
+  }
+  for (; i < N; ++i) {
+    result[count] = i;
+    count += vector[i] == target;
+  }
+  return count;
+}
+
+int SumVector(const int* vector, int N) {
+  const HWY_FULL(int) d;
+  const int L = Lanes(d);
+  auto s1 = Zero(d);
+  auto s2 = Zero(d);
+  int i = 0;
+
+  for (; i + 2 * L <= N; i += 2 * L) {
+    s1 = Add(s1, LoadU(d, &vector[i]));
+    s2 = Add(s2, LoadU(d, &vector[i + L]));
+  }
+  if (i + L <= N) {
+    s1 = Add(s1, LoadU(d, &vector[i]));
+    i += L;
+  }
+  if (i < N) s2 = Add(s2, MaskedLoad(FirstN(d, N - i), d, &vector[i]));
+
+  return ReduceSum(d, Add(s1, s2));
+}
+
+// PromoteTo sign-extends a half-width vector of int32 into a full vector of int64 (vpmovsxdq).
+int64_t SumVectorWide(const int* vector, int N) {
+  const HWY_FULL(int64_t) d64;
+  const Rebind<int, decltype(d64)> d32;
+  const int L = Lanes(d64);
+  auto s1 = Zero(d64);
+  auto s2 = Zero(d64);
+  int i = 0;
+
+  for (; i + 2 * L <= N; i += 2 * L) {
+    s1 = Add(s1, PromoteTo(d64, LoadU(d32, &vector[i])));
+    s2 = Add(s2, PromoteTo(d64, LoadU(d32, &vector[i + L])));
+  }
+  if (i + L <= N) {
+    s1 = Add(s1, PromoteTo(d64, LoadU(d32, &vector[i])));
+    i += L;
+  }
+  if (i < N) s2 = Add(s2, PromoteTo(d64, MaskedLoad(FirstN(d32, N - i), d32, &vector[i])));
+
+  return ReduceSum(d64, Add(s1, s2));
+}
+
+// Floating-point sums for float and double columns: plain vector accumulation, pairwise, and
+// Neumaier-compensated.
+template <class T>
+T SumPlain(const T* vector, int N) {
+  const HWY_FULL(T) d;
+  const int L = Lanes(d);
+  auto s1 = Zero(d);
+  auto s2 = Zero(d);
+  auto s3 = Zero(d);
+  auto s4 = Zero(d);
+  int i = 0;
+
+  for (; i + 4 * L <= N; i += 4 * L) {
+    s1 = Add(s1, LoadU(d, &vector[i]));
+    s2 = Add(s2, LoadU(d, &vector[i + L]));
+    s3 = Add(s3, LoadU(d, &vector[i + 2 * L]));
+    s4 = Add(s4, LoadU(d, &vector[i + 3 * L]));
+  }
+  for (; i + L <= N; i += L)
+    s1 = Add(s1, LoadU(d, &vector[i]));
+  if (i < N) s2 = Add(s2, MaskedLoad(FirstN(d, N - i), d, &vector[i]));
+
+  return ReduceSum(d, Add(Add(s1, s2), Add(s3, s4)));
+}
+
+// Halves on whole vectors down to 32-vector blocks, so the error grows with log(N).
+template <class T>
+T SumPairwise(const T* vector, int N) {
+  const HWY_FULL(T) d;
+  const int L = Lanes(d);
+  if (N <= 32 * L) return SumPlain(vector, N);
+  int half = N / 2 / L * L;
+  return SumPairwise(vector, half) + SumPairwise(&vector[half], N - half);
+}
+
+// One Neumaier step per lane: the compensation keeps the rounding error of the smaller operand.
+template <class V>
+void NeumaierStep(V& s, V& c, V x) {
+  auto t = Add(s, x);
+  auto lost = IfThenElse(Ge(Abs(s), Abs(x)), Add(Sub(s, t), x), Add(Sub(x, t), s));
+  c = Add(c, lost);
+  s = t;
+}
+
+template <class T>
+T SumCompensated(const T* vector, int N) {
+  const HWY_FULL(T) d;
+  const int L = Lanes(d);
+  auto s1 = Zero(d);
+  auto c1 = Zero(d);
+  auto s2 = Zero(d);
+  auto c2 = Zero(d);
+  int i = 0;
+
+  for (; i + 2 * L <= N; i += 2 * L) {
+    NeumaierStep(s1, c1, LoadU(d, &vector[i]));
+    NeumaierStep(s2, c2, LoadU(d, &vector[i + L]));
+  }
+  if (i + L <= N) {
+    NeumaierStep(s1, c1, LoadU(d, &vector[i]));
+    i += L;
+  }
+  if (i < N) NeumaierStep(s2, c2, MaskedLoad(FirstN(d, N - i), d, &vector[i]));
+
+  // Fold the lanes with the scalar algorithm, then add all compensations.
+  HWY_ALIGN T s[2 * MaxLanes(d)];
+  HWY_ALIGN T c[2 * MaxLanes(d)];
+  Store(s1, d, s);
+  Store(s2, d, s + L);
+  Store(c1, d, c);
+  Store(c2, d, c + L);
+  T sum = 0, comp = 0;
+  for (int j = 0; j < 2 * L; ++j) {
+    T t = sum + s[j];
+    comp += std::abs(sum) >= std::abs(s[j]) ? (sum - t) + s[j] : (s[j] - t) + sum;
+    sum = t;
+    comp += c[j];
+  }
+  return sum + comp;
+}
+
+// Non-template entry points, so every instantiation happens inside this target's namespace.
+float SumFloatPlain(const float* vector, int N) { return SumPlain(vector, N); }
+float SumFloatPairwise(const float* vector, int N) { return SumPairwise(vector, N); }
+float SumFloatCompensated(const float* vector, int N) { return SumCompensated(vector, N); }
+double SumDoublePlain(const double* vector, int N) { return SumPlain(vector, N); }
+double SumDoublePairwise(const double* vector, int N) { return SumPairwise(vector, N); }
+double SumDoubleCompensated(const double* vector, int N) { return SumCompensated(vector, N); }
+
+// memchr and a first/last-byte-filtered substring search, one full vector of bytes per compare.
+// N counts bytes.
+int FindByte(const uint8_t* text, int N, uint8_t target) {
+  const HWY_FULL(uint8_t) d;
+  const int L = Lanes(d);
+  auto x = Set(d, target);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto m = Eq(x, LoadU(d, &text[i]));
+    if (!AllFalse(d, m)) return i + FindFirstTrue(d, m);
+  }
+  if (i < N) {
+    auto valid = FirstN(d, N - i);
+    auto m = And(valid, Eq(x, MaskedLoad(valid, d, &text[i])));
+    if (!AllFalse(d, m)) return i + FindFirstTrue(d, m);
+  }
+  return -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches M - 1
+// bytes further on; only those are compared in full.
+int FindSubstring(const uint8_t* text, int N, const uint8_t* needle, int M) {
+  if (M == 0) return 0;
+  const HWY_FULL(uint8_t) d;
+  const int L = Lanes(d);
+  auto first = Set(d, needle[0]);
+  auto last = Set(d, needle[M - 1]);
+  int i = 0;
+
+  for (; i + M - 1 + L <= N; i += L) {
+    auto m = And(Eq(first, LoadU(d, &text[i])), Eq(last, LoadU(d, &text[i + M - 1])));
+    while (!AllFalse(d, m)) {
+      int j = FindFirstTrue(d, m);
+      if (std::equal(needle + 1, needle + M, &text[i + j + 1])) return i + j;
+      m = AndNot(FirstN(d, j + 1), m);
+    }
+  }
+
+  for (; i + M <= N; ++i) {
+    if (std::equal(needle, needle + M, &text[i])) return i;
+  }
+  return -1;
+}
+
+// Min/max of a random column, and the index of its first smallest or largest element, for int,
+// float and double. N must be at least 1.
+template <bool Largest, class V>
+V Better(V a, V b) {
+  return Largest ? Max(a, b) : Min(a, b);
+}
+
+template <bool Largest, class T>
+T Extreme(const T* vector, int N) {
+  const HWY_FULL(T) d;
+  const int L = Lanes(d);
+  if (N < L) return Largest ? *std::max_element(vector, vector + N) : *std::min_element(vector, vector + N);
+
+  auto r1 = LoadU(d, vector);
+  auto r2 = r1;
+  auto r3 = r1;
+  auto r4 = r1;
+  int i = L;
+
+  for (; i + 4 * L <= N; i += 4 * L) {
+    r1 = Better<Largest>(r1, LoadU(d, &vector[i]));
+    r2 = Better<Largest>(r2, LoadU(d, &vector[i + L]));
+    r3 = Better<Largest>(r3, LoadU(d, &vector[i + 2 * L]));
+    r4 = Better<Largest>(r4, LoadU(d, &vector[i + 3 * L]));
+  }
+  for (; i + L <= N; i += L)
+    r1 = Better<Largest>(r1, LoadU(d, &vector[i]));
+  // Min and max are idempotent, so the last N % L elements come in as one vector ending at vector[N - 1].
+  if (i < N) r2 = Better<Largest>(r2, LoadU(d, &vector[N - L]));
+
+  const auto r = Better<Largest>(Better<Largest>(r1, r2), Better<Largest>(r3, r4));
+  return Largest ? ReduceMax(d, r) : ReduceMin(d, r);
+}
 
-void BM_AddVectors(benchmark::State& state) {
+// Two accumulators, each with the index every lane's best value came from, in signed integers as
+// wide as T so RebindMask carries the compare over. Both accumulators share one index vector holding
+// the indices of the first of the pair; the second adds L when the lanes are folded.
+template <bool Largest, class T>
+int ArgExtreme(const T* vector, int N) {
+  const HWY_FULL(T) d;
+  const RebindToSigned<decltype(d)> di;
+  using I = TFromD<decltype(di)>;
+  const int L = Lanes(d);
+  T res = vector[0];
+  int res_at = 0, i = 0;
+
+  if (N >= 2 * L) {
+    auto b1 = LoadU(d, vector);
+    auto b2 = LoadU(d, &vector[L]);
+    auto base = Iota(di, 0);
+    auto a1 = base;
+    auto a2 = base;
+    const auto step = Set(di, I(2 * L));
+
+    for (i = 2 * L; i + 2 * L <= N; i += 2 * L) {
+      base = Add(base, step);
+      const auto x1 = LoadU(d, &vector[i]);
+      const auto x2 = LoadU(d, &vector[i + L]);
+      // Strict compares, so every lane keeps the first of equal values it sees.
+      const auto m1 = Largest ? Lt(b1, x1) : Lt(x1, b1);
+      const auto m2 = Largest ? Lt(b2, x2) : Lt(x2, b2);
+      b1 = IfThenElse(m1, x1, b1);
+      b2 = IfThenElse(m2, x2, b2);
+      a1 = IfThenElse(RebindMask(di, m1), base, a1);
+      a2 = IfThenElse(RebindMask(di, m2), base, a2);
+    }
+
+    // Among equal values the smaller index wins, so the result is the first occurrence.
+    HWY_ALIGN T best[2 * MaxLanes(d)];
+    HWY_ALIGN I at[2 * MaxLanes(d)];
+    Store(b1, d, best);
+    Store(b2, d, best + L);
+    Store(a1, di, at);
+    Store(Add(a2, Set(di, I(L))), di, at + L);
+    for (int j = 0; j < 2 * L; ++j) {
+      if ((Largest ? res < best[j] : best[j] < res) || (best[j] == res && at[j] < res_at)) {
+        res = best[j];
+        res_at = int(at[j]);
+      }
+    }
+  }
+
+  // Everything left comes after every index above, so only a strictly better value replaces it.
+  for (; i < N; ++i) {
+    if (Largest ? res < vector[i] : vector[i] < res) {
+      res = vector[i];
+      res_at = i;
+    }
+  }
+  return res_at;
+}
+
+int MinInt(const int* vector, int N) { return Extreme<false>(vector, N); }
+int MaxInt(const int* vector, int N) { return Extreme<true>(vector, N); }
+float MinFloat(const float* vector, int N) { return Extreme<false>(vector, N); }
+float MaxFloat(const float* vector, int N) { return Extreme<true>(vector, N); }
+double MinDouble(const double* vector, int N) { return Extreme<false>(vector, N); }
+double MaxDouble(const double* vector, int N) { return Extreme<true>(vector, N); }
+int ArgMinInt(const int* vector, int N) { return ArgExtreme<false>(vector, N); }
+int ArgMaxInt(const int* vector, int N) { return ArgExtreme<true>(vector, N); }
+int ArgMinFloat(const float* vector, int N) { return ArgExtreme<false>(vector, N); }
+int ArgMaxFloat(const float* vector, int N) { return ArgExtreme<true>(vector, N); }
+int ArgMinDouble(const double* vector, int N) { return ArgExtreme<false>(vector, N); }
+int ArgMaxDouble(const double* vector, int N) { return ArgExtreme<true>(vector, N); }
+
+// Inclusive and exclusive prefix sums for int and float. SlideUpLanes moves the whole vector up by
+// k lanes and shifts in zeros, so log2(L) shift-and-add steps leave lane j holding
+// x[0] + ... + x[j]. The carry holds the running total in every lane and only depends on the
+// previous carry and the current vector's own scan, so the loop-carried chain is one add per vector.
+template <bool Inclusive, class T>
+void PrefixSum(const T* in, T* out, int N) {
+  const HWY_FULL(T) d;
+  const int L = Lanes(d);
+  constexpr size_t kLast = MaxLanes(d) - 1;
+  auto carry = Zero(d);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto p = LoadU(d, &in[i]);
+    for (int k = 1; k < L; k *= 2)
+      p = Add(p, SlideUpLanes(d, p, k));
+    StoreU(Add(Inclusive ? p : Slide1Up(d, p), carry), d, &out[i]);
+    carry = Add(carry, BroadcastLane<kLast>(p));
+  }
+
+  // Scalar epilogue for the last N % L elements.
+  T acc = GetLane(carry);
+  for (; i < N; ++i) {
+    if (!Inclusive) out[i] = acc;
+    acc += in[i];
+    if (Inclusive) out[i] = acc;
+  }
+}
+
+void ScanInclusiveInt(const int* in, int* out, int N) { PrefixSum<true>(in, out, N); }
+void ScanExclusiveInt(const int* in, int* out, int N) { PrefixSum<false>(in, out, N); }
+void ScanInclusiveFloat(const float* in, float* out, int N) { PrefixSum<true>(in, out, N); }
+void ScanExclusiveFloat(const float* in, float* out, int N) { PrefixSum<false>(in, out, N); }
+
+void ReverseVector(int* vector, int N) {
+  const HWY_FULL(int) d;
+  const int L = Lanes(d);
+  int lo = 0, hi = N;
+
+  for (; hi - lo >= 2 * L; lo += L, hi -= L) {
+    auto simd_vector1 = LoadU(d, &vector[lo]);
+    auto simd_vector2 = LoadU(d, &vector[hi - L]);
+    StoreU(Reverse(d, simd_vector2), d, &vector[lo]);
+    StoreU(Reverse(d, simd_vector1), d, &vector[hi - L]);
+  }
+  std::reverse(&vector[lo], &vector[hi]);
+}
+
+// Reverse for any lane type; Highway picks the shuffle sequence per lane width and target. The
+// middle uses two overlapping vectors, both loaded before either store, so only fewer than L
+// elements go through the scalar loop.
+template <class T>
+void ReverseInPlace(T* vector, int N) {
+  const ScalableTag<T> d;
+  const int L = Lanes(d);
+  int lo = 0, hi = N;
+
+  for (; hi - lo >= 2 * L; lo += L, hi -= L) {
+    auto simd_vector1 = LoadU(d, &vector[lo]);
+    auto simd_vector2 = LoadU(d, &vector[hi - L]);
+    StoreU(Reverse(d, simd_vector2), d, &vector[lo]);
+    StoreU(Reverse(d, simd_vector1), d, &vector[hi - L]);
+  }
+  if (hi - lo >= L) {
+    auto simd_vector1 = LoadU(d, &vector[lo]);
+    auto simd_vector2 = LoadU(d, &vector[hi - L]);
+    StoreU(Reverse(d, simd_vector2), d, &vector[lo]);
+    StoreU(Reverse(d, simd_vector1), d, &vector[hi - L]);
+    return;
+  }
+  std::reverse(&vector[lo], &vector[hi]);
+}
+
+// result[i] = vector[N - 1 - i]. The last N % L outputs come from one vector ending at result[N - 1].
+template <class T>
+void ReverseCopy(const T* vector, T* result, int N) {
+  const ScalableTag<T> d;
+  const int L = Lanes(d);
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    StoreU(Reverse(d, LoadU(d, &vector[N - i - L])), d, &result[i]);
+  if (i < N && N >= L) {
+    StoreU(Reverse(d, LoadU(d, &vector[0])), d, &result[N - L]);
+    return;
+  }
+  std::reverse_copy(&vector[0], &vector[N - i], &result[i]);
+}
+
+void ReverseU8(uint8_t* vector, int N) { ReverseInPlace(vector, N); }
+void ReverseU16(uint16_t* vector, int N) { ReverseInPlace(vector, N); }
+void ReverseU32(uint32_t* vector, int N) { ReverseInPlace(vector, N); }
+void ReverseU64(uint64_t* vector, int N) { ReverseInPlace(vector, N); }
+void ReverseCopyU8(const uint8_t* vector, uint8_t* result, int N) { ReverseCopy(vector, result, N); }
+void ReverseCopyU16(const uint16_t* vector, uint16_t* result, int N) { ReverseCopy(vector, result, N); }
+void ReverseCopyU32(const uint32_t* vector, uint32_t* result, int N) { ReverseCopy(vector, result, N); }
+void ReverseCopyU64(const uint64_t* vector, uint64_t* result, int N) { ReverseCopy(vector, result, N); }
+
+// The element-wise kernels next to AddVectors. MulAdd(a, x, b) is one vfmadd per vector on both
+// targets; the last N % L elements go through a masked load and a blended store.
+void Axpy(double alpha, const double* x, double* y, int N) {
+  const HWY_FULL(double) d;
+  const int L = Lanes(d);
+  const auto va = Set(d, alpha);
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    StoreU(MulAdd(va, LoadU(d, &x[i]), LoadU(d, &y[i])), d, &y[i]);
+  if (i < N) {
+    auto m = FirstN(d, N - i);
+    BlendedStore(MulAdd(va, MaskedLoad(m, d, &x[i]), MaskedLoad(m, d, &y[i])), m, d, &y[i]);
+  }
+}
+
+void MultiplyAdd(const double* a, const double* x, const double* b, double* out, int N) {
+  const HWY_FULL(double) d;
+  const int L = Lanes(d);
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    StoreU(MulAdd(LoadU(d, &a[i]), LoadU(d, &x[i]), LoadU(d, &b[i])), d, &out[i]);
+  if (i < N) {
+    auto m = FirstN(d, N - i);
+    BlendedStore(MulAdd(MaskedLoad(m, d, &a[i]), MaskedLoad(m, d, &x[i]), MaskedLoad(m, d, &b[i])), m, d, &out[i]);
+  }
+}
+
+void Triad(const double* b, const double* c, double q, double* out, int N) {
+  const HWY_FULL(double) d;
+  const int L = Lanes(d);
+  const auto vq = Set(d, q);
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    StoreU(MulAdd(vq, LoadU(d, &c[i]), LoadU(d, &b[i])), d, &out[i]);
+  if (i < N) {
+    auto m = FirstN(d, N - i);
+    BlendedStore(MulAdd(vq, MaskedLoad(m, d, &c[i]), MaskedLoad(m, d, &b[i])), m, d, &out[i]);
+  }
+}
+
+} // namespace HWY_NAMESPACE
+} // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+
+namespace {
+
+// The plain benchmark names run the AVX2 kernels, BM_<name>/avx512 runs the same source compiled
+// for AVX3 (AVX-512 F/BW/DQ/VL). Targets the CPU lacks are reported as skipped.
+bool SkipUnsupported(benchmark::State& state, int64_t target) {
+  if (hwy::SupportedTargets() & target) return false;
+  state.SkipWithError("Highway target not supported by this CPU");
+  return true;
+}
+
+// The validation key of a benchmark's kernel compiled for target, e.g. "BM_SumVector/AVX2".
+std::string KernelKey(const char* benchmark, int64_t target) {
+  return std::string(benchmark) + "/" + hwy::TargetName(target);
+}
+
+void BM_AddVectors(benchmark::State& state, int64_t target, void (*add)(const double*, const double*, double*, int)) {
+  if (SkipUnsupported(state, target)) return;
+  if (!ValidateAddVectors(state, KernelKey("BM_AddVectors", target), [add](const double* a, const double* b, double* out) { add(a, b, out, 4); })) return;
   double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double result[4];
 
-  for (auto _ : state) {
-    const HWY_FULL(double) res;
-    auto av = hwy::N_AVX2::Load(res, data_a);
-    auto bv = hwy::N_AVX2::Load(res, data_b);
-    auto rv = hwy::N_AVX2::Add(av, bv);
-    hwy::N_AVX2::Store(rv, res, result);
+  for (auto _ : PerfLoop(state)) {
+    add(data_a, data_b, result, 4);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
   }
 }
-BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_AddVectors, avx2, HWY_AVX2, hwy::N_AVX2::AddVectors)->Name(BENCH_NAME("BM_AddVectors"))->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_AddVectors, avx512, HWY_AVX3, hwy::N_AVX3::AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(10);
 
-void BM_FindInVector(benchmark::State& state) {
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state, int64_t target, void (*add)(const double*, const double*, double*, int)) {
+  if (SkipUnsupported(state, target)) return;
+  if (!ValidateAddVectors(state, KernelKey("BM_AddVectors", target), [add](const double* a, const double* b, double* out) { add(a, b, out, 4); })) return;
+  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double result[4];
+
+  TimeCycles(state, 4, [&] {
+    add(data_a, data_b, result, 4);
+
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK_CAPTURE(BM_AddVectorsCycles, avx2, HWY_AVX2, hwy::N_AVX2::AddVectors)->Name(BENCH_NAME("BM_AddVectorsCycles"))->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsCycles, avx512, HWY_AVX3, hwy::N_AVX3::AddVectors)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+void BM_FindInVector(benchmark::State& state, int64_t target_isa, int (*find)(const int*, int, int)) {
+  if (SkipUnsupported(state, target_isa) || !ValidateFind(state, KernelKey("BM_FindInVector", target_isa), find)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    const HWY_FULL(int) d;
-    auto x = hwy::N_AVX2::Set(d, target);
-
-    for (int i = 0; i < N; i += 8) {
-      auto y = hwy::N_AVX2::Load(d, &vector[i]);
-      auto m = hwy::N_AVX2::Eq(x, y);
-      if (!hwy::N_AVX2::AllFalse(d, m)) {
-        res = i + hwy::N_AVX2::FindFirstTrue(d, m);
-        break;
-      }
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = find(vector, N, target);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_FindInVector, avx2, HWY_AVX2, hwy::N_AVX2::FindInVector)->Name(BENCH_NAME("BM_FindInVector"))->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_FindInVector, avx2, HWY_AVX2, hwy::N_AVX2::FindInVector)->Name(BENCH_NAME("BM_FindInVector"))->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVector, avx512, HWY_AVX3, hwy::N_AVX3::FindInVector)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVector, avx512, HWY_AVX3, hwy::N_AVX3::FindInVector)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
 
-void BM_FindInVectorFaster(benchmark::State& state) {
+void BM_FindInVectorFaster(benchmark::State& state, int64_t target_isa, int (*find)(const int*, int, int)) {
+  if (SkipUnsupported(state, target_isa) || !ValidateFind(state, KernelKey("BM_FindInVectorFaster", target_isa), find)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    const HWY_FULL(int) d;
-    auto x = hwy::N_AVX2::Set(d, target);
-
-    for (int i = 0; i < N; i += 32) {
-      auto y1 = hwy::N_AVX2::Load(d, &vector[i]);
-      auto m1 = hwy::N_AVX2::Eq(x, y1);
-      auto y2 = hwy::N_AVX2::Load(d, &vector[i + 8]);
-      auto m2 = hwy::N_AVX2::Eq(x, y2);
-      auto y3 = hwy::N_AVX2::Load(d, &vector[i + 16]);
-      auto m3 = hwy::N_AVX2::Eq(x, y3);
-      auto y4 = hwy::N_AVX2::Load(d, &vector[i + 24]);
-      auto m4 = hwy::N_AVX2::Eq(x, y4);
-      auto m12 = hwy::N_AVX2::Or(m1, m2);
-      auto m34 = hwy::N_AVX2::Or(m3, m4);
-      auto m = hwy::N_AVX2::Or(m12, m34);
-      if (!hwy::N_AVX2::AllFalse(d, m)) {
-        if (!hwy::N_AVX2::AllFalse(d, m1)) {
-          res = i + hwy::N_AVX2::FindFirstTrue(d, m1);
-          break;
-        }
-        if (!hwy::N_AVX2::AllFalse(d, m2)) {
-          res = i + hwy::N_AVX2::FindFirstTrue(d, m2) + 8;
-          break;
-        }
-        if (!hwy::N_AVX2::AllFalse(d, m3)) {
-          res = i + hwy::N_AVX2::FindFirstTrue(d, m3) + 16;
-          break;
-        }
-        if (!hwy::N_AVX2::AllFalse(d, m4)) {
-          res = i + hwy::N_AVX2::FindFirstTrue(d, m4) + 24;
-          break;
-        }
-      }
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = find(vector, N, target);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
 }
-BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx2, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster)->Name(BENCH_NAME("BM_FindInVectorFaster"))->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx2, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster)->Name(BENCH_NAME("BM_FindInVectorFaster"))->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx512, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx512, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
 
-void BM_SumVector(benchmark::State& state) {
+// The early-exit find on the FindScenario inputs, which move the target on every call so the exit
+// cannot be learned (see FindScenarioInput in bench-utils.h).
+void BM_FindInVectorScenario(benchmark::State& state, int64_t target_isa, int (*find)(const int*, int, int), FindScenario scenario) {
+  if (SkipUnsupported(state, target_isa) || !ValidateFind(state, KernelKey("BM_FindInVectorFaster", target_isa), find)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = find(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_random_position, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_absent, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_near_start, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_duplicates, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_random_data, HWY_AVX2, hwy::N_AVX2::FindInVectorFaster, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_random_position, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_absent, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_near_start, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_duplicates, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_random_data, HWY_AVX3, hwy::N_AVX3::FindInVectorFaster, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// Every matching index as a selection vector, across selectivities from 0.01% to 100%. Branch-free,
+// so compare the shape of the curve with the branchy loop in no-vec.cpp.
+void BM_FindAllInVector(benchmark::State& state, int64_t target_isa, int (*find_all)(const int*, int, int, uint32_t*)) {
+  if (SkipUnsupported(state, target_isa) || !ValidateFindAll(state, KernelKey("BM_FindAllInVector", target_isa), find_all)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  aligned_buffer<uint32_t> result(N);
+  int* vector = buffer.data();
+  int64_t matches = FillSelectivity(vector, N, target, state.range(2));
+  int count = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    count = find_all(vector, N, target, result.data());
+
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  if (count != matches) state.SkipWithError("FindAllInVector returned the wrong number of matches");
+  SetSelectivityCounters(state, N, matches);
+}
+BENCHMARK_CAPTURE(BM_FindAllInVector, avx2, HWY_AVX2, hwy::N_AVX2::FindAllInVector)->Name(BENCH_NAME("BM_FindAllInVector"))->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAllInVector, avx512, HWY_AVX3, hwy::N_AVX3::FindAllInVector)->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindByte(benchmark::State& state, int64_t target_isa, int (*find)(const uint8_t*, int, uint8_t)) {
+  if (SkipUnsupported(state, target_isa) || !ValidateFindByte(state, KernelKey("BM_FindByte", target_isa), find)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = find(text, N, kDelimiter);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(1)) state.SkipWithError("FindByte returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK_CAPTURE(BM_FindByte, avx2, HWY_AVX2, hwy::N_AVX2::FindByte)->Name(BENCH_NAME("BM_FindByte"))->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindByte, avx512, HWY_AVX3, hwy::N_AVX3::FindByte)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstring(benchmark::State& state, int64_t target_isa, int (*find)(const uint8_t*, int, const uint8_t*, int)) {
+  if (SkipUnsupported(state, target_isa) || !ValidateFindSubstring(state, KernelKey("BM_FindSubstring", target_isa), find)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int start = PlaceNeedle(text, state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = find(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("FindSubstring returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK_CAPTURE(BM_FindSubstring, avx2, HWY_AVX2, hwy::N_AVX2::FindSubstring)->Name(BENCH_NAME("BM_FindSubstring"))->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindSubstring, avx512, HWY_AVX3, hwy::N_AVX3::FindSubstring)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_SumVector(benchmark::State& state, int64_t target, int (*sum)(const int*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateSum(state, KernelKey("BM_SumVector", target), sum)) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
   int res;
 
-  for (auto _ : state) {
-    res = 0;
-    const HWY_FULL(int) d;
-    auto s1 = hwy::N_AVX2::Set(d, 0);
-    auto s2 = hwy::N_AVX2::Set(d, 0);
-    
-    for (int i = 0; i < N; i += 16) {
-      auto simd_vector1 = hwy::N_AVX2::Load(d, &vector[i]);
-      auto simd_vector2 = hwy::N_AVX2::Load(d, &vector[i + 8]);
-      s1 = hwy::N_AVX2::Add(s1, simd_vector1);
-      s2 = hwy::N_AVX2::Add(s2, simd_vector2);
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = sum(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_SumVector, avx2, HWY_AVX2, hwy::N_AVX2::SumVector)->Name(BENCH_NAME("BM_SumVector"))->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_SumVector, avx2, HWY_AVX2, hwy::N_AVX2::SumVector)->Name(BENCH_NAME("BM_SumVector"))->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVector, avx512, HWY_AVX3, hwy::N_AVX3::SumVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVector, avx512, HWY_AVX3, hwy::N_AVX3::SumVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+void BM_SumVectorWide(benchmark::State& state, int64_t target, int64_t (*sum)(const int*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateSumWide(state, KernelKey("BM_SumVectorWide", target), sum)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = sum(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx2, HWY_AVX2, hwy::N_AVX2::SumVectorWide)->Name(BENCH_NAME("BM_SumVectorWide"))->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx2, HWY_AVX2, hwy::N_AVX2::SumVectorWide)->Name(BENCH_NAME("BM_SumVectorWide"))->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx512, HWY_AVX3, hwy::N_AVX3::SumVectorWide)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx512, HWY_AVX3, hwy::N_AVX3::SumVectorWide)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Floating-point sums of a [0, 1) column, each reporting its relative error against a long double
+// reference. BM_<name>/<method> runs AVX2, BM_<name>/avx512_<method> runs AVX3.
+template <class T>
+void SumFloatingPoint(benchmark::State& state, int64_t target, const std::string& key, T (*sum)(const T*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateSumFloat<T>(state, key, sum)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillColumn(vector, N);
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = sum(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+  SetRelativeError(state, res, ReferenceSum(vector, N));
+}
+
+void BM_SumVectorFloat(benchmark::State& state, int64_t target, const char* variant, float (*sum)(const float*, int)) {
+  SumFloatingPoint(state, target, KernelKey("BM_SumVectorFloat", target) + "/" + variant, sum);
+}
+BENCHMARK_CAPTURE(BM_SumVectorFloat, plain, HWY_AVX2, "plain", hwy::N_AVX2::SumFloatPlain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, plain, HWY_AVX2, "plain", hwy::N_AVX2::SumFloatPlain)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, pairwise, HWY_AVX2, "pairwise", hwy::N_AVX2::SumFloatPairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, pairwise, HWY_AVX2, "pairwise", hwy::N_AVX2::SumFloatPairwise)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, compensated, HWY_AVX2, "compensated", hwy::N_AVX2::SumFloatCompensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, compensated, HWY_AVX2, "compensated", hwy::N_AVX2::SumFloatCompensated)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx512_plain, HWY_AVX3, "plain", hwy::N_AVX3::SumFloatPlain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx512_pairwise, HWY_AVX3, "pairwise", hwy::N_AVX3::SumFloatPairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx512_compensated, HWY_AVX3, "compensated", hwy::N_AVX3::SumFloatCompensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+void BM_SumVectorDouble(benchmark::State& state, int64_t target, const char* variant, double (*sum)(const double*, int)) {
+  SumFloatingPoint(state, target, KernelKey("BM_SumVectorDouble", target) + "/" + variant, sum);
+}
+BENCHMARK_CAPTURE(BM_SumVectorDouble, plain, HWY_AVX2, "plain", hwy::N_AVX2::SumDoublePlain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, plain, HWY_AVX2, "plain", hwy::N_AVX2::SumDoublePlain)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, pairwise, HWY_AVX2, "pairwise", hwy::N_AVX2::SumDoublePairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, pairwise, HWY_AVX2, "pairwise", hwy::N_AVX2::SumDoublePairwise)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, compensated, HWY_AVX2, "compensated", hwy::N_AVX2::SumDoubleCompensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, compensated, HWY_AVX2, "compensated", hwy::N_AVX2::SumDoubleCompensated)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx512_plain, HWY_AVX3, "plain", hwy::N_AVX3::SumDoublePlain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx512_pairwise, HWY_AVX3, "pairwise", hwy::N_AVX3::SumDoublePairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx512_compensated, HWY_AVX3, "compensated", hwy::N_AVX3::SumDoubleCompensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_MinMaxVector(benchmark::State& state, int64_t target, T (*extreme)(const T*, int), bool largest) {
+  if (SkipUnsupported(state, target) || !ValidateExtreme<T>(state, KernelKey("BM_MinMaxVector", target) + (largest ? "/max_" : "/min_") + TypeKey<T>(), extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = extreme(vector, N);
 
-    auto s = hwy::N_AVX2::Add(s2, s1);
-    int t[8];
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
 
-    hwy::N_AVX2::Store(s, d, t);
-    
-    for (int i = 0; i < 8; ++i) 
-      res += t[i];
+  if (res != vector[ReferenceArgExtreme(vector, N, largest)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, HWY_AVX2, hwy::N_AVX2::MinInt, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, HWY_AVX2, hwy::N_AVX2::MinInt, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, HWY_AVX2, hwy::N_AVX2::MaxInt, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, HWY_AVX2, hwy::N_AVX2::MaxInt, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, HWY_AVX2, hwy::N_AVX2::MinFloat, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, HWY_AVX2, hwy::N_AVX2::MinFloat, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, HWY_AVX2, hwy::N_AVX2::MaxFloat, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, HWY_AVX2, hwy::N_AVX2::MaxFloat, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, HWY_AVX2, hwy::N_AVX2::MinDouble, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, HWY_AVX2, hwy::N_AVX2::MinDouble, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, HWY_AVX2, hwy::N_AVX2::MaxDouble, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, HWY_AVX2, hwy::N_AVX2::MaxDouble, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_min_i32, HWY_AVX3, hwy::N_AVX3::MinInt, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_max_i32, HWY_AVX3, hwy::N_AVX3::MaxInt, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_min_f32, HWY_AVX3, hwy::N_AVX3::MinFloat, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_max_f32, HWY_AVX3, hwy::N_AVX3::MaxFloat, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_min_f64, HWY_AVX3, hwy::N_AVX3::MinDouble, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_max_f64, HWY_AVX3, hwy::N_AVX3::MaxDouble, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ArgMinMaxVector(benchmark::State& state, int64_t target, int (*arg_extreme)(const T*, int), bool largest) {
+  if (SkipUnsupported(state, target) || !ValidateArgExtreme<T>(state, KernelKey("BM_ArgMinMaxVector", target) + (largest ? "/argmax_" : "/argmin_") + TypeKey<T>(), arg_extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = arg_extreme(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != ReferenceArgExtreme(vector, N, largest)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, HWY_AVX2, hwy::N_AVX2::ArgMinInt, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, HWY_AVX2, hwy::N_AVX2::ArgMinInt, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, HWY_AVX2, hwy::N_AVX2::ArgMaxInt, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, HWY_AVX2, hwy::N_AVX2::ArgMaxInt, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, HWY_AVX2, hwy::N_AVX2::ArgMinFloat, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, HWY_AVX2, hwy::N_AVX2::ArgMinFloat, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, HWY_AVX2, hwy::N_AVX2::ArgMaxFloat, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, HWY_AVX2, hwy::N_AVX2::ArgMaxFloat, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, HWY_AVX2, hwy::N_AVX2::ArgMinDouble, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, HWY_AVX2, hwy::N_AVX2::ArgMinDouble, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, HWY_AVX2, hwy::N_AVX2::ArgMaxDouble, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, HWY_AVX2, hwy::N_AVX2::ArgMaxDouble, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmin_i32, HWY_AVX3, hwy::N_AVX3::ArgMinInt, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmax_i32, HWY_AVX3, hwy::N_AVX3::ArgMaxInt, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmin_f32, HWY_AVX3, hwy::N_AVX3::ArgMinFloat, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmax_f32, HWY_AVX3, hwy::N_AVX3::ArgMaxFloat, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmin_f64, HWY_AVX3, hwy::N_AVX3::ArgMinDouble, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmax_f64, HWY_AVX3, hwy::N_AVX3::ArgMaxDouble, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+// Prefix sums of row lengths (int) and of a [0, 1) column (float), checked against a sequential
+// scan, next to std::inclusive_scan / std::exclusive_scan on the same data.
+template <class T>
+void PrefixSumOf(benchmark::State& state, const std::string& key, void (*scan)(const T*, T*, int), bool inclusive) {
+  if (!ValidateScan<T>(state, key, scan, inclusive)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> in_buffer(N);
+  aligned_buffer<T> out_buffer(N);
+  T* in = in_buffer.data();
+  T* out = out_buffer.data();
+  if constexpr (std::is_integral_v<T>) FillLengths(in, N);
+  else FillColumn(in, N);
+
+  for (auto _ : PerfLoop(state)) {
+    scan(in, out, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  CheckPrefixSum(state, in, out, N, inclusive);
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
-void BM_ReverseVector(benchmark::State& state) {
+template <class T>
+void BM_ScanVector(benchmark::State& state, int64_t target, void (*scan)(const T*, T*, int), bool inclusive) {
+  if (SkipUnsupported(state, target)) return;
+  PrefixSumOf(state, KernelKey("BM_ScanVector", target) + (inclusive ? "/inclusive_" : "/exclusive_") + TypeKey<T>(), scan, inclusive);
+}
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_i32, HWY_AVX2, hwy::N_AVX2::ScanInclusiveInt, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_i32, HWY_AVX2, hwy::N_AVX2::ScanInclusiveInt, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_i32, HWY_AVX2, hwy::N_AVX2::ScanExclusiveInt, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_i32, HWY_AVX2, hwy::N_AVX2::ScanExclusiveInt, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_f32, HWY_AVX2, hwy::N_AVX2::ScanInclusiveFloat, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_f32, HWY_AVX2, hwy::N_AVX2::ScanInclusiveFloat, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_f32, HWY_AVX2, hwy::N_AVX2::ScanExclusiveFloat, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_f32, HWY_AVX2, hwy::N_AVX2::ScanExclusiveFloat, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_inclusive_i32, HWY_AVX3, hwy::N_AVX3::ScanInclusiveInt, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_exclusive_i32, HWY_AVX3, hwy::N_AVX3::ScanExclusiveInt, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_inclusive_f32, HWY_AVX3, hwy::N_AVX3::ScanInclusiveFloat, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_exclusive_f32, HWY_AVX3, hwy::N_AVX3::ScanExclusiveFloat, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+// The sequential baseline: every output depends on the one before it.
+template <class T, bool Inclusive>
+void StdPrefixSum(const T* in, T* out, int N) {
+  if (Inclusive) std::inclusive_scan(in, in + N, out);
+  else std::exclusive_scan(in, in + N, out, T(0));
+}
+
+template <class T>
+void BM_ScanVectorStd(benchmark::State& state, void (*scan)(const T*, T*, int), bool inclusive) {
+  PrefixSumOf(state, std::string(inclusive ? "BM_ScanVectorStd/inclusive_" : "BM_ScanVectorStd/exclusive_") + TypeKey<T>(), scan, inclusive);
+}
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_i32, StdPrefixSum<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_i32, StdPrefixSum<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_i32, StdPrefixSum<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_i32, StdPrefixSum<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_f32, StdPrefixSum<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_f32, StdPrefixSum<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_f32, StdPrefixSum<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_f32, StdPrefixSum<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_ReverseVector(benchmark::State& state, int64_t target, void (*reverse)(int*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateReverse<int>(state, KernelKey("BM_ReverseVector", target), reverse)) return;
   int N = state.range(1) - state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
 
-  for (auto _ : state) {
-    const HWY_FULL(int) d;
-    for (int i = 0; i < N / 2; i += 8) {
-      auto simd_vector1 = hwy::N_AVX2::Load(d, &vector[i]);
-      auto simd_vector2 = hwy::N_AVX2::Load(d, &vector[N - i - 8]);
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
 
-      hwy::N_AVX2::Reverse(d, simd_vector1);
-      hwy::N_AVX2::Reverse(d, simd_vector2);
+    benchmark::ClobberMemory();
+  }
 
-      hwy::N_AVX2::Store(simd_vector2, d, &vector[i]);
-      hwy::N_AVX2::Store(simd_vector1, d, &vector[N - i - 8]);
-    }
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_ReverseVector, avx2, HWY_AVX2, hwy::N_AVX2::ReverseVector)->Name(BENCH_NAME("BM_ReverseVector"))->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx2, HWY_AVX2, hwy::N_AVX2::ReverseVector)->Name(BENCH_NAME("BM_ReverseVector"))->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx512, HWY_AVX3, hwy::N_AVX3::ReverseVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx512, HWY_AVX3, hwy::N_AVX3::ReverseVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Reverse at every element width, in place and into a second buffer. BM_<name>/<width> runs AVX2,
+// BM_<name>/avx512_<width> runs AVX3. N counts elements; compare bytes_per_second across widths.
+template <class T>
+void BM_ReverseVectorWidth(benchmark::State& state, int64_t target, void (*reverse)(T*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateReverse<T>(state, KernelKey("BM_ReverseVectorWidth", target) + "/" + TypeKey<T>(), reverse)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, HWY_AVX2, hwy::N_AVX2::ReverseU8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, HWY_AVX2, hwy::N_AVX2::ReverseU8)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, HWY_AVX2, hwy::N_AVX2::ReverseU16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, HWY_AVX2, hwy::N_AVX2::ReverseU16)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, HWY_AVX2, hwy::N_AVX2::ReverseU32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, HWY_AVX2, hwy::N_AVX2::ReverseU32)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, HWY_AVX2, hwy::N_AVX2::ReverseU64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, HWY_AVX2, hwy::N_AVX2::ReverseU64)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u8, HWY_AVX3, hwy::N_AVX3::ReverseU8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u16, HWY_AVX3, hwy::N_AVX3::ReverseU16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u32, HWY_AVX3, hwy::N_AVX3::ReverseU32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u64, HWY_AVX3, hwy::N_AVX3::ReverseU64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
 
+template <class T>
+void BM_ReverseCopyVector(benchmark::State& state, int64_t target, void (*reverse_copy)(const T*, T*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateReverseCopy<T>(state, KernelKey("BM_ReverseCopyVector", target) + "/" + TypeKey<T>(), reverse_copy)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, HWY_AVX2, hwy::N_AVX2::ReverseCopyU8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, HWY_AVX2, hwy::N_AVX2::ReverseCopyU8)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, HWY_AVX2, hwy::N_AVX2::ReverseCopyU16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, HWY_AVX2, hwy::N_AVX2::ReverseCopyU16)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, HWY_AVX2, hwy::N_AVX2::ReverseCopyU32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, HWY_AVX2, hwy::N_AVX2::ReverseCopyU32)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, HWY_AVX2, hwy::N_AVX2::ReverseCopyU64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, HWY_AVX2, hwy::N_AVX2::ReverseCopyU64)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u8, HWY_AVX3, hwy::N_AVX3::ReverseCopyU8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u16, HWY_AVX3, hwy::N_AVX3::ReverseCopyU16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u32, HWY_AVX3, hwy::N_AVX3::ReverseCopyU32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u64, HWY_AVX3, hwy::N_AVX3::ReverseCopyU64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+// Element-wise kernels from L1-resident to DRAM-sized arrays (ElementwiseSweep), with bytes/s and
+// FLOP/s to set against the machine's peaks: add out = a + b (AddVectors), AXPY y = alpha * x + y,
+// FMA out = a * x + b and the triad out = b + q * c.
+void BM_AddArrays(benchmark::State& state, int64_t target, void (*add)(const double*, const double*, double*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateAdd(state, KernelKey("BM_AddArrays", target), add)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    add(v.a.data(), v.b.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
     benchmark::ClobberMemory();
   }
-}BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
-BENCHMARK_MAIN();
+  SetElementwiseCounters(state, N, 3, 1);
+}
+BENCHMARK_CAPTURE(BM_AddArrays, avx2, HWY_AVX2, hwy::N_AVX2::AddVectors)->Name(BENCH_NAME("BM_AddArrays"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddArrays, avx512, HWY_AVX3, hwy::N_AVX3::AddVectors)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Axpy(benchmark::State& state, int64_t target, void (*axpy)(double, const double*, double*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateAxpy(state, KernelKey("BM_Axpy", target), axpy)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    axpy(kElementwiseScale, v.a.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK_CAPTURE(BM_Axpy, avx2, HWY_AVX2, hwy::N_AVX2::Axpy)->Name(BENCH_NAME("BM_Axpy"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Axpy, avx512, HWY_AVX3, hwy::N_AVX3::Axpy)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_MultiplyAdd(benchmark::State& state, int64_t target, void (*fma)(const double*, const double*, const double*, double*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateMultiplyAdd(state, KernelKey("BM_MultiplyAdd", target), fma)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    fma(v.a.data(), v.b.data(), v.c.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 4, 2);
+}
+BENCHMARK_CAPTURE(BM_MultiplyAdd, avx2, HWY_AVX2, hwy::N_AVX2::MultiplyAdd)->Name(BENCH_NAME("BM_MultiplyAdd"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MultiplyAdd, avx512, HWY_AVX3, hwy::N_AVX3::MultiplyAdd)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Triad(benchmark::State& state, int64_t target, void (*triad)(const double*, const double*, double, double*, int)) {
+  if (SkipUnsupported(state, target) || !ValidateTriad(state, KernelKey("BM_Triad", target), triad)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    triad(v.b.data(), v.c.data(), kElementwiseScale, v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK_CAPTURE(BM_Triad, avx2, HWY_AVX2, hwy::N_AVX2::Triad)->Name(BENCH_NAME("BM_Triad"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Triad, avx512, HWY_AVX3, hwy::N_AVX3::Triad)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+} // namespace
+
+BACKEND_MAIN();
+
+#endif // HWY_ONCE
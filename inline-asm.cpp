@@ -1,24 +1,32 @@
 //TO COMPILE: g++ inline-asm.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -march=native -DNDEBUG -o inline-asm
 #include <algorithm>
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
 #include <immintrin.h>
 #include <numeric>
 
+namespace {
+
+void AddVectors(const double* data_a, const double* data_b, double* result) {
+  asm volatile (
+      "vmovupd (%0), %%ymm0\n\t"        // Load the 4 doubles of data_a into ymm0
+      "vmovupd (%1), %%ymm1\n\t"        // Load the 4 doubles of data_b into ymm1
+      "vaddpd %%ymm1, %%ymm0, %%ymm0\n\t" // Add them as doubles
+      "vmovupd %%ymm0, (%2)\n\t"        // Store result from ymm0 to result
+      :                                  // No output
+      : "r" (data_a), "r" (data_b), "r" (result)  // Input
+      : "%xmm0", "%xmm1", "memory"       // Clobbered registers, and result is written
+  );
+}
+
 void BM_AddVectors(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors)) return;
   double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double result[4];
 
-  for (auto _ : state) {
-    asm volatile (
-        "movdqu (%0), %%xmm0\n\t"         // Load data_a into xmm0
-        "movdqu (%1), %%xmm1\n\t"         // Load data_b into xmm1
-        "paddd %%xmm1, %%xmm0\n\t"        // Add xmm1 to xmm0
-        "movupd %%xmm0, (%2)\n\t"         // Store result from xmm0 to result
-        :                                  // No output
-        : "r" (data_a), "r" (data_b), "r" (result)  // Input
-        : "%xmm0", "%xmm1"                 // Clobbered registers
-    );
+  for (auto _ : PerfLoop(state)) {
+    AddVectors(data_a, data_b, result);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
@@ -26,207 +34,996 @@ void BM_AddVectors(benchmark::State& state) {
 }
 BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
 
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors)) return;
+  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double result[4];
+
+  TimeCycles(state, 4, [&] {
+    AddVectors(data_a, data_b, result);
+
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_AddVectorsCycles)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+int FindInVector(const int* vector, int N, int target) {
+  int res = -1;
+  asm volatile (
+    // Set target in all elements of a YMM register
+    "movd %[target], %%xmm0\n\t"          // Move target into xmm0
+    "vpermilps $0, %%xmm0, %%xmm0\n\t"    // Broadcast the integer across xmm0
+    "vinsertf128 $1, %%xmm0, %%ymm0, %%ymm0\n\t" // Broadcast xmm0 to ymm0
+
+    // Initialize loop variables
+    "xor %%eax, %%eax\n\t"                // Clear eax for loop index
+    "test %[N], %[N]\n\t"                 // Skip the loop if there is no whole vector
+    "jle 3f\n\t"
+
+    ".p2align 4\n"                        // Align loop entry point to 16 bytes
+    "1:\n\t"
+    "vmovdqu (%[vec], %%rax, 4), %%ymm1\n\t" // Load 8 integers from vector
+    "vpcmpeqd %%ymm0, %%ymm1, %%ymm2\n\t"    // Compare 8 integers with target
+    "vmovmskps %%ymm2, %%edx\n\t"        // Move comparison mask to edx
+
+    "test %%edx, %%edx\n\t"               // Test if any bits are set
+    "jz 2f\n\t"                           // Jump to next iteration if none are set
+
+    "tzcnt %%edx, %%edx\n\t"              // Count trailing zeros in mask
+    "add %%eax, %%edx\n\t"                // Add base index to the bit position
+    "mov %%edx, %[res]\n\t"               // Move result to output variable
+    "jmp 3f\n\t"                          // Jump to end
+
+    "2:\n\t"
+    "add $8, %%eax\n\t"                   // Increment loop index
+    "cmp %[N], %%eax\n\t"                 // Compare with N
+    "jl 1b\n\t"                           // Jump back if not reached end
+
+    "3:\n\t"
+
+    : [res] "+r" (res)                    // Output
+    : [target] "r" (target), [vec] "r" (vector), [N] "r" (N & ~7) // Inputs, N rounded down to whole vectors
+    : "%eax", "%edx", "%xmm0", "%ymm0", "%ymm1", "%ymm2", "cc", "memory" // Clobbers
+  );
+
+  // Scalar epilogue for the last N % 8 elements.
+  for (int i = N & ~7; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
+  }
+  return res;
+}
+
 void BM_FindInVector(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVector", FindInVector)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    asm volatile (
-      // Set target in all elements of a YMM register
-      "movd %[target], %%xmm0\n\t"          // Move target into xmm0
-      "vpermilps $0, %%xmm0, %%xmm0\n\t"    // Broadcast the integer across xmm0
-      "vinsertf128 $1, %%xmm0, %%ymm0, %%ymm0\n\t" // Broadcast xmm0 to ymm0
-
-      // Initialize loop variables
-      "xor %%eax, %%eax\n\t"                // Clear eax for loop index
-
-      ".p2align 4\n"                        // Align loop entry point to 16 bytes
-      "1:\n\t"
-      "vmovdqu (%[vec], %%rax, 4), %%ymm1\n\t" // Load 8 integers from vector
-      "vpcmpeqd %%ymm0, %%ymm1, %%ymm2\n\t"    // Compare 8 integers with target
-      "vmovmskps %%ymm2, %%edx\n\t"        // Move comparison mask to edx
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVector(vector, N, target);
 
-      "test %%edx, %%edx\n\t"               // Test if any bits are set
-      "jz 2f\n\t"                           // Jump to next iteration if none are set
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
 
-      "tzcnt %%edx, %%edx\n\t"              // Count trailing zeros in mask
-      "add %%eax, %%edx\n\t"                // Add base index to the bit position
-      "mov %%edx, %[res]\n\t"               // Move result to output variable
-      "jmp 3f\n\t"                          // Jump to end
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVector)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
 
+int FindInVectorFaster(const int* vector, int N, int target) {
+  int res = -1;
+  asm volatile (
+      "vmovd %[target], %%xmm0\n\t"
+      "vpbroadcastd %%xmm0, %%ymm0\n\t"
+      "xor %%eax, %%eax\n\t" // Loop index set to zero
+      "1:\n\t"
+      "cmp %[N], %%eax\n\t"
+      "jge 3f\n\t" // Jump to end if index exceeds N
+                   // Load and compare sets of 8 integers
+      "vmovdqu (%[vec], %%rax, 4), %%ymm1\n\t"
+      "vpcmpeqd %%ymm0, %%ymm1, %%ymm1\n\t"
+      "vmovdqu 32(%[vec], %%rax, 4), %%ymm2\n\t"
+      "vpcmpeqd %%ymm0, %%ymm2, %%ymm2\n\t"
+      "vmovdqu 64(%[vec], %%rax, 4), %%ymm3\n\t"
+      "vpcmpeqd %%ymm0, %%ymm3, %%ymm3\n\t"
+      "vmovdqu 96(%[vec], %%rax, 4), %%ymm4\n\t"
+      "vpcmpeqd %%ymm0, %%ymm4, %%ymm4\n\t"
+      // Combine results
+      "vpor %%ymm2, %%ymm1, %%ymm5\n\t"
+      "vpor %%ymm3, %%ymm4, %%ymm6\n\t"
+      "vpor %%ymm5, %%ymm6, %%ymm7\n\t"
+      "vmovmskps %%ymm7, %%edi\n\t"
+      "test %%edi, %%edi\n\t"
+      "jz 2f\n\t" // If zero, no matches, jump to next iteration
+                  // Check each mask individually if combined mask shows a match
+      "vmovmskps %%ymm1, %%edi\n\t"
+      "test %%edi, %%edi\n\t"
+      "jz 4f\n\t"
+      "tzcnt %%edi, %%edi\n\t"
+      "add %%eax, %%edi\n\t"
+      "mov %%edi, %[res]\n\t"
+      "jmp 3f\n\t"
+      "4:\n\t"
+      "vmovmskps %%ymm2, %%edi\n\t"
+      "test %%edi, %%edi\n\t"
+      "jz 5f\n\t"
+      "tzcnt %%edi, %%edi\n\t"
+      "add $8, %%edi\n\t"
+      "add %%eax, %%edi\n\t"
+      "mov %%edi, %[res]\n\t"
+      "jmp 3f\n\t"
+      "5:\n\t"
+      "vmovmskps %%ymm3, %%edi\n\t"
+      "test %%edi, %%edi\n\t"
+      "jz 6f\n\t"
+      "tzcnt %%edi, %%edi\n\t"
+      "add $16, %%edi\n\t"
+      "add %%eax, %%edi\n\t"
+      "mov %%edi, %[res]\n\t"
+      "jmp 3f\n\t"
+      "6:\n\t"
+      "vmovmskps %%ymm4, %%edi\n\t"
+      "tzcnt %%edi, %%edi\n\t"
+      "add $24, %%edi\n\t"
+      "add %%eax, %%edi\n\t"
+      "mov %%edi, %[res]\n\t"
+      "jmp 3f\n\t"
       "2:\n\t"
-      "add $8, %%eax\n\t"                   // Increment loop index
-      "cmp %[N], %%eax\n\t"                 // Compare with N
-      "jl 1b\n\t"                           // Jump back if not reached end
-
+      "add $32, %%eax\n\t"
+      "jmp 1b\n\t" // Continue loop
       "3:\n\t"
-
-      : [res] "=r" (res)                    // Output
-      : [target] "r" (target), [vec] "r" (vector), [N] "r" (N) // Inputs
-      : "%eax", "%edx", "%xmm0", "%ymm0", "%ymm1", "%ymm2", "cc", "memory" // Clobbers
+      : [res] "+r" (res)  // Output
+      : [target] "r" (target), [vec] "r" (vector), [N] "r" (N & ~31)  // Inputs, N rounded down to whole blocks
+      : "eax", "edi", "xmm0", "ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "cc", "memory"  // Clobbers
     );
 
-    benchmark::DoNotOptimize(res);
-    benchmark::ClobberMemory();
+  // Scalar epilogue for the last N % 32 elements.
+  for (int i = N & ~31; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
   }
+  return res;
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_FindInVectorFaster(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster)) return;
   int target = state.range(0);
   int N = state.range(1);
-  alignas(32) int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill_n(vector, N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVectorFaster)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// The early-exit find on the FindScenario inputs, which move the target on every call so the exit
+// cannot be learned (see FindScenarioInput in bench-utils.h).
+void BM_FindInVectorScenario(benchmark::State& state, FindScenario scenario) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_position, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, absent, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, near_start, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, duplicates, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_data, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// memchr with vpcmpeqb/vpmovmskb over 32 bytes per step, in the style of BM_FindInVector. N counts
+// bytes.
+int FindByte(const uint8_t* text, int N, uint8_t target) {
+  int64_t i = 0;
+  int64_t whole = N & ~31;
+  int res = -1;
+
+  asm volatile (
+    "test %[whole], %[whole]\n\t"           // Skip the loop if there is no whole vector
+    "jz 3f\n\t"
+    "vpbroadcastb %[target], %%ymm0\n\t"    // Set target in all 32 bytes of YMM0
+
+    "1:\n\t"
+    "vpcmpeqb (%[text], %[i]), %%ymm0, %%ymm1\n\t" // Compare 32 bytes with target
+    "vpmovmskb %%ymm1, %%edx\n\t"           // One mask bit per byte
+    "test %%edx, %%edx\n\t"
+    "jz 2f\n\t"
+    "tzcnt %%edx, %%edx\n\t"                // First matching byte
+    "add %k[i], %%edx\n\t"
+    "mov %%edx, %[res]\n\t"
+    "jmp 3f\n\t"
+
+    "2:\n\t"
+    "add $32, %[i]\n\t"
+    "cmp %[whole], %[i]\n\t"
+    "jl 1b\n\t"
+    "3:\n\t"
+
+    : [i] "+r" (i), [res] "+r" (res)
+    : [text] "r" (text), [target] "m" (target), [whole] "r" (whole)
+    : "%edx", "xmm0", "xmm1", "cc", "memory"
+  );
+
+  // Scalar epilogue for the last N % 32 bytes.
+  for (int j = whole; res == -1 && j < N; ++j) {
+    if (text[j] == target) res = j;
+  }
+  return res;
+}
+
+// The asm loop runs until a block of 32 positions has a candidate, a position where the first
+// needle byte matches and the last one matches M - 1 bytes further on; the candidates are then
+// compared in full in C++, and the loop resumes after the block if none of them matches.
+int FindSubstring(const uint8_t* text, int N, const uint8_t* needle, int M) {
+  if (M == 0) return 0;
+  int64_t i = 0;
+  int64_t limit = int64_t(N) - M - 31;   // Last block start whose last-byte load stays in the text
+
+  while (i <= limit) {
+    uint32_t mask;
     asm volatile (
-        "vmovd %[target], %%xmm0\n\t"
-        "vpbroadcastd %%xmm0, %%ymm0\n\t"
-        "xor %%eax, %%eax\n\t" // Loop index set to zero
-        "1:\n\t"
-        "cmp %[N], %%eax\n\t"
-        "jge 3f\n\t" // Jump to end if index exceeds N
-                     // Load and compare sets of 8 integers
-        "vmovdqu (%[vec], %%rax, 4), %%ymm1\n\t"
-        "vpcmpeqd %%ymm0, %%ymm1, %%ymm1\n\t"
-        "vmovdqu 32(%[vec], %%rax, 4), %%ymm2\n\t"
-        "vpcmpeqd %%ymm0, %%ymm2, %%ymm2\n\t"
-        "vmovdqu 64(%[vec], %%rax, 4), %%ymm3\n\t"
-        "vpcmpeqd %%ymm0, %%ymm3, %%ymm3\n\t"
-        "vmovdqu 96(%[vec], %%rax, 4), %%ymm4\n\t"
-        "vpcmpeqd %%ymm0, %%ymm4, %%ymm4\n\t"
-        // Combine results
-        "vpor %%ymm2, %%ymm1, %%ymm5\n\t"
-        "vpor %%ymm3, %%ymm4, %%ymm6\n\t"
-        "vpor %%ymm5, %%ymm6, %%ymm7\n\t"
-        "vmovmskps %%ymm7, %%edi\n\t"
-        "test %%edi, %%edi\n\t"
-        "jz 2f\n\t" // If zero, no matches, jump to next iteration
-                    // Check each mask individually if combined mask shows a match
-        "vmovmskps %%ymm1, %%edi\n\t"
-        "test %%edi, %%edi\n\t"
-        "jz 4f\n\t"
-        "tzcnt %%edi, %%edi\n\t"
-        "add %%eax, %%edi\n\t"
-        "mov %%edi, %[res]\n\t"
-        "jmp 3f\n\t"
-        "4:\n\t"
-        "vmovmskps %%ymm2, %%edi\n\t"
-        "test %%edi, %%edi\n\t"
-        "jz 5f\n\t"
-        "tzcnt %%edi, %%edi\n\t"
-        "add $8, %%edi\n\t"
-        "add %%eax, %%edi\n\t"
-        "mov %%edi, %[res]\n\t"
-        "jmp 3f\n\t"
-        "5:\n\t"
-        "vmovmskps %%ymm3, %%edi\n\t"
-        "test %%edi, %%edi\n\t"
-        "jz 6f\n\t"
-        "tzcnt %%edi, %%edi\n\t"
-        "add $16, %%edi\n\t"
-        "add %%eax, %%edi\n\t"
-        "mov %%edi, %[res]\n\t"
-        "jmp 3f\n\t"
-        "6:\n\t"
-        "vmovmskps %%ymm4, %%edi\n\t"
-        "tzcnt %%edi, %%edi\n\t"
-        "add $24, %%edi\n\t"
-        "add %%eax, %%edi\n\t"
-        "mov %%edi, %[res]\n\t"
-        "2:\n\t"
-        "add $32, %%eax\n\t"
-        "jmp 1b\n\t" // Continue loop
-        "3:\n\t"
-        : [res] "+r" (res)  // Output
-        : [target] "r" (target), [vec] "r" (vector), [N] "r" (N)  // Inputs
-        : "eax", "edi", "xmm0", "ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "cc", "memory"  // Clobbers
-      );
+      "vpbroadcastb %[first], %%ymm0\n\t"
+      "vpbroadcastb %[last], %%ymm1\n\t"
+      "1:\n\t"
+      "vpcmpeqb (%[text], %[i]), %%ymm0, %%ymm2\n\t"  // First needle byte at each of 32 positions
+      "vpcmpeqb (%[tail], %[i]), %%ymm1, %%ymm3\n\t"  // Last needle byte, M - 1 bytes further on
+      "vpand %%ymm3, %%ymm2, %%ymm2\n\t"
+      "vpmovmskb %%ymm2, %[mask]\n\t"
+      "test %[mask], %[mask]\n\t"
+      "jnz 2f\n\t"
+      "add $32, %[i]\n\t"
+      "cmp %[limit], %[i]\n\t"
+      "jle 1b\n\t"
+      "2:\n\t"
+      : [i] "+r" (i), [mask] "=&r" (mask)
+      : [text] "r" (text), [tail] "r" (text + M - 1), [first] "m" (needle[0]), [last] "m" (needle[M - 1]), [limit] "r" (limit)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "cc", "memory"
+    );
+    if (mask == 0) break;
+
+    for (; mask != 0; mask &= mask - 1) {
+      int j = i + __builtin_ctz(mask);
+      if (std::equal(needle + 1, needle + M, &text[j + 1])) return j;
+    }
+    i += 32;
+  }
+
+  // Scalar epilogue for the positions whose last byte is past the final whole block.
+  for (; i + M <= N; ++i) {
+    if (std::equal(needle, needle + M, &text[i])) return i;
+  }
+  return -1;
+}
+
+void BM_FindByte(benchmark::State& state) {
+  if (!ValidateFindByte(state, "BM_FindByte", FindByte)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindByte(text, N, kDelimiter);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != state.range(1)) state.SkipWithError("FindByte returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindByte)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstring(benchmark::State& state) {
+  if (!ValidateFindSubstring(state, "BM_FindSubstring", FindSubstring)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int start = PlaceNeedle(text, state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindSubstring(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("FindSubstring returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstring)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+int SumVector(const int* vector, int N) {
+  int res = 0;
+  asm volatile (
+    "vxorps %%ymm1, %%ymm1, %%ymm1\n\t" // Zero out ymm1
+    "vxorps %%ymm2, %%ymm2, %%ymm2\n\t" // Zero out ymm2
+    "mov %[N], %%ecx\n\t"               // Move N into ecx
+    "mov %[vector], %%rdi\n\t"          // Load address of vector into rdi
+    "test %%ecx, %%ecx\n\t"             // Skip the loop if there is no whole block
+    "jz 2f\n\t"
+
+    ".p2align 4\n\t"
+    "1:\n\t"
+    "vpaddd (%%rdi), %%ymm1, %%ymm1\n\t" // Add 8 integers from vector to ymm1
+    "vpaddd 32(%%rdi), %%ymm2, %%ymm2\n\t" // Add next 8 integers to ymm2
+    "add $64, %%rdi\n\t"               // Move to the next 16 integers
+    "sub $16, %%ecx\n\t"               // Decrement loop counter by 16
+    "jg 1b\n\t"                        // Jump back if still more than 16 elements left
+
+    "2:\n\t"
+    "vpaddd %%ymm2, %%ymm1, %%ymm1\n\t" // Add sums from ymm2 and ymm1
+    "vextracti128 $1, %%ymm1, %%xmm2\n\t" // Extract the upper 128 bits
+    "vpaddd %%xmm2, %%xmm1, %%xmm1\n\t" // Add upper 128 to lower 128
+    "vpshufd $0x4e, %%xmm1, %%xmm2\n\t" // Shuffle to prepare for final addition
+    "vpaddd %%xmm2, %%xmm1, %%xmm1\n\t" // Horizontal add
+    "vpshufd $0xb1, %%xmm1, %%xmm2\n\t" // Another shuffle
+    "vpaddd %%xmm2, %%xmm1, %%xmm1\n\t" // Add to get final sum in the lowest dword
+    "vmovd %%xmm1, %[res]\n\t"          // Move result to scalar register
+
+    : [res] "=r" (res) // Output
+    : "[res]" (res), "m" (vector[0]), [vector] "r" (vector), [N] "r" (N & ~15) // Inputs, N rounded down to whole blocks
+    : "%ymm1", "%ymm2", "%xmm1", "%xmm2", "%rdi", "%ecx", "memory", "cc" // Clobbers
+  );
+
+  // Scalar epilogue for the last N % 16 elements.
+  for (int i = N & ~15; i < N; ++i)
+    res += vector[i];
+  return res;
 }
-BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_SumVector(benchmark::State& state) {
+  if (!ValidateSum(state, "BM_SumVector", SumVector)) return;
   int N = state.range(1) - state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota(vector, vector + N, state.range(0));
   int res;
 
-  for (auto _ : state) {
+  for (auto _ : PerfLoop(state)) {
+    res = SumVector(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+int64_t SumVectorWide(const int* vector, int N) {
+  int64_t res;
+  asm volatile (
+    "vpxor %%ymm1, %%ymm1, %%ymm1\n\t" // Zero out ymm1
+    "vpxor %%ymm2, %%ymm2, %%ymm2\n\t" // Zero out ymm2
+    "mov %[N], %%ecx\n\t"               // Move N into ecx
+    "mov %[vector], %%rdi\n\t"          // Load address of vector into rdi
+    "test %%ecx, %%ecx\n\t"             // Skip the loop if there is no whole block
+    "jz 2f\n\t"
+
+    ".p2align 4\n\t"
+    "1:\n\t"
+    "vpmovsxdq (%%rdi), %%ymm3\n\t"     // Sign-extend 4 integers to 64 bits
+    "vpmovsxdq 16(%%rdi), %%ymm4\n\t"   // Sign-extend the next 4
+    "vpaddq %%ymm3, %%ymm1, %%ymm1\n\t" // Accumulate in 64-bit lanes
+    "vpaddq %%ymm4, %%ymm2, %%ymm2\n\t"
+    "add $32, %%rdi\n\t"                // Move to the next 8 integers
+    "sub $8, %%ecx\n\t"                 // Decrement loop counter by 8
+    "jg 1b\n\t"                         // Jump back if still more than 8 elements left
+
+    "2:\n\t"
+    "vpaddq %%ymm2, %%ymm1, %%ymm1\n\t" // Add sums from ymm2 and ymm1
+    "vextracti128 $1, %%ymm1, %%xmm2\n\t" // Extract the upper 128 bits
+    "vpaddq %%xmm2, %%xmm1, %%xmm1\n\t" // Add upper 128 to lower 128
+    "vpshufd $0x4e, %%xmm1, %%xmm2\n\t" // Swap the two 64-bit halves
+    "vpaddq %%xmm2, %%xmm1, %%xmm1\n\t" // Add to get final sum in the low qword
+    "vmovq %%xmm1, %[res]\n\t"          // Move result to scalar register
+
+    : [res] "=r" (res) // Output
+    : "m" (vector[0]), [vector] "r" (vector), [N] "r" (N & ~7) // Inputs, N rounded down to whole blocks
+    : "%ymm1", "%ymm2", "%ymm3", "%ymm4", "%rdi", "%ecx", "memory", "cc" // Clobbers
+  );
+
+  // Scalar epilogue for the last N % 8 elements.
+  for (int i = N & ~7; i < N; ++i)
+    res += vector[i];
+  return res;
+}
+
+void BM_SumVectorWide(benchmark::State& state) {
+  if (!ValidateSumWide(state, "BM_SumVectorWide", SumVectorWide)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota(vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = SumVectorWide(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVectorWide)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVectorWide)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Min/max of a random column, and the index of its first smallest or largest element, for int,
+// float and double. N must be at least 1. The max is the min of the values in reversed order, ~x for
+// int and -x (a sign-bit XOR) for float and double, so one asm loop per type serves both: it XORs
+// every vector with flip before comparing, and the C++ around it flips the result back.
+int Flip(int x, bool largest) { return largest ? ~x : x; }
+
+template <class T>
+T Flip(T x, bool largest) { return largest ? -x : x; }
+
+// Scalar epilogue from whole on, res is the flipped result of the asm loop.
+template <class T>
+T FinishExtreme(const T* vector, int N, int whole, T res, bool largest) {
+  for (int i = whole; i < N; ++i) {
+    T x = Flip(vector[i], largest);
+    res = x < res ? x : res;
+  }
+  return Flip(res, largest);
+}
+
+// Folds the best (flipped) value and its index per lane, the lowest index among equal values, then
+// compares the elements from whole on one by one; those come later, so they only win when lower.
+template <class T, class Index, int L>
+int FinishArgExtreme(const T* vector, int N, int whole, const T* best, const Index* at, bool largest) {
+  T res = Flip(vector[0], largest);
+  int res_at = 0;
+  for (int j = 0; whole > 0 && j < L; ++j) {
+    if (best[j] < res || (best[j] == res && at[j] < res_at)) {
+      res = best[j];
+      res_at = at[j];
+    }
+  }
+  for (int i = whole; i < N; ++i) {
+    T x = Flip(vector[i], largest);
+    if (x < res) {
+      res = x;
+      res_at = i;
+    }
+  }
+  return res_at;
+}
+
+alignas(32) constexpr int kLaneIndex[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+alignas(32) constexpr int64_t kLaneIndex64[4] = {0, 1, 2, 3};
+
+template <bool Max>
+int ExtremeInt(const int* vector, int N) {
+  int flip = Max ? -1 : 0;
+  int64_t i = 0;
+  int64_t whole = N & ~15;
+  int res = Flip(vector[0], Max);
+
+  if (whole) {
+    asm volatile (
+      "vpbroadcastd %[flip], %%ymm0\n\t"          // 0 for min, all ones for max
+      "vpxor (%[vector]), %%ymm0, %%ymm1\n\t"     // Start both accumulators from the first 8 elements
+      "vmovdqa %%ymm1, %%ymm2\n\t"
+
+      "1:\n\t"
+      "vpxor (%[vector], %[i], 4), %%ymm0, %%ymm3\n\t"
+      "vpxor 32(%[vector], %[i], 4), %%ymm0, %%ymm4\n\t"
+      "vpminsd %%ymm3, %%ymm1, %%ymm1\n\t"
+      "vpminsd %%ymm4, %%ymm2, %%ymm2\n\t"
+      "add $16, %[i]\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jl 1b\n\t"
+
+      "vpminsd %%ymm2, %%ymm1, %%ymm1\n\t"
+      "vextracti128 $1, %%ymm1, %%xmm2\n\t"       // Fold the upper 128 bits onto the lower
+      "vpminsd %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vpshufd $0x4e, %%xmm1, %%xmm2\n\t"
+      "vpminsd %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vpshufd $0xb1, %%xmm1, %%xmm2\n\t"
+      "vpminsd %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vmovd %%xmm1, %[res]\n\t"
+
+      : [i] "+r" (i), [res] "=r" (res)
+      : [vector] "r" (vector), [flip] "m" (flip), [whole] "r" (whole)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory"
+    );
+  }
+  return FinishExtreme(vector, N, whole, res, Max);
+}
+
+template <bool Max>
+float ExtremeFloat(const float* vector, int N) {
+  float flip = Max ? -0.0f : 0.0f;
+  int64_t i = 0;
+  int64_t whole = N & ~15;
+  float res = Flip(vector[0], Max);
+
+  if (whole) {
+    asm volatile (
+      "vbroadcastss %[flip], %%ymm0\n\t"          // 0 for min, the sign bit for max
+      "vxorps (%[vector]), %%ymm0, %%ymm1\n\t"
+      "vmovaps %%ymm1, %%ymm2\n\t"
+
+      "1:\n\t"
+      "vxorps (%[vector], %[i], 4), %%ymm0, %%ymm3\n\t"
+      "vxorps 32(%[vector], %[i], 4), %%ymm0, %%ymm4\n\t"
+      "vminps %%ymm3, %%ymm1, %%ymm1\n\t"
+      "vminps %%ymm4, %%ymm2, %%ymm2\n\t"
+      "add $16, %[i]\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jl 1b\n\t"
+
+      "vminps %%ymm2, %%ymm1, %%ymm1\n\t"
+      "vextractf128 $1, %%ymm1, %%xmm2\n\t"
+      "vminps %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vpermilps $0x4e, %%xmm1, %%xmm2\n\t"
+      "vminps %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vpermilps $0xb1, %%xmm1, %%xmm2\n\t"
+      "vminps %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vmovss %%xmm1, %[res]\n\t"
+
+      : [i] "+r" (i), [res] "=m" (res)
+      : [vector] "r" (vector), [flip] "m" (flip), [whole] "r" (whole)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory"
+    );
+  }
+  return FinishExtreme(vector, N, whole, res, Max);
+}
+
+template <bool Max>
+double ExtremeDouble(const double* vector, int N) {
+  double flip = Max ? -0.0 : 0.0;
+  int64_t i = 0;
+  int64_t whole = N & ~7;
+  double res = Flip(vector[0], Max);
+
+  if (whole) {
+    asm volatile (
+      "vbroadcastsd %[flip], %%ymm0\n\t"
+      "vxorpd (%[vector]), %%ymm0, %%ymm1\n\t"
+      "vmovapd %%ymm1, %%ymm2\n\t"
+
+      "1:\n\t"
+      "vxorpd (%[vector], %[i], 8), %%ymm0, %%ymm3\n\t"
+      "vxorpd 32(%[vector], %[i], 8), %%ymm0, %%ymm4\n\t"
+      "vminpd %%ymm3, %%ymm1, %%ymm1\n\t"
+      "vminpd %%ymm4, %%ymm2, %%ymm2\n\t"
+      "add $8, %[i]\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jl 1b\n\t"
+
+      "vminpd %%ymm2, %%ymm1, %%ymm1\n\t"
+      "vextractf128 $1, %%ymm1, %%xmm2\n\t"
+      "vminpd %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vpermilpd $1, %%xmm1, %%xmm2\n\t"
+      "vminpd %%xmm2, %%xmm1, %%xmm1\n\t"
+      "vmovsd %%xmm1, %[res]\n\t"
+
+      : [i] "+r" (i), [res] "=m" (res)
+      : [vector] "r" (vector), [flip] "m" (flip), [whole] "r" (whole)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "cc", "memory"
+    );
+  }
+  return FinishExtreme(vector, N, whole, res, Max);
+}
+
+// The arg loops keep the best value per lane in YMM1 and its index in YMM2, and blend both with the
+// same compare mask wherever a lane sees a strictly lower value.
+template <bool Max>
+int ArgExtremeInt(const int* vector, int N) {
+  int flip = Max ? -1 : 0;
+  int step = 8;
+  int64_t i = 8;
+  int64_t whole = N & ~7;
+  alignas(32) int best[8];
+  alignas(32) int at[8];
+
+  if (whole) {
+    asm volatile (
+      "vpbroadcastd %[flip], %%ymm0\n\t"
+      "vpbroadcastd %[step], %%ymm4\n\t"          // 8 in every lane
+      "vpxor (%[vector]), %%ymm0, %%ymm1\n\t"     // Best so far: the first 8 elements
+      "vmovdqa %[lanes], %%ymm2\n\t"              // and their indices
+      "vmovdqa %%ymm2, %%ymm3\n\t"                // Indices of the vector being compared
+      "cmp %[whole], %[i]\n\t"
+      "jge 2f\n\t"
+
+      "1:\n\t"
+      "vpaddd %%ymm4, %%ymm3, %%ymm3\n\t"
+      "vpxor (%[vector], %[i], 4), %%ymm0, %%ymm5\n\t"
+      "vpcmpgtd %%ymm5, %%ymm1, %%ymm6\n\t"       // best > x
+      "vpblendvb %%ymm6, %%ymm5, %%ymm1, %%ymm1\n\t"
+      "vpblendvb %%ymm6, %%ymm3, %%ymm2, %%ymm2\n\t"
+      "add $8, %[i]\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jl 1b\n\t"
+
+      "2:\n\t"
+      "vmovdqa %%ymm1, %[best]\n\t"
+      "vmovdqa %%ymm2, %[at]\n\t"
+
+      : [i] "+r" (i), [best] "=m" (best), [at] "=m" (at)
+      : [vector] "r" (vector), [flip] "m" (flip), [step] "m" (step), [lanes] "m" (kLaneIndex), [whole] "r" (whole)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "cc", "memory"
+    );
+  }
+  return FinishArgExtreme<int, int, 8>(vector, N, whole, best, at, Max);
+}
+
+template <bool Max>
+int ArgExtremeFloat(const float* vector, int N) {
+  float flip = Max ? -0.0f : 0.0f;
+  int step = 8;
+  int64_t i = 8;
+  int64_t whole = N & ~7;
+  alignas(32) float best[8];
+  alignas(32) int at[8];
+
+  if (whole) {
     asm volatile (
-      "vxorps %%ymm1, %%ymm1, %%ymm1\n\t" // Zero out ymm1
-      "vxorps %%ymm2, %%ymm2, %%ymm2\n\t" // Zero out ymm2
-      "mov %[N], %%ecx\n\t"               // Move N into ecx
-      "lea %[vector], %%rdi\n\t"          // Load address of vector into rdi
+      "vbroadcastss %[flip], %%ymm0\n\t"
+      "vpbroadcastd %[step], %%ymm4\n\t"
+      "vxorps (%[vector]), %%ymm0, %%ymm1\n\t"
+      "vmovdqa %[lanes], %%ymm2\n\t"
+      "vmovdqa %%ymm2, %%ymm3\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jge 2f\n\t"
 
-      ".p2align 4\n\t"
       "1:\n\t"
-      "vpaddd (%%rdi), %%ymm1, %%ymm1\n\t" // Add 8 integers from vector to ymm1
-      "vpaddd 32(%%rdi), %%ymm2, %%ymm2\n\t" // Add next 8 integers to ymm2
-      "add $64, %%rdi\n\t"               // Move to the next 16 integers
-      "sub $16, %%ecx\n\t"               // Decrement loop counter by 16
-      "jg 1b\n\t"                        // Jump back if still more than 16 elements left
-
-      "vpaddd %%ymm2, %%ymm1, %%ymm1\n\t" // Add sums from ymm2 and ymm1
-      "vextracti128 $1, %%ymm1, %%xmm2\n\t" // Extract the upper 128 bits
-      "vpaddd %%xmm2, %%xmm1, %%xmm1\n\t" // Add upper 128 to lower 128
-      "vpshufd $0x4e, %%xmm1, %%xmm2\n\t" // Shuffle to prepare for final addition
-      "vpaddd %%xmm2, %%xmm1, %%xmm1\n\t" // Horizontal add
-      "vpshufd $0xb1, %%xmm1, %%xmm2\n\t" // Another shuffle
-      "vpaddd %%xmm2, %%xmm1, %%xmm1\n\t" // Add to get final sum in the lowest dword
-      "vmovd %%xmm1, %[res]\n\t"          // Move result to scalar register
-
-      : [res] "=r" (res) // Output
-      : "[res]" (res), "m" (vector[0]), [vector] "m" (vector), [N] "r" (N) // Inputs
-      : "%ymm1", "%ymm2", "%xmm1", "%xmm2", "%rdi", "%ecx", "memory", "cc" // Clobbers
+      "vpaddd %%ymm4, %%ymm3, %%ymm3\n\t"
+      "vxorps (%[vector], %[i], 4), %%ymm0, %%ymm5\n\t"
+      "vcmpltps %%ymm1, %%ymm5, %%ymm6\n\t"       // x < best
+      "vblendvps %%ymm6, %%ymm5, %%ymm1, %%ymm1\n\t"
+      "vblendvps %%ymm6, %%ymm3, %%ymm2, %%ymm2\n\t"
+      "add $8, %[i]\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jl 1b\n\t"
+
+      "2:\n\t"
+      "vmovaps %%ymm1, %[best]\n\t"
+      "vmovdqa %%ymm2, %[at]\n\t"
+
+      : [i] "+r" (i), [best] "=m" (best), [at] "=m" (at)
+      : [vector] "r" (vector), [flip] "m" (flip), [step] "m" (step), [lanes] "m" (kLaneIndex), [whole] "r" (whole)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "cc", "memory"
     );
+  }
+  return FinishArgExtreme<float, int, 8>(vector, N, whole, best, at, Max);
+}
+
+// Four doubles per vector, so the indices go in 64-bit lanes to line up with the compare mask.
+template <bool Max>
+int ArgExtremeDouble(const double* vector, int N) {
+  double flip = Max ? -0.0 : 0.0;
+  int64_t step = 4;
+  int64_t i = 4;
+  int64_t whole = N & ~3;
+  alignas(32) double best[4];
+  alignas(32) int64_t at[4];
+
+  if (whole) {
+    asm volatile (
+      "vbroadcastsd %[flip], %%ymm0\n\t"
+      "vpbroadcastq %[step], %%ymm4\n\t"
+      "vxorpd (%[vector]), %%ymm0, %%ymm1\n\t"
+      "vmovdqa %[lanes], %%ymm2\n\t"
+      "vmovdqa %%ymm2, %%ymm3\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jge 2f\n\t"
+
+      "1:\n\t"
+      "vpaddq %%ymm4, %%ymm3, %%ymm3\n\t"
+      "vxorpd (%[vector], %[i], 8), %%ymm0, %%ymm5\n\t"
+      "vcmpltpd %%ymm1, %%ymm5, %%ymm6\n\t"
+      "vblendvpd %%ymm6, %%ymm5, %%ymm1, %%ymm1\n\t"
+      "vblendvpd %%ymm6, %%ymm3, %%ymm2, %%ymm2\n\t"
+      "add $4, %[i]\n\t"
+      "cmp %[whole], %[i]\n\t"
+      "jl 1b\n\t"
+
+      "2:\n\t"
+      "vmovapd %%ymm1, %[best]\n\t"
+      "vmovdqa %%ymm2, %[at]\n\t"
+
+      : [i] "+r" (i), [best] "=m" (best), [at] "=m" (at)
+      : [vector] "r" (vector), [flip] "m" (flip), [step] "m" (step), [lanes] "m" (kLaneIndex64), [whole] "r" (whole)
+      : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "cc", "memory"
+    );
+  }
+  return FinishArgExtreme<double, int64_t, 4>(vector, N, whole, best, at, Max);
+}
+
+template <class T>
+void BM_MinMaxVector(benchmark::State& state, T (*extreme)(const T*, int), bool largest) {
+  if (!ValidateExtreme<T>(state, "BM_MinMaxVector/" + std::string(largest ? "max_" : "min_") + TypeKey<T>(), extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = extreme(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != vector[ReferenceArgExtreme(vector, N, largest)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, ExtremeInt<false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, ExtremeInt<false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, ExtremeInt<true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, ExtremeInt<true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, ExtremeFloat<false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, ExtremeFloat<false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, ExtremeFloat<true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, ExtremeFloat<true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, ExtremeDouble<false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, ExtremeDouble<false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, ExtremeDouble<true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, ExtremeDouble<true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ArgMinMaxVector(benchmark::State& state, int (*arg_extreme)(const T*, int), bool largest) {
+  if (!ValidateArgExtreme<T>(state, "BM_ArgMinMaxVector/" + std::string(largest ? "argmax_" : "argmin_") + TypeKey<T>(), arg_extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = arg_extreme(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != ReferenceArgExtreme(vector, N, largest)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtremeInt<false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtremeInt<false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtremeInt<true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtremeInt<true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtremeFloat<false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtremeFloat<false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtremeFloat<true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtremeFloat<true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtremeDouble<false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtremeDouble<false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtremeDouble<true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtremeDouble<true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void ReverseVector(int* vector, int N) {
+  int reversePermutation[8] = {7, 6, 5, 4, 3, 2, 1, 0};
+
+  int pairs = N / 2 / 8;                  // Vector pairs that can be swapped without overlapping
+  int* lo = vector;
+  int* hi = vector + N - 8;
+  int count = pairs;
+
+  asm volatile (
+      "test %[count], %[count]\n\t"      // Nothing to swap for N < 16
+      "jz 2f\n\t"
+      "vmovdqu %[perm], %%ymm2\n\t"      // Load reversePermutation into YMM2
+      "1:\n\t"
+      "vmovdqu (%[lo]), %%ymm0\n\t"      // Load 8 integers from the front
+      "vmovdqu (%[hi]), %%ymm1\n\t"      // Load 8 integers from the back
+      "vpermd %%ymm0, %%ymm2, %%ymm0\n\t" // Reverse the front vector
+      "vpermd %%ymm1, %%ymm2, %%ymm1\n\t" // Reverse the back vector
+      "vmovdqu %%ymm1, (%[lo])\n\t"      // Store the reversed back vector at the front
+      "vmovdqu %%ymm0, (%[hi])\n\t"      // Store the reversed front vector at the back
+      "add $32, %[lo]\n\t"               // Advance the front pointer by 8 integers
+      "sub $32, %[hi]\n\t"               // Retreat the back pointer by 8 integers
+      "dec %[count]\n\t"                 // Decrement loop counter
+      "jnz 1b\n\t"                       // Jump to label 1 if count is not zero
+      "2:\n\t"
+      : [lo] "+r" (lo), [hi] "+r" (hi), [count] "+r" (count)
+      : [perm] "m" (reversePermutation)
+      : "memory", "cc", "xmm0", "xmm1", "xmm2"
+  );
+
+  // Reverse the middle that is left over when N is not a multiple of 16.
+  std::reverse(&vector[pairs * 8], &vector[N - pairs * 8]);
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
 void BM_ReverseVector(benchmark::State& state) {
+    if (!ValidateReverse<int>(state, "BM_ReverseVector", ReverseVector)) return;
     int N = state.range(1) - state.range(0);
-    int vector[N];
+    aligned_buffer<int> buffer(N);
+    int* vector = buffer.data();
     std::iota(vector, vector + N, state.range(0));
-    int reversePermutation[8] = {7, 6, 5, 4, 3, 2, 1, 0};
-
-    for (auto _ : state) {
-        asm volatile (
-            "mov %[N], %%ecx\n\t"               // Load N into ECX
-            "shr $3, %%ecx\n\t"                 // Divide by 8 to get number of iterations
-            "mov %[vec], %%rsi\n\t"             // Load address of vector into RSI
-            "1:\n\t"
-            "movdqu (%%rsi), %%xmm0\n\t"      // Load 8 integers into XMM0
-            "movdqu 32(%%rsi), %%xmm1\n\t" // Load next 8 integers in reverse order into XMM1
-            "movdqa %%xmm1, %%xmm2\n\t"         // Copy XMM1 to XMM2
-            "movdqa %[perm], %%xmm3\n\t"        // Load reversePermutation into XMM3
-            "pshufb %%xmm3, %%xmm0\n\t"         // Permute XMM0 according to reversePermutation
-            "pshufb %%xmm3, %%xmm2\n\t"         // Permute XMM2 according to reversePermutation
-            "movdqu %%xmm0, (%%rsi)\n\t"      // Store XMM0 back to original location
-            "movdqu %%xmm2, 32(%%rsi)\n\t" // Store XMM2 back to reverse location
-            "add $64, %%rsi\n\t"               // Increment vector pointer by 64 bytes (8 integers)
-            "dec %%ecx\n\t"                     // Decrement loop counter
-            "jnz 1b\n\t"                        // Jump to label 1 if ECX is not zero
-            :
-            : [N] "r" (N / 2), [vec] "r" (vector), [perm] "m" (reversePermutation)
-            : "%ecx", "%rsi", "memory", "xmm0", "xmm1", "xmm2", "xmm3"
-        );
+
+    for (auto _ : PerfLoop(state)) {
+        ReverseVector(vector, N);
 
         benchmark::ClobberMemory();
     }
+
+    SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
 }
-BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// One asm loop for every element width: vpshufb reverses the elements inside each 128-bit lane
+// with a per-width byte mask, then vpermq $0x4e swaps the two lanes. For 32- and 64-bit elements
+// a single vpermd/vpermq would do, so those widths pay one extra shuffle for the shared code.
+template <class T>
+void ReverseMask(uint8_t (&mask)[32]) {
+  constexpr int E = sizeof(T);
+  for (int j = 0; j < 32; ++j)
+    mask[j] = (16 / E - 1 - j % 16 / E) * E + j % E;
+}
+
+template <class T>
+void ReverseInPlace(T* vector, int N) {
+  constexpr int L = 32 / sizeof(T);
+  alignas(32) uint8_t mask[32];
+  ReverseMask<T>(mask);
+
+  int pairs = N / 2 / L;                 // Vector pairs that can be swapped without overlapping
+  T* lo = vector;
+  T* hi = vector + N - L;
+  int count = pairs;
+
+  asm volatile (
+    "test %[count], %[count]\n\t"       // Nothing to swap for N < 2 * L
+    "jz 2f\n\t"
+    "vmovdqa %[mask], %%ymm2\n\t"       // Load the in-lane shuffle mask into YMM2
+    "1:\n\t"
+    "vmovdqu (%[lo]), %%ymm0\n\t"       // Load 32 bytes from the front
+    "vmovdqu (%[hi]), %%ymm1\n\t"       // Load 32 bytes from the back
+    "vpshufb %%ymm2, %%ymm0, %%ymm0\n\t" // Reverse the elements inside each lane
+    "vpshufb %%ymm2, %%ymm1, %%ymm1\n\t"
+    "vpermq $0x4e, %%ymm0, %%ymm0\n\t"  // Swap the two lanes
+    "vpermq $0x4e, %%ymm1, %%ymm1\n\t"
+    "vmovdqu %%ymm1, (%[lo])\n\t"       // Store the reversed back vector at the front
+    "vmovdqu %%ymm0, (%[hi])\n\t"       // Store the reversed front vector at the back
+    "add $32, %[lo]\n\t"
+    "sub $32, %[hi]\n\t"
+    "dec %[count]\n\t"
+    "jnz 1b\n\t"
+    "2:\n\t"
+    : [lo] "+r" (lo), [hi] "+r" (hi), [count] "+r" (count)
+    : [mask] "m" (mask)
+    : "memory", "cc", "xmm0", "xmm1", "xmm2"
+  );
+
+  // Reverse the middle that is left over when N is not a multiple of 2 * L.
+  std::reverse(&vector[pairs * L], &vector[N - pairs * L]);
+}
+
+// result[i] = vector[N - 1 - i], walking the input backwards one vector at a time.
+template <class T>
+void ReverseCopy(const T* vector, T* result, int N) {
+  constexpr int L = 32 / sizeof(T);
+  alignas(32) uint8_t mask[32];
+  ReverseMask<T>(mask);
+
+  int blocks = N / L;
+  const T* in = vector + N - L;
+  T* out = result;
+  int count = blocks;
+
+  asm volatile (
+    "test %[count], %[count]\n\t"       // Nothing to copy for N < L
+    "jz 2f\n\t"
+    "vmovdqa %[mask], %%ymm2\n\t"
+    "1:\n\t"
+    "vmovdqu (%[in]), %%ymm0\n\t"       // Load 32 bytes, walking backwards
+    "vpshufb %%ymm2, %%ymm0, %%ymm0\n\t"
+    "vpermq $0x4e, %%ymm0, %%ymm0\n\t"
+    "vmovdqu %%ymm0, (%[out])\n\t"      // Store them reversed, walking forwards
+    "sub $32, %[in]\n\t"
+    "add $32, %[out]\n\t"
+    "dec %[count]\n\t"
+    "jnz 1b\n\t"
+    "2:\n\t"
+    : [in] "+r" (in), [out] "+r" (out), [count] "+r" (count)
+    : [mask] "m" (mask)
+    : "memory", "cc", "xmm0", "xmm2"
+  );
+
+  // The last N % L outputs come from the first N % L inputs.
+  std::reverse_copy(&vector[0], &vector[N - blocks * L], &result[blocks * L]);
+}
+
+// Reverse at every element width, in place and into a second buffer. N counts elements; compare
+// bytes_per_second across widths.
+template <class T>
+void BM_ReverseVectorWidth(benchmark::State& state, void (*reverse)(T*, int)) {
+  if (!ValidateReverse<T>(state, "BM_ReverseVectorWidth/" + TypeKey<T>(), reverse)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ReverseCopyVector(benchmark::State& state, void (*reverse_copy)(const T*, T*, int)) {
+  if (!ValidateReverseCopy<T>(state, "BM_ReverseCopyVector/" + TypeKey<T>(), reverse_copy)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+} // namespace
 
-BENCHMARK_MAIN();
+BACKEND_MAIN();
@@ -1,156 +1,1387 @@
-//TO COMPILE: g++ intrinsics.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -march=native -DNDEBUG -o intrinsics
+//TO COMPILE: g++ intrinsics.cpp kernels.cpp kernels-sse42.cpp kernels-avx2.cpp kernels-avx512.cpp kernels-parallel.cpp kernels-search.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -DNDEBUG -o intrinsics
+
+// The intrinsics kernels live in kernels.h so production code can call them. They are selected at
+// runtime for the host CPU, which is why this file is built without -march=native.
 
 #include <algorithm>
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
+#include <cstring>
 #include <numeric>
-#include <x86intrin.h>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "kernels.h"
+#include "kernels-parallel.h"
+#include "kernels-search.h"
+
+namespace {
+
+// Every benchmark runs the dispatched kernel under its plain name, plus the AVX2 and AVX-512
+// versions side by side as BM_<name>/avx2 and BM_<name>/avx512.
+const kernels::kernel_table* table_or_skip(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = kernels::table_for(level);
+  if (!table) state.SkipWithError("ISA level not supported by this CPU");
+  return table;
+}
+
+// The validation key of the kernel a benchmark takes from table, e.g. "BM_SumVector/avx2". Callers
+// append whatever else picks the kernel, such as the element type.
+std::string KernelKey(const char* benchmark, const kernels::kernel_table* table) {
+  return std::string(benchmark) + "/" + table->name;
+}
+
+const char* TailKey(kernels::tail strategy) {
+  return strategy == kernels::tail::scalar ? "/scalar" : strategy == kernels::tail::masked ? "/masked" : "/overlap";
+}
+
+const char* FpSumKey(kernels::fp_sum method) {
+  return method == kernels::fp_sum::plain ? "/plain" : method == kernels::fp_sum::pairwise ? "/pairwise" : "/compensated";
+}
+
+void BM_AddVectors(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto add = [add_f64 = table->add_f64](const double* a, const double* b, double* out) { add_f64(a, b, out, 4); };
+  if (!ValidateAddVectors(state, KernelKey("BM_AddVectors", table), add)) return;
 
-void BM_AddVectors(benchmark::State& state) {
   double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double result[4];
 
-  for (auto _ : state) {
-    __m256d a = _mm256_loadu_pd(&data_a[0]);
-    __m256d b = _mm256_loadu_pd(&data_b[0]);
+  for (auto _ : PerfLoop(state)) {
+    table->add_f64(data_a, data_b, result, 4);
 
-    __m256d r = _mm256_add_pd(a, b);
-    _mm256_storeu_pd(&result[0], r);
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_CAPTURE(BM_AddVectors, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_AddVectors"))->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_AddVectors, avx2, kernels::isa::avx2)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectors, avx512, kernels::isa::avx512)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(10);
+
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto add = [add_f64 = table->add_f64](const double* a, const double* b, double* out) { add_f64(a, b, out, 4); };
+  if (!ValidateAddVectors(state, KernelKey("BM_AddVectors", table), add)) return;
+
+  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double result[4];
+
+  TimeCycles(state, 4, [&] {
+    table->add_f64(data_a, data_b, result, 4);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
+  });
+}
+BENCHMARK_CAPTURE(BM_AddVectorsCycles, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_AddVectorsCycles"))->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsCycles, avx2, kernels::isa::avx2)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsCycles, avx512, kernels::isa::avx512)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+// Large arrays with cached stores against non-temporal ones (add_f64_stream), over StreamSweep.
+// Streaming wins once the output no longer fits in the last-level cache; kernels::add_f64 switches
+// at the stream_threshold_bytes reported in the context. bytes_per_second counts the two inputs
+// and the output, not the read-for-ownership traffic that cached stores add on top.
+void BM_AddVectorsLarge(benchmark::State& state, kernels::isa level, bool stream) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto add = stream ? table->add_f64_stream : table->add_f64;
+  if (!ValidateAdd(state, KernelKey("BM_AddVectorsLarge", table) + (stream ? "/streaming" : "/cached"), add)) return;
+
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<double> data_a(N), data_b(N), result(N);
+  FillColumn(data_a.data(), N);
+  FillColumn(data_b.data(), N);
+
+  for (auto _ : PerfLoop(state)) {
+    add(data_a.data(), data_b.data(), result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 3 * int64_t(N) * sizeof(double));
+}
+BENCHMARK_CAPTURE(BM_AddVectorsLarge, cached, kernels::active().level, false)->Apply(StreamSweep<double>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsLarge, streaming, kernels::active().level, true)->Apply(StreamSweep<double>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsLarge, avx2_cached, kernels::isa::avx2, false)->Apply(StreamSweep<double>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsLarge, avx2_streaming, kernels::isa::avx2, true)->Apply(StreamSweep<double>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsLarge, avx512_cached, kernels::isa::avx512, false)->Apply(StreamSweep<double>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddVectorsLarge, avx512_streaming, kernels::isa::avx512, true)->Apply(StreamSweep<double>)->MinTime(0.5)->Repetitions(10);
+
+// Element-wise kernels from L1-resident to DRAM-sized arrays (ElementwiseSweep), with bytes/s and
+// FLOP/s to set against the machine's peaks: add out = a + b, AXPY y = alpha * x + y, FMA
+// out = a * x + b and the triad out = b + q * c. The last three are one vfmadd per vector on the
+// AVX2 and AVX-512 levels.
+void BM_AddArrays(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateAdd(state, KernelKey("BM_AddArrays", table), table->add_f64)) return;
+
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    table->add_f64(v.a.data(), v.b.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 1);
+}
+BENCHMARK_CAPTURE(BM_AddArrays, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_AddArrays"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddArrays, avx2, kernels::isa::avx2)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_AddArrays, avx512, kernels::isa::avx512)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Axpy(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateAxpy(state, KernelKey("BM_Axpy", table), table->axpy_f64)) return;
+
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    table->axpy_f64(kElementwiseScale, v.a.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK_CAPTURE(BM_Axpy, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_Axpy"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Axpy, avx2, kernels::isa::avx2)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Axpy, avx512, kernels::isa::avx512)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_MultiplyAdd(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateMultiplyAdd(state, KernelKey("BM_MultiplyAdd", table), table->fma_f64)) return;
+
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    table->fma_f64(v.a.data(), v.b.data(), v.c.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
   }
+
+  SetElementwiseCounters(state, N, 4, 2);
 }
-BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_MultiplyAdd, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_MultiplyAdd"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MultiplyAdd, avx2, kernels::isa::avx2)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MultiplyAdd, avx512, kernels::isa::avx512)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Triad(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateTriad(state, KernelKey("BM_Triad", table), table->triad_f64)) return;
+
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    table->triad_f64(v.b.data(), v.c.data(), kElementwiseScale, v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK_CAPTURE(BM_Triad, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_Triad"))->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Triad, avx2, kernels::isa::avx2)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Triad, avx512, kernels::isa::avx512)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+// Particle records of 4 doubles (like BM_AddVectors' points) and of 8 floats, as array-of-structs
+// against struct-of-arrays, over RecordSweep. BM_Transpose is the cost of converting a whole array;
+// bytes_per_second counts the read and the write.
+void BM_Transpose(benchmark::State& state, kernels::isa level, char type, bool to_soa) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  if (type == 'd' && !ValidateTranspose<double, 4>(state, KernelKey("BM_Transpose", table) + (to_soa ? "/aos_to_soa_f64" : "/soa_to_aos_f64"), to_soa ? table->aos_to_soa_f64x4 : table->soa_to_aos_f64x4, to_soa)) return;
+  if (type == 'f' && !ValidateTranspose<float, 8>(state, KernelKey("BM_Transpose", table) + (to_soa ? "/aos_to_soa_f32" : "/soa_to_aos_f32"), to_soa ? table->aos_to_soa_f32x8 : table->soa_to_aos_f32x8, to_soa)) return;
+
+  int N = state.range(0);
+  aligned_buffer<double> from(4 * N), to(4 * N);
+  FillColumn(from.data(), 4 * N);
+
+  for (auto _ : PerfLoop(state)) {
+    if (type == 'd') (to_soa ? table->aos_to_soa_f64x4 : table->soa_to_aos_f64x4)(from.data(), to.data(), N);
+    else (to_soa ? table->aos_to_soa_f32x8 : table->soa_to_aos_f32x8)(reinterpret_cast<const float*>(from.data()), reinterpret_cast<float*>(to.data()), N);
+
+    benchmark::DoNotOptimize(to.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * 32);
+}
+BENCHMARK_CAPTURE(BM_Transpose, aos_to_soa_f64, kernels::active().level, 'd', true)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, soa_to_aos_f64, kernels::active().level, 'd', false)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, aos_to_soa_f32, kernels::active().level, 'f', true)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, soa_to_aos_f32, kernels::active().level, 'f', false)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, scalar_aos_to_soa_f64, kernels::isa::scalar, 'd', true)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, scalar_aos_to_soa_f32, kernels::isa::scalar, 'f', true)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, avx2_aos_to_soa_f64, kernels::isa::avx2, 'd', true)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_Transpose, avx2_aos_to_soa_f32, kernels::isa::avx2, 'f', true)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+
+// Which data BM_SquaredNorm starts from, and how it gets to the arithmetic.
+enum class Layout { aos, soa, aos_to_soa };
+
+// The same arithmetic, a squared length per 4-double record, on either layout. aos transposes every
+// block of records in registers on the way; aos_to_soa converts the whole array to SoA first on
+// every iteration, the price of keeping AoS storage but running SoA kernels. bytes_per_second counts
+// every array read or written, the conversion included.
+void BM_SquaredNorm(benchmark::State& state, kernels::isa level, Layout layout) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  if (layout == Layout::aos && !ValidateSquaredNorm(state, KernelKey("BM_SquaredNorm", table) + "/aos", table->squared_norm_aos_f64x4, false)) return;
+  if (layout != Layout::aos && (!ValidateTranspose<double, 4>(state, KernelKey("BM_Transpose", table) + "/aos_to_soa_f64", table->aos_to_soa_f64x4, true) || !ValidateSquaredNorm(state, KernelKey("BM_SquaredNorm", table) + "/soa", table->squared_norm_soa_f64x4, true))) return;
+
+  int N = state.range(0);
+  aligned_buffer<double> records(4 * N), soa(4 * N), result(N);
+  FillColumn(records.data(), 4 * N);
+  if (layout == Layout::soa) table->aos_to_soa_f64x4(records.data(), soa.data(), N);
+
+  for (auto _ : PerfLoop(state)) {
+    if (layout == Layout::aos) {
+      table->squared_norm_aos_f64x4(records.data(), result.data(), N);
+    } else {
+      if (layout == Layout::aos_to_soa) table->aos_to_soa_f64x4(records.data(), soa.data(), N);
+      table->squared_norm_soa_f64x4(soa.data(), result.data(), N);
+    }
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  int64_t bytes = int64_t(N) * (32 + 8);
+  if (layout == Layout::aos_to_soa) bytes += int64_t(N) * 2 * 32;
+  SetThroughput(state, N, bytes);
+}
+BENCHMARK_CAPTURE(BM_SquaredNorm, aos, kernels::active().level, Layout::aos)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SquaredNorm, soa, kernels::active().level, Layout::soa)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SquaredNorm, aos_to_soa, kernels::active().level, Layout::aos_to_soa)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SquaredNorm, avx2_aos, kernels::isa::avx2, Layout::aos)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SquaredNorm, avx2_soa, kernels::isa::avx2, Layout::soa)->Apply(RecordSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindInVector(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFind(state, KernelKey("BM_FindInVector", table), table->find_i32)) return;
 
-void BM_FindInVector(benchmark::State& state) {
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    __m256i x = _mm256_set1_epi32(target);
-
-    for (int i = 0; i < N; i += 8) {
-      __m256i y = _mm256_load_si256((__m256i*) &vector[i]);
-      __m256i m = _mm256_cmpeq_epi32(x, y);
-      int mask = _mm256_movemask_ps((__m256) m);
-      if(mask != 0) {
-        res = i + __builtin_ctz(mask);
-        break;
-      }
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = table->find_i32(vector, N, target);
     
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_FindInVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindInVector"))->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_FindInVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindInVector"))->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVector, avx2, kernels::isa::avx2)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVector, avx2, kernels::isa::avx2)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVector, avx512, kernels::isa::avx512)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVector, avx512, kernels::isa::avx512)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// Tail strategies compared on lengths that are not a multiple of any vector width. The target sits
+// in the last element so every iteration goes through the tail. Each strategy is validated first,
+// on every n up to 80 among others, so every tail length of both widths is checked.
+std::ptrdiff_t find_with_tail(kernels::isa level, const int32_t* data, std::size_t n, int32_t target, kernels::tail strategy) {
+  if (level == kernels::isa::avx512) return kernels::avx512::find_i32_tail(data, n, target, strategy);
+  return kernels::avx2::find_i32_tail(data, n, target, strategy);
+}
+
+int32_t sum_with_tail(kernels::isa level, const int32_t* data, std::size_t n, kernels::tail strategy) {
+  if (level == kernels::isa::avx512) return kernels::avx512::sum_i32_tail(data, n, strategy);
+  return kernels::avx2::sum_i32_tail(data, n, strategy);
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
-void BM_FindInVectorFaster(benchmark::State& state) {
+void BM_FindInVectorTail(benchmark::State& state, kernels::isa level, kernels::tail strategy) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto find = [level, strategy](const int32_t* data, std::size_t n, int32_t target) { return find_with_tail(level, data, n, target, strategy); };
+  if (!ValidateFind(state, KernelKey("BM_FindInVectorTail", table) + TailKey(strategy), find)) return;
+
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    __m256i x = _mm256_set1_epi32(target);
-    for (int i = 0; i < N; i += 32) {
-      __m256i y1 = _mm256_load_si256((__m256i*) &vector[i]);
-      __m256i m1 = _mm256_cmpeq_epi32(x, y1);
-      __m256i y2 = _mm256_load_si256((__m256i*) &vector[i + 8]);
-      __m256i m2 = _mm256_cmpeq_epi32(x, y2);
-      __m256i y3 = _mm256_load_si256((__m256i*) &vector[i + 16]);
-      __m256i m3 = _mm256_cmpeq_epi32(x, y3);
-      __m256i y4 = _mm256_load_si256((__m256i*) &vector[i + 24]);
-      __m256i m4 = _mm256_cmpeq_epi32(x, y4);
-      __m256i m12 = _mm256_or_si256(m1, m2);
-      __m256i m34 = _mm256_or_si256(m3, m4);
-      __m256i m = _mm256_or_si256(m12, m34);
-      if(!_mm256_testz_si256(m, m)) {
-        int mask1 = _mm256_movemask_ps((__m256) m1);
-        if (mask1) {
-          res = i + __builtin_ctz(mask1);
-          break;
-        }
-        int mask2 = _mm256_movemask_ps((__m256) m2);
-        if (mask2) {
-          res = i + 8 + __builtin_ctz(mask2);
-          break;
-        }
-        int mask3 = _mm256_movemask_ps((__m256) m3);
-        if (mask3) {
-          res = i + 16 + __builtin_ctz(mask3);
-          break;
-        }
-        int mask4 = _mm256_movemask_ps((__m256) m3);
-        if (mask4) {
-          res = i + 24 + __builtin_ctz(mask4);
-          break;
-        }
-      }
+  for (auto _ : PerfLoop(state)) {
+    res = find(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, ScannedElements(state.range(2), N), ScannedElements(state.range(2), N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_FindInVectorTail, avx2_scalar, kernels::isa::avx2, kernels::tail::scalar)->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorTail, avx2_masked, kernels::isa::avx2, kernels::tail::masked)->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorTail, avx2_overlap, kernels::isa::avx2, kernels::tail::overlap)->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorTail, avx512_scalar, kernels::isa::avx512, kernels::tail::scalar)->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorTail, avx512_masked, kernels::isa::avx512, kernels::tail::masked)->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorTail, avx512_overlap, kernels::isa::avx512, kernels::tail::overlap)->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+
+void BM_FindInVectorFaster(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFind(state, KernelKey("BM_FindInVectorFaster", table), table->find_i32_unrolled)) return;
+
+  int target = state.range(0);
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::fill(vector, vector + N, 0);
+  if (state.range(2) >= 0) vector[state.range(2)] = target;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->find_i32_unrolled(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, ScannedElements(state.range(2), N), ScannedElements(state.range(2), N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindInVectorFaster"))->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindInVectorFaster"))->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindInVectorFaster"))->Apply(MatchPositionArgs)->UseRealTime()->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx2, kernels::isa::avx2)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx2, kernels::isa::avx2)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx512, kernels::isa::avx512)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorFaster, avx512, kernels::isa::avx512)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// The early-exit find on the FindScenario inputs, which move the target on every call so the exit
+// cannot be learned (see FindScenarioInput in bench-utils.h). Without an ISA prefix it is the
+// dispatched kernel.
+void BM_FindInVectorScenario(benchmark::State& state, kernels::isa level, FindScenario scenario) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFind(state, KernelKey("BM_FindInVectorFaster", table), table->find_i32_unrolled)) return;
+
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = table->find_i32_unrolled(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_position, kernels::active().level, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, absent, kernels::active().level, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, near_start, kernels::active().level, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, duplicates, kernels::active().level, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_data, kernels::active().level, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_random_position, kernels::isa::avx2, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_absent, kernels::isa::avx2, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_near_start, kernels::isa::avx2, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_duplicates, kernels::isa::avx2, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx2_random_data, kernels::isa::avx2, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_random_position, kernels::isa::avx512, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_absent, kernels::isa::avx512, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_near_start, kernels::isa::avx512, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_duplicates, kernels::isa::avx512, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, avx512_random_data, kernels::isa::avx512, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// Every matching index as a selection vector, across selectivities. The kernels are branch-free
+// (BM_FindAllInVector/scalar included), so there is no misprediction peak around 50% as in the
+// branchy loop in no-vec.cpp; what remains is the output size and, once matches are frequent,
+// full-width stores at unaligned offsets.
+void BM_FindAllInVector(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFindAll(state, KernelKey("BM_FindAllInVector", table), table->find_all_i32)) return;
+
+  int target = state.range(0);
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  aligned_buffer<uint32_t> result(N);
+  int* vector = buffer.data();
+  int64_t matches = FillSelectivity(vector, N, target, state.range(2));
+  std::size_t count = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    count = table->find_all_i32(vector, N, target, result.data());
+
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  if (int64_t(count) != matches) state.SkipWithError("find_all_i32 returned the wrong number of matches");
+  SetSelectivityCounters(state, N, matches);
+}
+BENCHMARK_CAPTURE(BM_FindAllInVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindAllInVector"))->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAllInVector, scalar, kernels::isa::scalar)->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAllInVector, avx2, kernels::isa::avx2)->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAllInVector, avx512, kernels::isa::avx512)->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+
+// Index of the first element that is any of K keys, against the two obvious alternatives below.
+void BM_FindAnyInVector(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto find_any = [kernel = table->find_any_i32](const int32_t* data, std::size_t n, const int32_t* keys, std::size_t k) {
+    return kernel(data, n, kernels::make_key_set(keys, k));
+  };
+  if (!ValidateFindAny(state, KernelKey("BM_FindAnyInVector", table), find_any)) return;
+
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::vector<int> keys = FillMembership(vector, N, state.range(0), state.range(2));
+  kernels::key_set set = kernels::make_key_set(keys.data(), keys.size());
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->find_any_i32(vector, N, set);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(2)) state.SkipWithError("find_any_i32 returned the wrong index");
+  SetThroughput(state, ScannedElements(state.range(2), N), ScannedElements(state.range(2), N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_FindAnyInVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindAnyInVector"))->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAnyInVector, scalar, kernels::isa::scalar)->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAnyInVector, sse42, kernels::isa::sse42)->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAnyInVector, avx2, kernels::isa::avx2)->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAnyInVector, avx512, kernels::isa::avx512)->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+
+// One find_i32_unrolled pass per key, each limited to the part before the best match so far.
+std::ptrdiff_t FindAnyPasses(const kernels::kernel_table* table, const int32_t* data, std::size_t n, const int32_t* keys, std::size_t k) {
+  std::ptrdiff_t res = -1;
+  for (std::size_t j = 0; j < k; ++j) {
+    std::ptrdiff_t found = table->find_i32_unrolled(data, res < 0 ? n : res, keys[j]);
+    if (found >= 0) res = found;
+  }
+  return res;
+}
+
+void BM_FindAnyInVectorPasses(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto find_any = [table](const int32_t* data, std::size_t n, const int32_t* keys, std::size_t k) { return FindAnyPasses(table, data, n, keys, k); };
+  if (!ValidateFindAny(state, KernelKey("BM_FindAnyInVectorPasses", table), find_any)) return;
+
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::vector<int> keys = FillMembership(vector, N, state.range(0), state.range(2));
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindAnyPasses(table, vector, N, keys.data(), keys.size());
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(2)) state.SkipWithError("find_i32_unrolled passes returned the wrong index");
+  SetThroughput(state, ScannedElements(state.range(2), N), ScannedElements(state.range(2), N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_FindAnyInVectorPasses, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindAnyInVectorPasses"))->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+
+std::ptrdiff_t FindAnyUnorderedSet(const std::unordered_set<int>& set, const int* data, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (set.count(data[i])) return i;
+  }
+  return -1;
+}
+
+void BM_FindAnyInVectorUnorderedSet(benchmark::State& state) {
+  auto find_any = [](const int* data, std::size_t n, const int* keys, std::size_t k) { return FindAnyUnorderedSet(std::unordered_set<int>(keys, keys + k), data, n); };
+  if (!ValidateFindAny(state, "BM_FindAnyInVectorUnorderedSet", find_any)) return;
+
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::vector<int> keys = FillMembership(vector, N, state.range(0), state.range(2));
+  std::unordered_set<int> set(keys.begin(), keys.end());
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindAnyUnorderedSet(set, vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(2)) state.SkipWithError("std::unordered_set loop returned the wrong index");
+  SetThroughput(state, ScannedElements(state.range(2), N), ScannedElements(state.range(2), N) * sizeof(int));
+}
+BENCHMARK(BM_FindAnyInVectorUnorderedSet)->Apply(MembershipArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindByte(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFindByte(state, KernelKey("BM_FindByte", table), table->find_u8)) return;
+
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->find_u8(text, N, kDelimiter);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(1)) state.SkipWithError("find_u8 returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK_CAPTURE(BM_FindByte, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindByte"))->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindByte, sse42, kernels::isa::sse42)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindByte, avx2, kernels::isa::avx2)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindByte, avx512, kernels::isa::avx512)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+// glibc's own SIMD memchr, the baseline find_u8 has to match.
+void BM_FindByteMemchr(benchmark::State& state) {
+  auto find = [](const uint8_t* data, std::size_t n, uint8_t target) -> std::ptrdiff_t {
+    const void* hit = std::memchr(data, target, n);
+    return hit ? static_cast<const uint8_t*>(hit) - data : -1;
+  };
+  if (!ValidateFindByte(state, "BM_FindByteMemchr", find)) return;
+
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = find(text, N, kDelimiter);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(1)) state.SkipWithError("memchr returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindByteMemchr)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+// kNeedle ending at the last byte, so the filter has to reject every earlier candidate.
+void BM_FindSubstring(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFindSubstring(state, KernelKey("BM_FindSubstring", table), table->find_substr_u8)) return;
+
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int64_t start = PlaceNeedle(text, state.range(1));
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->find_substr_u8(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("find_substr_u8 returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK_CAPTURE(BM_FindSubstring, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_FindSubstring"))->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindSubstring, scalar, kernels::isa::scalar)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindSubstring, sse42, kernels::isa::sse42)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindSubstring, avx2, kernels::isa::avx2)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindSubstring, avx512, kernels::isa::avx512)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstringMemmem(benchmark::State& state) {
+  auto find = [](const uint8_t* text, std::size_t n, const uint8_t* needle, std::size_t m) -> std::ptrdiff_t {
+    if (n < m) return -1;
+    const void* hit = memmem(text, n, needle, m);
+    return hit ? static_cast<const uint8_t*>(hit) - text : -1;
+  };
+  if (!ValidateFindSubstring(state, "BM_FindSubstringMemmem", find)) return;
+
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int64_t start = PlaceNeedle(text, state.range(1));
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = find(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("memmem returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstringMemmem)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstringStringView(benchmark::State& state) {
+  auto find = [](const uint8_t* text, std::size_t n, const uint8_t* needle, std::size_t m) -> std::ptrdiff_t {
+    std::size_t hit = std::string_view(reinterpret_cast<const char*>(text), n).find(std::string_view(reinterpret_cast<const char*>(needle), m));
+    return hit == std::string_view::npos ? -1 : static_cast<std::ptrdiff_t>(hit);
+  };
+  if (!ValidateFindSubstring(state, "BM_FindSubstringStringView", find)) return;
+
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int64_t start = PlaceNeedle(text, state.range(1));
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = find(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("std::string_view::find returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstringStringView)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+// kSearchQueries lookups of keys that are all present. lookup returns the key it found, and the
+// sum of those has to match the sum of the queries.
+template <class Lookup>
+void SortedSearch(benchmark::State& state, const std::vector<int>& queries, Lookup lookup) {
+  int64_t found = 0;
+  for (auto _ : PerfLoop(state)) {
+    found = 0;
+    for (int q : queries)
+      found += lookup(q);
+
+    benchmark::DoNotOptimize(found);
+    benchmark::ClobberMemory();
+  }
+
+  if (found != std::accumulate(queries.begin(), queries.end(), int64_t(0))) state.SkipWithError("search returned the wrong keys");
+  state.SetItemsProcessed(state.iterations() * kSearchQueries);
+}
+
+void BM_SortedSearchStd(benchmark::State& state) {
+  int N = state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* data = buffer.data();
+  std::vector<int> queries = FillSortedSearch(data, N);
+  SortedSearch(state, queries, [&](int q) { return *std::lower_bound(data, data + N, q); });
+}
+BENCHMARK(BM_SortedSearchStd)->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_SortedSearchBranchless(benchmark::State& state) {
+  auto search = [](const int* sorted, std::size_t n, const int* queries, std::size_t q, int* found) {
+    for (std::size_t j = 0; j < q; ++j) {
+      std::size_t i = kernels::lower_bound_branchless(sorted, n, queries[j]);
+      found[j] = i == n ? INT32_MAX : sorted[i];
     }
+  };
+  if (!ValidateLowerBound(state, "BM_SortedSearchBranchless", search)) return;
+
+  int N = state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* data = buffer.data();
+  std::vector<int> queries = FillSortedSearch(data, N);
+  SortedSearch(state, queries, [&](int q) { return data[kernels::lower_bound_branchless(data, N, q)]; });
+}
+BENCHMARK(BM_SortedSearchBranchless)->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_SortedSearchEytzinger(benchmark::State& state) {
+  auto search = [](const int* sorted, std::size_t n, const int* queries, std::size_t q, int* found) {
+    aligned_buffer<int> tree(kernels::eytzinger_size(n));
+    kernels::to_eytzinger(sorted, n, tree.data());
+    for (std::size_t j = 0; j < q; ++j) {
+      std::size_t k = kernels::eytzinger_lower_bound(tree.data(), n, queries[j]);
+      found[j] = k == 0 ? INT32_MAX : tree[k];
+    }
+  };
+  if (!ValidateLowerBound(state, "BM_SortedSearchEytzinger", search)) return;
+
+  int N = state.range(0);
+  aligned_buffer<int> buffer(N);
+  aligned_buffer<int> tree(kernels::eytzinger_size(N));
+  std::vector<int> queries = FillSortedSearch(buffer.data(), N);
+  kernels::to_eytzinger(buffer.data(), N, tree.data());
+  SortedSearch(state, queries, [&](int q) { return tree[kernels::eytzinger_lower_bound(tree.data(), N, q)]; });
+}
+BENCHMARK(BM_SortedSearchEytzinger)->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+// The k-ary search: 16 separators per node, compared with one to four vector instructions.
+void BM_SortedSearchBTree(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto search = [lower_bound = table->btree_lower_bound_i32](const int* sorted, std::size_t n, const int* queries, std::size_t q, int* found) {
+    aligned_buffer<int> tree(kernels::btree_size(n));
+    kernels::to_btree(sorted, n, tree.data());
+    for (std::size_t j = 0; j < q; ++j) {
+      std::size_t i = lower_bound(tree.data(), tree.size(), queries[j]);
+      found[j] = i == tree.size() ? INT32_MAX : tree[i];
+    }
+  };
+  if (!ValidateLowerBound(state, KernelKey("BM_SortedSearchBTree", table), search)) return;
+
+  int N = state.range(0);
+  aligned_buffer<int> buffer(N);
+  aligned_buffer<int> tree(kernels::btree_size(N));
+  std::vector<int> queries = FillSortedSearch(buffer.data(), N);
+  kernels::to_btree(buffer.data(), N, tree.data());
+  SortedSearch(state, queries, [&](int q) { return tree[table->btree_lower_bound_i32(tree.data(), tree.size(), q)]; });
+}
+BENCHMARK_CAPTURE(BM_SortedSearchBTree, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SortedSearchBTree"))->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SortedSearchBTree, scalar, kernels::isa::scalar)->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SortedSearchBTree, avx2, kernels::isa::avx2)->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SortedSearchBTree, avx512, kernels::isa::avx512)->Apply(SortedSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+// The BM_FindInVectorFaster kernel on the same lookups: where this line crosses the tree searches
+// is the array size from which sorting the data pays off.
+void BM_SortedSearchLinear(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateFind(state, KernelKey("BM_FindInVectorFaster", table), table->find_i32_unrolled)) return;
+
+  int N = state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* data = buffer.data();
+  std::vector<int> queries = FillSortedSearch(data, N);
+  SortedSearch(state, queries, [&](int q) { return data[table->find_i32_unrolled(data, N, q)]; });
+}
+BENCHMARK_CAPTURE(BM_SortedSearchLinear, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SortedSearchLinear"))->Apply(LinearSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SortedSearchLinear, avx2, kernels::isa::avx2)->Apply(LinearSearchArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SortedSearchLinear, avx512, kernels::isa::avx512)->Apply(LinearSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_SumVector(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateSum(state, KernelKey("BM_SumVector", table), table->sum_i32)) return;
+
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->sum_i32(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
 }
-BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_SumVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SumVector"))->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_SumVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SumVector"))->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVector, avx2, kernels::isa::avx2)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVector, avx2, kernels::isa::avx2)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVector, avx512, kernels::isa::avx512)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVector, avx512, kernels::isa::avx512)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+void BM_SumVectorWide(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateSumWide(state, KernelKey("BM_SumVectorWide", table), table->sum_i32_i64)) return;
 
-void BM_SumVector(benchmark::State& state) {
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->sum_i32_i64(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_SumVectorWide, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SumVectorWide"))->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_SumVectorWide, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SumVectorWide"))->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx2, kernels::isa::avx2)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx2, kernels::isa::avx2)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx512, kernels::isa::avx512)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorWide, avx512, kernels::isa::avx512)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_SumVectorTail(benchmark::State& state, kernels::isa level, kernels::tail strategy) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  auto sum = [level, strategy](const int32_t* data, std::size_t n) { return sum_with_tail(level, data, n, strategy); };
+  if (!ValidateSum(state, KernelKey("BM_SumVectorTail", table) + TailKey(strategy), sum)) return;
+
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
   int res;
 
-  for (auto _ : state) {
-    res = 0;
-    __m256i s1 = _mm256_setzero_si256();
-    __m256i s2 = _mm256_setzero_si256();
-    
-    for (int i = 0; i < N; i += 16) {
-      s1 = _mm256_add_epi32(s1, _mm256_load_si256((__m256i*) &vector[i]));
-      s2 = _mm256_add_epi32(s2, _mm256_load_si256((__m256i*) &vector[i + 8]));
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = sum(vector, N);
 
-    __m256i s = _mm256_add_epi32(s1, s2);
-    int t[8];
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
 
-    _mm256_storeu_si256((__m256i*) t, s);
-    
-    for (int i = 0; i < 8; ++i) 
-      res += t[i];
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_SumVectorTail, avx2_scalar, kernels::isa::avx2, kernels::tail::scalar)->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorTail, avx2_masked, kernels::isa::avx2, kernels::tail::masked)->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorTail, avx2_overlap, kernels::isa::avx2, kernels::tail::overlap)->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorTail, avx512_scalar, kernels::isa::avx512, kernels::tail::scalar)->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorTail, avx512_masked, kernels::isa::avx512, kernels::tail::masked)->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorTail, avx512_overlap, kernels::isa::avx512, kernels::tail::overlap)->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+// Floating-point sums of a [0, 1) column: plain vector accumulation, pairwise, and Neumaier-
+// compensated. BM_<name>/<method> runs the dispatched level, avx2_ and avx512_ prefixes the others.
+// Each run also reports its relative error against a long double reference.
+template <class T>
+void SumFloatingPoint(benchmark::State& state, const std::string& key, T (*sum)(const T*, std::size_t, kernels::fp_sum), kernels::fp_sum method) {
+  auto kernel = [sum, method](const T* data, std::size_t n) { return sum(data, n, method); };
+  if (!ValidateSumFloat<T>(state, key, kernel)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillColumn(vector, N);
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = kernel(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+  SetRelativeError(state, res, ReferenceSum(vector, N));
+}
+
+void BM_SumVectorFloat(benchmark::State& state, kernels::isa level, kernels::fp_sum method) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  SumFloatingPoint(state, KernelKey("BM_SumVectorFloat", table) + FpSumKey(method), table->sum_f32, method);
+}
+BENCHMARK_CAPTURE(BM_SumVectorFloat, plain, kernels::active().level, kernels::fp_sum::plain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, plain, kernels::active().level, kernels::fp_sum::plain)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, pairwise, kernels::active().level, kernels::fp_sum::pairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, pairwise, kernels::active().level, kernels::fp_sum::pairwise)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, compensated, kernels::active().level, kernels::fp_sum::compensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, compensated, kernels::active().level, kernels::fp_sum::compensated)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx2_plain, kernels::isa::avx2, kernels::fp_sum::plain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx2_pairwise, kernels::isa::avx2, kernels::fp_sum::pairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx2_compensated, kernels::isa::avx2, kernels::fp_sum::compensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx512_plain, kernels::isa::avx512, kernels::fp_sum::plain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx512_pairwise, kernels::isa::avx512, kernels::fp_sum::pairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, avx512_compensated, kernels::isa::avx512, kernels::fp_sum::compensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+void BM_SumVectorDouble(benchmark::State& state, kernels::isa level, kernels::fp_sum method) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  SumFloatingPoint(state, KernelKey("BM_SumVectorDouble", table) + FpSumKey(method), table->sum_f64, method);
+}
+BENCHMARK_CAPTURE(BM_SumVectorDouble, plain, kernels::active().level, kernels::fp_sum::plain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, plain, kernels::active().level, kernels::fp_sum::plain)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, pairwise, kernels::active().level, kernels::fp_sum::pairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, pairwise, kernels::active().level, kernels::fp_sum::pairwise)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, compensated, kernels::active().level, kernels::fp_sum::compensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, compensated, kernels::active().level, kernels::fp_sum::compensated)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx2_plain, kernels::isa::avx2, kernels::fp_sum::plain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx2_pairwise, kernels::isa::avx2, kernels::fp_sum::pairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx2_compensated, kernels::isa::avx2, kernels::fp_sum::compensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx512_plain, kernels::isa::avx512, kernels::fp_sum::plain)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx512_pairwise, kernels::isa::avx512, kernels::fp_sum::pairwise)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, avx512_compensated, kernels::isa::avx512, kernels::fp_sum::compensated)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+// Min/max of a random column (FillRandomRange), and the index of its first smallest or largest
+// element. BM_<name>/<min|max>_<type> runs the dispatched level, avx2_ and avx512_ prefixes the
+// others; type is 'i', 'f' or 'd' for int32, float and double. Every run checks its result against
+// std::min_element / std::max_element.
+template <class T>
+void MinMaxOf(benchmark::State& state, const std::string& key, T (*extreme)(const T*, std::size_t, kernels::extremum), kernels::extremum which) {
+  auto kernel = [extreme, which](const T* data, std::size_t n) { return extreme(data, n, which); };
+  if (!ValidateExtreme<T>(state, key, kernel, which == kernels::extremum::max)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = kernel(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != vector[ReferenceArgExtreme(vector, N, which == kernels::extremum::max)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+
+template <class T>
+void ArgMinMaxOf(benchmark::State& state, const std::string& key, std::ptrdiff_t (*arg_extreme)(const T*, std::size_t, kernels::extremum), kernels::extremum which) {
+  auto kernel = [arg_extreme, which](const T* data, std::size_t n) { return arg_extreme(data, n, which); };
+  if (!ValidateArgExtreme<T>(state, key, kernel, which == kernels::extremum::max)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  std::ptrdiff_t res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = kernel(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != ReferenceArgExtreme(vector, N, which == kernels::extremum::max)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+
+void BM_MinMaxVector(benchmark::State& state, kernels::isa level, int type, kernels::extremum which) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  std::string key = KernelKey("BM_MinMaxVector", table) + (which == kernels::extremum::max ? "/max_" : "/min_");
+  switch (type) {
+    case 'i': return MinMaxOf(state, key + "i32", table->extreme_i32, which);
+    case 'f': return MinMaxOf(state, key + "f32", table->extreme_f32, which);
+    default: return MinMaxOf(state, key + "f64", table->extreme_f64, which);
+  }
+}
+
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, kernels::active().level, 'i', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, kernels::active().level, 'i', kernels::extremum::min)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, kernels::active().level, 'i', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, kernels::active().level, 'i', kernels::extremum::max)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, kernels::active().level, 'f', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, kernels::active().level, 'f', kernels::extremum::min)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, kernels::active().level, 'f', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, kernels::active().level, 'f', kernels::extremum::max)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, kernels::active().level, 'd', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, kernels::active().level, 'd', kernels::extremum::min)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, kernels::active().level, 'd', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, kernels::active().level, 'd', kernels::extremum::max)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx2_min_i32, kernels::isa::avx2, 'i', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx2_max_i32, kernels::isa::avx2, 'i', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx2_min_f32, kernels::isa::avx2, 'f', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx2_max_f32, kernels::isa::avx2, 'f', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx2_min_f64, kernels::isa::avx2, 'd', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx2_max_f64, kernels::isa::avx2, 'd', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_min_i32, kernels::isa::avx512, 'i', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_max_i32, kernels::isa::avx512, 'i', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_min_f32, kernels::isa::avx512, 'f', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_max_f32, kernels::isa::avx512, 'f', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_min_f64, kernels::isa::avx512, 'd', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, avx512_max_f64, kernels::isa::avx512, 'd', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+void BM_ArgMinMaxVector(benchmark::State& state, kernels::isa level, int type, kernels::extremum which) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  std::string key = KernelKey("BM_ArgMinMaxVector", table) + (which == kernels::extremum::max ? "/argmax_" : "/argmin_");
+  switch (type) {
+    case 'i': return ArgMinMaxOf(state, key + "i32", table->arg_extreme_i32, which);
+    case 'f': return ArgMinMaxOf(state, key + "f32", table->arg_extreme_f32, which);
+    default: return ArgMinMaxOf(state, key + "f64", table->arg_extreme_f64, which);
+  }
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, kernels::active().level, 'i', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, kernels::active().level, 'i', kernels::extremum::min)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, kernels::active().level, 'i', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, kernels::active().level, 'i', kernels::extremum::max)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, kernels::active().level, 'f', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, kernels::active().level, 'f', kernels::extremum::min)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, kernels::active().level, 'f', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, kernels::active().level, 'f', kernels::extremum::max)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, kernels::active().level, 'd', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, kernels::active().level, 'd', kernels::extremum::min)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, kernels::active().level, 'd', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, kernels::active().level, 'd', kernels::extremum::max)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx2_argmin_i32, kernels::isa::avx2, 'i', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx2_argmax_i32, kernels::isa::avx2, 'i', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx2_argmin_f32, kernels::isa::avx2, 'f', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx2_argmax_f32, kernels::isa::avx2, 'f', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx2_argmin_f64, kernels::isa::avx2, 'd', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx2_argmax_f64, kernels::isa::avx2, 'd', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmin_i32, kernels::isa::avx512, 'i', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmax_i32, kernels::isa::avx512, 'i', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmin_f32, kernels::isa::avx512, 'f', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmax_f32, kernels::isa::avx512, 'f', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmin_f64, kernels::isa::avx512, 'd', kernels::extremum::min)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, avx512_argmax_f64, kernels::isa::avx512, 'd', kernels::extremum::max)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+// Prefix sums from one array into another: row lengths (FillLengths) for int32, a [0, 1) column for
+// float. BM_ScanVector/<inclusive|exclusive>_<type> runs the dispatched level, avx2_ and avx512_
+// prefixes the others, and BM_ScanVectorStd is std::inclusive_scan / std::exclusive_scan on the same
+// data; type is 'i' or 'f'. int32 results are checked exactly, float runs report rel_error.
+template <class T, class Scan>
+void PrefixSum(benchmark::State& state, const std::string& key, kernels::prefix kind, Scan scan) {
+  if (!ValidateScan<T>(state, key, scan, kind == kernels::prefix::inclusive)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> in_buffer(N);
+  aligned_buffer<T> out_buffer(N);
+  T* in = in_buffer.data();
+  T* out = out_buffer.data();
+  if constexpr (std::is_integral_v<T>) FillLengths(in, N);
+  else FillColumn(in, N);
+
+  for (auto _ : PerfLoop(state)) {
+    scan(in, out, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  CheckPrefixSum(state, in, out, N, kind == kernels::prefix::inclusive);
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+
+void BM_ScanVector(benchmark::State& state, kernels::isa level, int type, kernels::prefix kind) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  std::string key = KernelKey("BM_ScanVector", table) + (kind == kernels::prefix::inclusive ? "/inclusive_" : "/exclusive_");
+  if (type == 'i') {
+    PrefixSum<int32_t>(state, key + "i32", kind, [scan = table->scan_i32, kind](const int32_t* in, int32_t* out, std::size_t n) { scan(in, out, n, 0, kind); });
+  } else {
+    PrefixSum<float>(state, key + "f32", kind, [scan = table->scan_f32, kind](const float* in, float* out, std::size_t n) { scan(in, out, n, 0, kind); });
+  }
+}
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_i32, kernels::active().level, 'i', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_i32, kernels::active().level, 'i', kernels::prefix::inclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_i32, kernels::active().level, 'i', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_i32, kernels::active().level, 'i', kernels::prefix::exclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_f32, kernels::active().level, 'f', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_f32, kernels::active().level, 'f', kernels::prefix::inclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_f32, kernels::active().level, 'f', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_f32, kernels::active().level, 'f', kernels::prefix::exclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx2_inclusive_i32, kernels::isa::avx2, 'i', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx2_exclusive_i32, kernels::isa::avx2, 'i', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx2_inclusive_f32, kernels::isa::avx2, 'f', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx2_exclusive_f32, kernels::isa::avx2, 'f', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_inclusive_i32, kernels::isa::avx512, 'i', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_exclusive_i32, kernels::isa::avx512, 'i', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_inclusive_f32, kernels::isa::avx512, 'f', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, avx512_exclusive_f32, kernels::isa::avx512, 'f', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+
+// The sequential baseline: each output depends on the previous one, which neither GCC's
+// vectoriser nor #pragma omp simd breaks.
+template <class T>
+void PrefixSumStd(benchmark::State& state, kernels::prefix kind) {
+  std::string key = (kind == kernels::prefix::inclusive ? "BM_ScanVectorStd/inclusive_" : "BM_ScanVectorStd/exclusive_") + TypeKey<T>();
+  if (kind == kernels::prefix::inclusive) {
+    PrefixSum<T>(state, key, kind, [](const T* in, T* out, std::size_t n) { std::inclusive_scan(in, in + n, out); });
+  } else {
+    PrefixSum<T>(state, key, kind, [](const T* in, T* out, std::size_t n) { std::exclusive_scan(in, in + n, out, T(0)); });
+  }
+}
+
+void BM_ScanVectorStd(benchmark::State& state, int type, kernels::prefix kind) {
+  if (type == 'i') PrefixSumStd<int32_t>(state, kind);
+  else PrefixSumStd<float>(state, kind);
+}
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_i32, 'i', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_i32, 'i', kernels::prefix::inclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_i32, 'i', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_i32, 'i', kernels::prefix::exclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_f32, 'f', kernels::prefix::inclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_f32, 'f', kernels::prefix::inclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_f32, 'f', kernels::prefix::exclusive)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_f32, 'f', kernels::prefix::exclusive)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_ReverseVector(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateReverse<int32_t>(state, KernelKey("BM_ReverseVector", table), table->reverse_i32)) return;
+
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+
+  for (auto _ : PerfLoop(state)) {
+    table->reverse_i32(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_ReverseVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_ReverseVector"))->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_ReverseVector, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_ReverseVector"))->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx2, kernels::isa::avx2)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx2, kernels::isa::avx2)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx512, kernels::isa::avx512)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVector, avx512, kernels::isa::avx512)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Reverse at every element width, in place and into a second buffer. N counts elements, so the
+// bytes per item differ between widths; compare the bytes_per_second counters across widths.
+// BM_<name>/<width> runs the dispatched level, avx2_ and avx512_ prefixes the others.
+template <class T>
+void ReverseWidth(benchmark::State& state, const std::string& key, void (*reverse)(T*, std::size_t)) {
+  if (!ValidateReverse<T>(state, key, reverse)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+
+template <class T>
+void ReverseCopyWidth(benchmark::State& state, const std::string& key, void (*reverse_copy)(const T*, T*, std::size_t)) {
+  if (!ValidateReverseCopy<T>(state, key, reverse_copy)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+
+void BM_ReverseVectorWidth(benchmark::State& state, kernels::isa level, int bits) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  std::string key = KernelKey("BM_ReverseVectorWidth", table);
+  switch (bits) {
+    case 8: return ReverseWidth(state, key + "/u8", table->reverse_u8);
+    case 16: return ReverseWidth(state, key + "/u16", table->reverse_u16);
+    case 32: return ReverseWidth(state, key + "/i32", table->reverse_i32);
+    default: return ReverseWidth(state, key + "/u64", table->reverse_u64);
+  }
+}
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, kernels::active().level, 8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, kernels::active().level, 8)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, kernels::active().level, 16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, kernels::active().level, 16)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, kernels::active().level, 32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, kernels::active().level, 32)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, kernels::active().level, 64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, kernels::active().level, 64)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx2_u8, kernels::isa::avx2, 8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx2_u16, kernels::isa::avx2, 16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx2_u32, kernels::isa::avx2, 32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx2_u64, kernels::isa::avx2, 64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u8, kernels::isa::avx512, 8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u16, kernels::isa::avx512, 16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u32, kernels::isa::avx512, 32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, avx512_u64, kernels::isa::avx512, 64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+void BM_ReverseCopyVector(benchmark::State& state, kernels::isa level, int bits) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+  std::string key = KernelKey("BM_ReverseCopyVector", table);
+  switch (bits) {
+    case 8: return ReverseCopyWidth(state, key + "/u8", table->reverse_copy_u8);
+    case 16: return ReverseCopyWidth(state, key + "/u16", table->reverse_copy_u16);
+    case 32: return ReverseCopyWidth(state, key + "/i32", table->reverse_copy_i32);
+    default: return ReverseCopyWidth(state, key + "/u64", table->reverse_copy_u64);
+  }
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, kernels::active().level, 8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, kernels::active().level, 8)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, kernels::active().level, 16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, kernels::active().level, 16)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, kernels::active().level, 32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, kernels::active().level, 32)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, kernels::active().level, 64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, kernels::active().level, 64)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx2_u8, kernels::isa::avx2, 8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx2_u16, kernels::isa::avx2, 16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx2_u32, kernels::isa::avx2, 32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx2_u64, kernels::isa::avx2, 64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u8, kernels::isa::avx512, 8)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u16, kernels::isa::avx512, 16)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u32, kernels::isa::avx512, 32)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, avx512_u64, kernels::isa::avx512, 64)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+
+// The out-of-place reverse with cached and non-temporal stores (reverse_copy_i32_stream), as
+// BM_AddVectorsLarge.
+void BM_ReverseCopyVectorLarge(benchmark::State& state, kernels::isa level, bool stream) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table) return;
+
+  auto reverse_copy = stream ? table->reverse_copy_i32_stream : table->reverse_copy_i32;
+  if (!ValidateReverseCopy<int32_t>(state, KernelKey("BM_ReverseCopyVectorLarge", table) + (stream ? "/streaming" : "/cached"), reverse_copy)) return;
+
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int32_t> buffer(N), result(N);
+  int32_t* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int32_t));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVectorLarge, cached, kernels::active().level, false)->Apply(StreamSweep<int>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVectorLarge, streaming, kernels::active().level, true)->Apply(StreamSweep<int>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVectorLarge, avx2_cached, kernels::isa::avx2, false)->Apply(StreamSweep<int>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVectorLarge, avx2_streaming, kernels::isa::avx2, true)->Apply(StreamSweep<int>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVectorLarge, avx512_cached, kernels::isa::avx512, false)->Apply(StreamSweep<int>)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVectorLarge, avx512_streaming, kernels::isa::avx512, true)->Apply(StreamSweep<int>)->MinTime(0.5)->Repetitions(10);
+
+// The same kernels on buffers with a chosen base alignment and a deliberate misalignment offset,
+// to measure what unaligned and cache-line-splitting accesses actually cost.
+void BM_SumVectorAlignment(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateSum(state, KernelKey("BM_SumVector", table), table->sum_i32)) return;
+
+  int N = state.range(2);
+  aligned_buffer<int> buffer(N, state.range(0), state.range(1));
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, 0);
+  int res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = table->sum_i32(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK_CAPTURE(BM_SumVectorAlignment, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_SumVectorAlignment"))->Apply(AlignmentArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorAlignment, avx2, kernels::isa::avx2)->Apply(AlignmentArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorAlignment, avx512, kernels::isa::avx512)->Apply(AlignmentArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_ReverseVectorAlignment(benchmark::State& state, kernels::isa level) {
+  const kernels::kernel_table* table = table_or_skip(state, level);
+  if (!table || !ValidateReverse<int32_t>(state, KernelKey("BM_ReverseVector", table), table->reverse_i32)) return;
+
+  int N = state.range(2);
+  aligned_buffer<int> buffer(N, state.range(0), state.range(1));
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, 0);
+
+  for (auto _ : PerfLoop(state)) {
+    table->reverse_i32(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_ReverseVectorAlignment, dispatch, kernels::active().level)->Name(BENCH_NAME("BM_ReverseVectorAlignment"))->Apply(AlignmentArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorAlignment, avx2, kernels::isa::avx2)->Apply(AlignmentArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorAlignment, avx512, kernels::isa::avx512)->Apply(AlignmentArgs)->MinTime(0.5)->Repetitions(10);
 
-void BM_ReverseVector(benchmark::State& state) {
+// Thread scaling: the array is split across a pool of state.range(last) threads, each chunk runs
+// the dispatched kernel. Wall-clock time is reported because CPU time only covers the main thread.
+// Find stops early across threads; compare it with the BM_FindInVectorFaster runs on the same
+// match positions (MatchPositionArgs) for the latency win.
+void BM_SumVectorParallel(benchmark::State& state) {
+  if (SkipOversubscribed(state, state.range(2))) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
-  const __m256i reversePermutation = _mm256_setr_epi32(7,6,5,4,3,2,1,0);
-
-  for (auto _ : state) {
-    for (int i = 0; i < N / 2; i += 8) {
-      __m256i x = _mm256_loadu_si256((__m256i*) &vector[i]);
-      __m256i y = _mm256_loadu_si256((__m256i*) &vector[N - i - 8]);
-      _mm256_permutevar8x32_epi32(x, reversePermutation);
-      _mm256_permutevar8x32_epi32(y, reversePermutation);
-      _mm256_storeu_si256((__m256i*) &vector[N - i - 8], x);
-      _mm256_storeu_si256((__m256i*) &vector[i], y);
-    }
+  kernels::thread_pool pool(state.range(2));
+  auto sum = [pool = &pool](const int32_t* data, std::size_t n) { return kernels::parallel_sum_i32(*pool, data, n); };
+  if (!ValidateSum(state, "BM_SumVectorParallel/" + std::to_string(state.range(2)), sum)) return;
+  int res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = sum(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVectorParallel)->Apply(ParallelRangeArgs)->UseRealTime()->MinTime(0.5)->Repetitions(10);
+
+void BM_FindInVectorParallel(benchmark::State& state) {
+  if (SkipOversubscribed(state, state.range(3))) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::fill(vector, vector + N, 0);
+  if (state.range(2) >= 0) vector[state.range(2)] = target;
+  kernels::thread_pool pool(state.range(3));
+  auto find = [pool = &pool](const int32_t* data, std::size_t n, int32_t target) { return kernels::parallel_find_i32(*pool, data, n, target); };
+  if (!ValidateFind(state, "BM_FindInVectorParallel/" + std::to_string(state.range(3)), find)) return;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = find(vector, N, target);
 
+    benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  // Elements a single-threaded scan has to look at, so the rates compare with BM_FindInVectorFaster.
+  SetThroughput(state, ScannedElements(state.range(2), N), ScannedElements(state.range(2), N) * sizeof(int));
+}
+BENCHMARK(BM_FindInVectorParallel)->Apply(ParallelFindArgs)->UseRealTime()->MinTime(0.5)->Repetitions(10);
+
+// Two-pass parallel prefix sum on ParallelRangeArgs; one thread is the single-threaded kernel plus
+// the extra pass, so compare against BM_ScanVector at the same N as well.
+void BM_ScanVectorParallel(benchmark::State& state, int type) {
+  if (SkipOversubscribed(state, state.range(2))) return;
+  kernels::thread_pool pool(state.range(2));
+  if (type == 'i') {
+    PrefixSum<int32_t>(state, "BM_ScanVectorParallel/i32/" + std::to_string(state.range(2)), kernels::prefix::inclusive, [pool = &pool](const int32_t* in, int32_t* out, std::size_t n) {
+      kernels::parallel_scan_i32(*pool, in, out, n, 0, kernels::prefix::inclusive);
+    });
+  } else {
+    PrefixSum<float>(state, "BM_ScanVectorParallel/f32/" + std::to_string(state.range(2)), kernels::prefix::inclusive, [pool = &pool](const float* in, float* out, std::size_t n) {
+      kernels::parallel_scan_f32(*pool, in, out, n, 0, kernels::prefix::inclusive);
+    });
+  }
 }
-BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_ScanVectorParallel, inclusive_i32, 'i')->Apply(ParallelRangeArgs)->UseRealTime()->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorParallel, inclusive_f32, 'f')->Apply(ParallelRangeArgs)->UseRealTime()->MinTime(0.5)->Repetitions(10);
+
+// Which kernels the dispatcher picked, and where it switches to non-temporal stores.
+const bool kKernelsContext = (benchmark::AddCustomContext("kernels_isa", kernels::active().name),
+                              benchmark::AddCustomContext("stream_threshold_bytes", std::to_string(kernels::stream_threshold())), true);
+
+} // namespace
 
-BENCHMARK_MAIN();
+BACKEND_MAIN();
@@ -31,6 +31,11 @@ for file_path in glob.glob(file_pattern):
     # Extract benchmark data from the top-level 'benchmarks'
     benchmarks = data['benchmarks']
     for benchmark in benchmarks:
+        # Runs that skipped with an error, e.g. a kernel that failed validation, have no timings
+        if benchmark.get('error_occurred'):
+            logging.warning(f"Skipping {benchmark.get('name')}: {benchmark.get('error_message', '')}")
+            continue
+
         # Extract execution time (cpu_time) and benchmark name
         execution_time = benchmark.get('cpu_time', None)
         benchmark_name = benchmark.get('name', None)
@@ -12,15 +12,21 @@ for filename in data_files:
     with open(json_path, 'r') as file:
         data = json.load(file)
 
-    all_fields = set()
+    # Runs that skipped with an error, e.g. a kernel that failed validation, have no timings.
+    entries = [entry for entry in data['benchmarks'] if not entry.get('error_occurred')]
     for entry in data['benchmarks']:
+        if entry.get('error_occurred'):
+            print(f"{filename}: skipping {entry['name']}: {entry.get('error_message', '')}")
+
+    all_fields = set()
+    for entry in entries:
         all_fields.update(entry.keys())
     fields_list = list(all_fields)
 
     with open(output_csv_path, mode='w', newline='') as file:
         writer = csv.DictWriter(file, fieldnames=fields_list)
         writer.writeheader()
-        for entry in data['benchmarks']:
+        for entry in entries:
             writer.writerow(entry)
 
     print(f"Data from {json_path} written to {output_csv_path}")
@@ -0,0 +1,576 @@
+// AVX2 (256-bit) kernels for kernels.h.
+
+#include "kernels.h"
+
+#include <cstring>
+#include <immintrin.h>
+
+// Only the code below this line may use AVX2, the standard headers above stay baseline x86-64.
+#pragma GCC target("avx2,fma,bmi,bmi2,popcnt")
+
+#include "kernels-elementwise.h"
+#include "kernels-extrema.h"
+#include "kernels-reduce.h"
+#include "kernels-reverse.h"
+#include "kernels-scan.h"
+#include "kernels-transpose.h"
+
+namespace kernels::avx2 {
+
+namespace {
+
+void add_f64(const double* a, const double* b, double* out, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(&a[i]);
+    __m256d y = _mm256_loadu_pd(&b[i]);
+    _mm256_storeu_pd(&out[i], _mm256_add_pd(x, y));
+  }
+  for (; i < n; ++i)
+    out[i] = a[i] + b[i];
+}
+
+// Non-temporal stores need a 32-byte aligned destination: scalar adds up to the first aligned
+// element, streaming stores for the body, scalar adds for the tail, then sfence.
+void add_f64_stream(const double* a, const double* b, double* out, std::size_t n) {
+  std::size_t i = 0;
+  for (; i < n && reinterpret_cast<uintptr_t>(&out[i]) % 32 != 0; ++i)
+    out[i] = a[i] + b[i];
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(&a[i]);
+    __m256d y = _mm256_loadu_pd(&b[i]);
+    _mm256_stream_pd(&out[i], _mm256_add_pd(x, y));
+  }
+  for (; i < n; ++i)
+    out[i] = a[i] + b[i];
+  _mm_sfence();
+}
+
+// Lanes 0..k-1 all-ones, the rest zero, k <= 8.
+__m256i first_n(std::size_t k) {
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32(k), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+// Scans data[i..n) one vector at a time and finishes the last n % 8 elements with the given tail
+// strategy. Overlap re-reads the final 8 elements, which is only valid when n >= 8; the caller has
+// already checked everything before i, so any hit in the overlapped lanes is the first one.
+template <tail T>
+std::ptrdiff_t find_from(const int32_t* data, std::size_t n, int32_t target, std::size_t i) {
+  __m256i x = _mm256_set1_epi32(target);
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i y = _mm256_loadu_si256((const __m256i*) &data[i]);
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  if (i == n) return -1;
+
+  if constexpr (T == tail::masked) {
+    __m256i valid = first_n(n - i);
+    __m256i y = _mm256_maskload_epi32((const int*) &data[i], valid);
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(valid, _mm256_cmpeq_epi32(x, y))));
+    return mask != 0 ? (std::ptrdiff_t) (i + __builtin_ctz(mask)) : -1;
+  }
+  if (T == tail::overlap && n >= 8) {
+    __m256i y = _mm256_loadu_si256((const __m256i*) &data[n - 8]);
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+    return mask != 0 ? (std::ptrdiff_t) (n - 8 + __builtin_ctz(mask)) : -1;
+  }
+  for (; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_i32(const int32_t* data, std::size_t n, int32_t target) {
+  return find_from<tail::overlap>(data, n, target, 0);
+}
+
+std::ptrdiff_t find_i32_unrolled(const int32_t* data, std::size_t n, int32_t target) {
+  __m256i x = _mm256_set1_epi32(target);
+  std::size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    __m256i m1 = _mm256_cmpeq_epi32(x, _mm256_loadu_si256((const __m256i*) &data[i]));
+    __m256i m2 = _mm256_cmpeq_epi32(x, _mm256_loadu_si256((const __m256i*) &data[i + 8]));
+    __m256i m3 = _mm256_cmpeq_epi32(x, _mm256_loadu_si256((const __m256i*) &data[i + 16]));
+    __m256i m4 = _mm256_cmpeq_epi32(x, _mm256_loadu_si256((const __m256i*) &data[i + 24]));
+    __m256i m = _mm256_or_si256(_mm256_or_si256(m1, m2), _mm256_or_si256(m3, m4));
+    if (!_mm256_testz_si256(m, m)) {
+      // Pack the four 8-bit masks into one 32-bit mask so a single tzcnt finds the first hit.
+      uint32_t mask = (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(m1))
+                    | (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(m2)) << 8
+                    | (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(m3)) << 16
+                    | (uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(m4)) << 24;
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return find_from<tail::overlap>(data, n, target, i);
+}
+
+// Compares every vector against K broadcast keys, K a power of two covering keys.size (the padded
+// keys repeat the first one, which does not change the result).
+template <int K>
+std::ptrdiff_t find_any_broadcast(const int32_t* data, std::size_t n, const key_set& keys) {
+  __m256i x[K];
+  for (int j = 0; j < K; ++j) x[j] = _mm256_set1_epi32(keys.padded[j]);
+  std::size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i y = _mm256_loadu_si256((const __m256i*) &data[i]);
+    __m256i m = _mm256_cmpeq_epi32(x[0], y);
+    for (int j = 1; j < K; ++j) m = _mm256_or_si256(m, _mm256_cmpeq_epi32(x[j], y));
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  for (; i < n; ++i) {
+    if (contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+// Bit `index` (0..255 per lane) of a 256-bit bitmap held in one register: vpermd picks the 32-bit
+// word, vpsrlvd moves the bit to bit 0. Higher bits of the result are garbage.
+__m256i bitmap_lookup(__m256i bitmap, __m256i index) {
+  __m256i word = _mm256_permutevar8x32_epi32(bitmap, _mm256_srli_epi32(index, 5));
+  return _mm256_srlv_epi32(word, _mm256_and_si256(index, _mm256_set1_epi32(31)));
+}
+
+// Lanes whose three hash bytes are all set in the key_set filters are candidates and are checked
+// exactly. With 64 keys about 1% of non-member lanes still pass.
+std::ptrdiff_t find_any_filter(const int32_t* data, std::size_t n, const key_set& keys) {
+  __m256i filter0 = _mm256_loadu_si256((const __m256i*) keys.filter[0]);
+  __m256i filter1 = _mm256_loadu_si256((const __m256i*) keys.filter[1]);
+  __m256i filter2 = _mm256_loadu_si256((const __m256i*) keys.filter[2]);
+  __m256i multiplier = _mm256_set1_epi32(0x9e3779b1u);
+  __m256i lowByte = _mm256_set1_epi32(0xff);
+  std::size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i h = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*) &data[i]), multiplier);
+    __m256i hit = _mm256_and_si256(bitmap_lookup(filter0, _mm256_srli_epi32(h, 24)),
+                                   bitmap_lookup(filter1, _mm256_and_si256(_mm256_srli_epi32(h, 16), lowByte)));
+    hit = _mm256_and_si256(hit, bitmap_lookup(filter2, _mm256_and_si256(_mm256_srli_epi32(h, 8), lowByte)));
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(hit, 31)));
+    for (; mask != 0; mask &= mask - 1) {
+      std::size_t j = i + __builtin_ctz(mask);
+      if (contains(keys, data[j])) return j;
+    }
+  }
+  for (; i < n; ++i) {
+    if (contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_any_i32(const int32_t* data, std::size_t n, const key_set& keys) {
+  if (keys.size == 0) return -1;
+  if (keys.size == 1) return find_any_broadcast<1>(data, n, keys);
+  if (keys.size == 2) return find_any_broadcast<2>(data, n, keys);
+  if (keys.size <= 4) return find_any_broadcast<4>(data, n, keys);
+  if (keys.size <= 8) return find_any_broadcast<8>(data, n, keys);
+  return find_any_filter(data, n, keys);
+}
+
+std::ptrdiff_t find_u8(const uint8_t* data, std::size_t n, uint8_t target) {
+  __m256i x = _mm256_set1_epi8(target);
+  std::size_t i = 0;
+
+  for (; i + 128 <= n; i += 128) {
+    __m256i m1 = _mm256_cmpeq_epi8(x, _mm256_loadu_si256((const __m256i*) &data[i]));
+    __m256i m2 = _mm256_cmpeq_epi8(x, _mm256_loadu_si256((const __m256i*) &data[i + 32]));
+    __m256i m3 = _mm256_cmpeq_epi8(x, _mm256_loadu_si256((const __m256i*) &data[i + 64]));
+    __m256i m4 = _mm256_cmpeq_epi8(x, _mm256_loadu_si256((const __m256i*) &data[i + 96]));
+    __m256i m = _mm256_or_si256(_mm256_or_si256(m1, m2), _mm256_or_si256(m3, m4));
+    if (!_mm256_testz_si256(m, m)) {
+      // Four 32-bit masks do not fit one register, so the first two are checked before the rest.
+      uint64_t lo = (uint32_t) _mm256_movemask_epi8(m1) | (uint64_t) (uint32_t) _mm256_movemask_epi8(m2) << 32;
+      if (lo != 0) return i + __builtin_ctzll(lo);
+      uint64_t hi = (uint32_t) _mm256_movemask_epi8(m3) | (uint64_t) (uint32_t) _mm256_movemask_epi8(m4) << 32;
+      return i + 64 + __builtin_ctzll(hi);
+    }
+  }
+  for (; i + 32 <= n; i += 32) {
+    uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_loadu_si256((const __m256i*) &data[i])));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  // Overlap the last vector with what was already checked, as find_i32 does.
+  if (i < n && n >= 32) {
+    uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_loadu_si256((const __m256i*) &data[n - 32])));
+    return mask != 0 ? (std::ptrdiff_t) (n - 32 + __builtin_ctz(mask)) : -1;
+  }
+  for (; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches m - 1
+// bytes further on, two loads that far apart; only those are compared in full. Needle bytes that
+// are rare in the text make candidates rare.
+std::ptrdiff_t find_substr_u8(const uint8_t* data, std::size_t n, const uint8_t* needle, std::size_t m) {
+  if (m == 0) return 0;
+  if (m == 1) return find_u8(data, n, needle[0]);
+  __m256i first = _mm256_set1_epi8(needle[0]);
+  __m256i last = _mm256_set1_epi8(needle[m - 1]);
+  std::size_t i = 0;
+
+  for (; i + m - 1 + 32 <= n; i += 32) {
+    __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i*) &data[i])),
+                                   _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i*) &data[i + m - 1])));
+    for (uint32_t mask = _mm256_movemask_epi8(hit); mask != 0; mask &= mask - 1) {
+      std::size_t j = i + __builtin_ctz(mask);
+      if (std::memcmp(&data[j + 1], needle + 1, m - 2) == 0) return j;
+    }
+  }
+  for (; i + m <= n; ++i) {
+    if (data[i] == needle[0] && std::memcmp(&data[i + 1], needle + 1, m - 1) == 0) return i;
+  }
+  return -1;
+}
+
+// Row m packs the positions of the set bits of the 8-bit mask m, one per byte, lowest first. Widened
+// to 32 bits they are the vpermd indices that move the selected lanes to the front (2 KiB in all,
+// instead of 8 KiB for a table of full permutation vectors).
+struct compress_lut {
+  uint64_t rows[256];
+  constexpr compress_lut() : rows() {
+    for (int m = 0; m < 256; ++m) {
+      int k = 0;
+      for (int j = 0; j < 8; ++j) {
+        if (m >> j & 1) rows[m] |= uint64_t(j) << (8 * k++);
+      }
+    }
+  }
+};
+constexpr compress_lut kCompress;
+
+// Every step stores a whole vector of indices and advances by the number of matches. The count
+// never exceeds i, so the full-width store stays inside out[0, n).
+std::size_t find_all_i32(const int32_t* data, std::size_t n, int32_t target, uint32_t* out) {
+  __m256i x = _mm256_set1_epi32(target);
+  __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  std::size_t count = 0, i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i y = _mm256_loadu_si256((const __m256i*) &data[i]);
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, y)));
+    __m256i permutation = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(kCompress.rows[mask]));
+    _mm256_storeu_si256((__m256i*) &out[count], _mm256_permutevar8x32_epi32(index, permutation));
+    count += _mm_popcnt_u32(mask);
+    index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+  }
+  for (; i < n; ++i) {
+    out[count] = i;
+    count += data[i] == target;
+  }
+  return count;
+}
+
+// Keys below x in a node: two compares, one movemask each.
+std::size_t btree_lower_bound_i32(const int32_t* tree, std::size_t size, int32_t x) {
+  __m256i y = _mm256_set1_epi32(x);
+  std::size_t nodes = size / btree_node, res = size;
+  for (std::size_t k = 0; k < nodes;) {
+    const __m256i* node = (const __m256i*) &tree[k * btree_node];
+    int lo = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(y, _mm256_loadu_si256(node))));
+    int hi = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(y, _mm256_loadu_si256(node + 1))));
+    std::size_t i = __builtin_popcount(lo | hi << 8);
+    if (i < btree_node) res = k * btree_node + i;
+    k = k * (btree_node + 1) + i + 1;
+  }
+  return res;
+}
+
+// Overlap re-reads the final 8 elements and zeroes the lanes that were already summed.
+template <tail T>
+int32_t sum(const int32_t* data, std::size_t n) {
+  __m256i s1 = _mm256_setzero_si256();
+  __m256i s2 = _mm256_setzero_si256();
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    s1 = _mm256_add_epi32(s1, _mm256_loadu_si256((const __m256i*) &data[i]));
+    s2 = _mm256_add_epi32(s2, _mm256_loadu_si256((const __m256i*) &data[i + 8]));
+  }
+  if (i + 8 <= n) {
+    s1 = _mm256_add_epi32(s1, _mm256_loadu_si256((const __m256i*) &data[i]));
+    i += 8;
+  }
+
+  uint32_t res = 0;
+  if (i < n) {
+    if constexpr (T == tail::masked) {
+      s2 = _mm256_add_epi32(s2, _mm256_maskload_epi32((const int*) &data[i], first_n(n - i)));
+    } else if (T == tail::overlap && n >= 8) {
+      __m256i y = _mm256_loadu_si256((const __m256i*) &data[n - 8]);
+      s2 = _mm256_add_epi32(s2, _mm256_andnot_si256(first_n(8 - (n - i)), y));
+    } else {
+      for (; i < n; ++i)
+        res += data[i];
+    }
+  }
+
+  __m256i s = _mm256_add_epi32(s1, s2);
+  __m128i h = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+  h = _mm_add_epi32(h, _mm_shuffle_epi32(h, 0x4e));
+  h = _mm_add_epi32(h, _mm_shuffle_epi32(h, 0xb1));
+  return res + _mm_cvtsi128_si32(h);
+}
+
+int32_t sum_i32(const int32_t* data, std::size_t n) {
+  return sum<tail::masked>(data, n);
+}
+
+// vpmovsxdq widens four int32 from a 128-bit load to four int64, so every 8 elements cost two
+// widening loads and two 64-bit adds instead of one 32-bit add.
+int64_t sum_i32_i64(const int32_t* data, std::size_t n) {
+  __m256i s1 = _mm256_setzero_si256();
+  __m256i s2 = _mm256_setzero_si256();
+  std::size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*) &data[i])));
+    s2 = _mm256_add_epi64(s2, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*) &data[i + 4])));
+  }
+  if (i < n) {
+    __m256i x = _mm256_maskload_epi32((const int*) &data[i], first_n(n - i));
+    s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+    s2 = _mm256_add_epi64(s2, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+  }
+
+  __m256i s = _mm256_add_epi64(s1, s2);
+  __m128i h = _mm_add_epi64(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+  return _mm_cvtsi128_si64(h) + _mm_extract_epi64(h, 1);
+}
+
+// Index registers for kernels-extrema.h, one lane per element.
+struct index32x8 {
+  using index = uint32_t;
+  using ivec = __m256i;
+  static ivec iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+  static ivec splat_index(index k) { return _mm256_set1_epi32(k); }
+  static ivec add_index(ivec i, ivec j) { return _mm256_add_epi32(i, j); }
+  static void store_index(index* p, ivec i) { _mm256_storeu_si256((__m256i*) p, i); }
+};
+
+struct index64x4 {
+  using index = uint64_t;
+  using ivec = __m256i;
+  static ivec iota() { return _mm256_setr_epi64x(0, 1, 2, 3); }
+  static ivec splat_index(index k) { return _mm256_set1_epi64x(k); }
+  static ivec add_index(ivec i, ivec j) { return _mm256_add_epi64(i, j); }
+  static void store_index(index* p, ivec i) { _mm256_storeu_si256((__m256i*) p, i); }
+};
+
+// Reverse traits for kernels-reverse.h. Byte shuffles and the 32-bit vpermd stay within 128-bit
+// lanes, so the 8- and 16-bit versions reverse each lane with vpshufb and then swap the two lanes.
+struct v256 {
+  using vec = __m256i;
+  static vec load(const void* p) { return _mm256_loadu_si256((const __m256i*) p); }
+  static void store(void* p, vec v) { _mm256_storeu_si256((__m256i*) p, v); }
+  static void stream(void* p, vec v) { _mm256_stream_si256((__m256i*) p, v); }
+  static void fence() { _mm_sfence(); }
+};
+
+struct u8x32 : v256 {
+  using T = uint8_t;
+  static constexpr std::size_t lanes = 32;
+  static vec reverse(vec v) {
+    const __m256i inLane = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                            15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, inLane), 0x4e);
+  }
+};
+
+struct u16x16 : v256 {
+  using T = uint16_t;
+  static constexpr std::size_t lanes = 16;
+  static vec reverse(vec v) {
+    const __m256i inLane = _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                            14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, inLane), 0x4e);
+  }
+};
+
+struct i32x8 : v256, index32x8 {
+  using T = int32_t;
+  using mask = __m256i;
+  static constexpr std::size_t lanes = 8;
+  static vec reverse(vec v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+  static vec min(vec a, vec b) { return _mm256_min_epi32(a, b); }
+  static vec max(vec a, vec b) { return _mm256_max_epi32(a, b); }
+  static mask less(vec a, vec b) { return _mm256_cmpgt_epi32(b, a); }
+  static vec select(mask m, vec a, vec b) { return _mm256_blendv_epi8(a, b, m); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm256_blendv_epi8(i, j, m); }
+  static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+  static vec splat(T x) { return _mm256_set1_epi32(x); }
+  // vpslldq shifts each 128-bit lane on its own, so after scanning both halves the high one still
+  // needs the low half's total: vperm2i128 moves the low half up (zeroing the bottom) and vpshufd
+  // broadcasts its last lane.
+  static vec scan(vec v) {
+    v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+    v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+    return _mm256_add_epi32(v, _mm256_shuffle_epi32(_mm256_permute2x128_si256(v, v, 0x08), 0xff));
+  }
+  static vec shift_up(vec v) { return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(v, v, 0x08), 12); }
+  static vec broadcast_last(vec v) { return _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(7)); }
+};
+
+struct u64x4 : v256 {
+  using T = uint64_t;
+  static constexpr std::size_t lanes = 4;
+  static vec reverse(vec v) { return _mm256_permute4x64_epi64(v, 0x1b); }
+};
+
+struct f32x8 : index32x8 {
+  using T = float;
+  using vec = __m256;
+  using mask = __m256;
+  static constexpr std::size_t lanes = 8;
+  static vec zero() { return _mm256_setzero_ps(); }
+  static vec load(const T* p) { return _mm256_loadu_ps(p); }
+  static vec load_partial(const T* p, std::size_t k) { return _mm256_maskload_ps(p, first_n(k)); }
+  static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+  static vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) { return _mm256_blendv_ps(y, x, _mm256_cmp_ps(abs(a), abs(b), _CMP_GE_OQ)); }
+  static void store(T* p, vec v) { _mm256_storeu_ps(p, v); }
+  static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+  static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+  static mask less(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static vec select(mask m, vec a, vec b) { return _mm256_blendv_ps(a, b, m); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(i), _mm256_castsi256_ps(j), m)); }
+  static vec splat(T x) { return _mm256_set1_ps(x); }
+  static vec scan(vec v) {
+    __m256i x = _mm256_castps_si256(v);
+    v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(x, 4)));
+    x = _mm256_castps_si256(v);
+    v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(x, 8)));
+    x = _mm256_castps_si256(v);
+    return _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_shuffle_epi32(_mm256_permute2x128_si256(x, x, 0x08), 0xff)));
+  }
+  static vec shift_up(vec v) {
+    __m256i x = _mm256_castps_si256(v);
+    return _mm256_castsi256_ps(_mm256_alignr_epi8(x, _mm256_permute2x128_si256(x, x, 0x08), 12));
+  }
+  static vec broadcast_last(vec v) { return _mm256_permutevar8x32_ps(v, _mm256_set1_epi32(7)); }
+};
+
+struct f64x4 : index64x4 {
+  using T = double;
+  using vec = __m256d;
+  using mask = __m256d;
+  static constexpr std::size_t lanes = 4;
+  static vec zero() { return _mm256_setzero_pd(); }
+  static vec load(const T* p) { return _mm256_loadu_pd(p); }
+  static vec load_partial(const T* p, std::size_t k) {
+    // Each 64-bit lane needs both halves of its mask set.
+    __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(k), _mm256_setr_epi64x(0, 1, 2, 3));
+    return _mm256_maskload_pd(p, mask);
+  }
+  static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+  static vec sub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+  static vec abs(vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) { return _mm256_blendv_pd(y, x, _mm256_cmp_pd(abs(a), abs(b), _CMP_GE_OQ)); }
+  static void store(T* p, vec v) { _mm256_storeu_pd(p, v); }
+  static vec splat(T x) { return _mm256_set1_pd(x); }
+  static vec mul_add(vec a, vec b, vec c) { return _mm256_fmadd_pd(a, b, c); }
+  static T mul_add(T a, T b, T c) { return __builtin_fma(a, b, c); }
+  static vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+  static vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+  static mask less(vec a, vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static vec select(mask m, vec a, vec b) { return _mm256_blendv_pd(a, b, m); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(i), _mm256_castsi256_pd(j), m)); }
+};
+
+float sum_f32(const float* data, std::size_t n, fp_sum method) {
+  return sum_fp<f32x8>(data, n, method);
+}
+
+double sum_f64(const double* data, std::size_t n, fp_sum method) {
+  return sum_fp<f64x4>(data, n, method);
+}
+
+// Records of 4 doubles, one per register. unpacklo/unpackhi pair up records 0-1 and 2-3 within
+// each 128-bit lane, and vperm2f128 then joins the matching lanes into whole fields.
+struct records4_f64 {
+  using T = double;
+  using vec = __m256d;
+  static constexpr std::size_t fields = 4, records = 4;
+  static vec load_records(const T* p) { return _mm256_loadu_pd(p); }
+  static void store_records(T* p, vec v) { _mm256_storeu_pd(p, v); }
+  static vec load_plane(const T* p) { return _mm256_loadu_pd(p); }
+  static void store_plane(T* p, vec v) { _mm256_storeu_pd(p, v); }
+  static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+  static vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+  static void transpose(vec (&r)[4]) {
+    __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]); // x0 x1 z0 z1
+    __m256d t1 = _mm256_unpackhi_pd(r[0], r[1]); // y0 y1 w0 w1
+    __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]); // x2 x3 z2 z3
+    __m256d t3 = _mm256_unpackhi_pd(r[2], r[3]); // y2 y3 w2 w3
+    r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+    r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+  }
+};
+
+// Records of 8 floats, one per register: unpacklo/unpackhi and shuffle_ps transpose the 4x4 blocks
+// inside each 128-bit lane, and vperm2f128 swaps the off-diagonal blocks.
+struct records8_f32 {
+  using T = float;
+  using vec = __m256;
+  static constexpr std::size_t fields = 8, records = 8;
+  static vec load_records(const T* p) { return _mm256_loadu_ps(p); }
+  static void store_records(T* p, vec v) { _mm256_storeu_ps(p, v); }
+  static vec load_plane(const T* p) { return _mm256_loadu_ps(p); }
+  static void store_plane(T* p, vec v) { _mm256_storeu_ps(p, v); }
+  static void transpose(vec (&r)[8]) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xee);
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xee);
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xee);
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xee);
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+  }
+};
+
+} // namespace
+
+std::ptrdiff_t find_i32_tail(const int32_t* data, std::size_t n, int32_t target, tail strategy) {
+  switch (strategy) {
+    case tail::masked: return find_from<tail::masked>(data, n, target, 0);
+    case tail::overlap: return find_from<tail::overlap>(data, n, target, 0);
+    default: return find_from<tail::scalar>(data, n, target, 0);
+  }
+}
+
+int32_t sum_i32_tail(const int32_t* data, std::size_t n, tail strategy) {
+  switch (strategy) {
+    case tail::masked: return sum<tail::masked>(data, n);
+    case tail::overlap: return sum<tail::overlap>(data, n);
+    default: return sum<tail::scalar>(data, n);
+  }
+}
+
+const kernel_table table = {isa::avx2, "avx2", add_f64, add_f64_stream, find_i32, find_i32_unrolled, find_all_i32, find_any_i32, find_u8, find_substr_u8, btree_lower_bound_i32, sum_i32, sum_i32_i64,
+                            reverse_in_place<u8x32>, reverse_in_place<u16x16>, reverse_in_place<i32x8>, reverse_in_place<u64x4>,
+                            reverse_copy<u8x32>, reverse_copy<u16x16>, reverse_copy<i32x8>, reverse_copy<u64x4>, reverse_copy_stream<i32x8>,
+                            sum_f32, sum_f64, extreme<i32x8>, extreme<f32x8>, extreme<f64x4>,
+                            arg_extreme<i32x8>, arg_extreme<f32x8>, arg_extreme<f64x4>, prefix_sum<i32x8>, prefix_sum<f32x8>,
+                            axpy<f64x4>, multiply_add<f64x4>, triad<f64x4>,
+                            aos_to_soa<records4_f64>, soa_to_aos<records4_f64>, aos_to_soa<records8_f32>, soa_to_aos<records8_f32>,
+                            squared_norm_aos<records4_f64>, squared_norm_soa<records4_f64>};
+
+} // namespace kernels::avx2
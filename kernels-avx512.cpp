@@ -0,0 +1,569 @@
+// AVX-512 (512-bit) kernels for kernels.h. Requires F, DQ, BW and VL (Skylake-SP and later).
+
+#include "kernels.h"
+
+#include <cstring>
+#include <immintrin.h>
+
+// Only the code below this line may use AVX-512, the standard headers above stay baseline x86-64.
+#pragma GCC target("avx512f,avx512dq,avx512bw,avx512vl,avx2,fma,bmi,bmi2,popcnt")
+
+#include "kernels-elementwise.h"
+#include "kernels-extrema.h"
+#include "kernels-reduce.h"
+#include "kernels-reverse.h"
+#include "kernels-scan.h"
+#include "kernels-transpose.h"
+
+namespace kernels::avx512 {
+
+namespace {
+
+// Mask with the low k lanes set, k <= 16. Masked loads never fault on the lanes that are off,
+// so the remainder of any length is handled in vector form without reading past the end.
+__mmask16 first_n(std::size_t k) {
+  return _cvtu32_mask16((1u << k) - 1);
+}
+
+__mmask8 first_n8(std::size_t k) {
+  return _cvtu32_mask8((1u << k) - 1);
+}
+
+void add_f64(const double* a, const double* b, double* out, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m512d x = _mm512_loadu_pd(&a[i]);
+    __m512d y = _mm512_loadu_pd(&b[i]);
+    _mm512_storeu_pd(&out[i], _mm512_add_pd(x, y));
+  }
+  __mmask8 k = first_n8(n - i);
+  __m512d x = _mm512_maskz_loadu_pd(k, &a[i]);
+  __m512d y = _mm512_maskz_loadu_pd(k, &b[i]);
+  _mm512_mask_storeu_pd(&out[i], k, _mm512_add_pd(x, y));
+}
+
+// Non-temporal stores need a 64-byte aligned destination: scalar adds up to the first aligned
+// element, streaming stores for the body, scalar adds for the tail, then sfence.
+void add_f64_stream(const double* a, const double* b, double* out, std::size_t n) {
+  std::size_t i = 0;
+  for (; i < n && reinterpret_cast<uintptr_t>(&out[i]) % 64 != 0; ++i)
+    out[i] = a[i] + b[i];
+  for (; i + 8 <= n; i += 8) {
+    __m512d x = _mm512_loadu_pd(&a[i]);
+    __m512d y = _mm512_loadu_pd(&b[i]);
+    _mm512_stream_pd(&out[i], _mm512_add_pd(x, y));
+  }
+  for (; i < n; ++i)
+    out[i] = a[i] + b[i];
+  _mm_sfence();
+}
+
+template <tail T>
+std::ptrdiff_t find_from(const int32_t* data, std::size_t n, int32_t target, std::size_t i) {
+  __m512i x = _mm512_set1_epi32(target);
+
+  for (; i + 16 <= n; i += 16) {
+    __mmask16 mask = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[i]));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  if (i == n) return -1;
+
+  if constexpr (T == tail::masked) {
+    __mmask16 k = first_n(n - i);
+    __mmask16 mask = _mm512_mask_cmpeq_epi32_mask(k, x, _mm512_maskz_loadu_epi32(k, &data[i]));
+    return mask != 0 ? (std::ptrdiff_t) (i + __builtin_ctz(mask)) : -1;
+  }
+  if (T == tail::overlap && n >= 16) {
+    __mmask16 mask = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[n - 16]));
+    return mask != 0 ? (std::ptrdiff_t) (n - 16 + __builtin_ctz(mask)) : -1;
+  }
+  for (; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_i32(const int32_t* data, std::size_t n, int32_t target) {
+  return find_from<tail::masked>(data, n, target, 0);
+}
+
+std::ptrdiff_t find_i32_unrolled(const int32_t* data, std::size_t n, int32_t target) {
+  __m512i x = _mm512_set1_epi32(target);
+  std::size_t i = 0;
+
+  for (; i + 64 <= n; i += 64) {
+    __mmask16 m1 = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[i]));
+    __mmask16 m2 = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[i + 16]));
+    __mmask16 m3 = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[i + 32]));
+    __mmask16 m4 = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[i + 48]));
+    uint64_t mask = (uint64_t) m1 | (uint64_t) m2 << 16 | (uint64_t) m3 << 32 | (uint64_t) m4 << 48;
+    if (mask != 0) return i + __builtin_ctzll(mask);
+  }
+  return find_from<tail::masked>(data, n, target, i);
+}
+
+// Compares every vector against K broadcast keys, K a power of two covering keys.size (the padded
+// keys repeat the first one, which does not change the result).
+template <int K>
+std::ptrdiff_t find_any_broadcast(const int32_t* data, std::size_t n, const key_set& keys) {
+  __m512i x[K];
+  for (int j = 0; j < K; ++j) x[j] = _mm512_set1_epi32(keys.padded[j]);
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m512i y = _mm512_loadu_si512(&data[i]);
+    __mmask16 mask = _mm512_cmpeq_epi32_mask(x[0], y);
+    for (int j = 1; j < K; ++j) mask = _kor_mask16(mask, _mm512_cmpeq_epi32_mask(x[j], y));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  for (; i < n; ++i) {
+    if (contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+// Bit `index` (0..255 per lane) of a 256-bit bitmap in the low half of a register: vpermd picks
+// the 32-bit word, vpsrlvd moves the bit to bit 0. Higher bits of the result are garbage.
+__m512i bitmap_lookup(__m512i bitmap, __m512i index) {
+  __m512i word = _mm512_permutexvar_epi32(_mm512_srli_epi32(index, 5), bitmap);
+  return _mm512_srlv_epi32(word, _mm512_and_si512(index, _mm512_set1_epi32(31)));
+}
+
+// Lanes whose three hash bytes are all set in the key_set filters are candidates and are checked
+// exactly. With 64 keys about 1% of non-member lanes still pass.
+std::ptrdiff_t find_any_filter(const int32_t* data, std::size_t n, const key_set& keys) {
+  __m512i filter0 = _mm512_zextsi256_si512(_mm256_loadu_si256((const __m256i*) keys.filter[0]));
+  __m512i filter1 = _mm512_zextsi256_si512(_mm256_loadu_si256((const __m256i*) keys.filter[1]));
+  __m512i filter2 = _mm512_zextsi256_si512(_mm256_loadu_si256((const __m256i*) keys.filter[2]));
+  __m512i multiplier = _mm512_set1_epi32(0x9e3779b1u);
+  __m512i lowByte = _mm512_set1_epi32(0xff);
+  __m512i one = _mm512_set1_epi32(1);
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m512i h = _mm512_mullo_epi32(_mm512_loadu_si512(&data[i]), multiplier);
+    __m512i hit = _mm512_and_si512(bitmap_lookup(filter0, _mm512_srli_epi32(h, 24)),
+                                   bitmap_lookup(filter1, _mm512_and_si512(_mm512_srli_epi32(h, 16), lowByte)));
+    hit = _mm512_and_si512(hit, bitmap_lookup(filter2, _mm512_and_si512(_mm512_srli_epi32(h, 8), lowByte)));
+    for (uint32_t mask = _mm512_test_epi32_mask(hit, one); mask != 0; mask &= mask - 1) {
+      std::size_t j = i + __builtin_ctz(mask);
+      if (contains(keys, data[j])) return j;
+    }
+  }
+  for (; i < n; ++i) {
+    if (contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_any_i32(const int32_t* data, std::size_t n, const key_set& keys) {
+  if (keys.size == 0) return -1;
+  if (keys.size == 1) return find_any_broadcast<1>(data, n, keys);
+  if (keys.size == 2) return find_any_broadcast<2>(data, n, keys);
+  if (keys.size <= 4) return find_any_broadcast<4>(data, n, keys);
+  if (keys.size <= 8) return find_any_broadcast<8>(data, n, keys);
+  return find_any_filter(data, n, keys);
+}
+
+std::ptrdiff_t find_u8(const uint8_t* data, std::size_t n, uint8_t target) {
+  __m512i x = _mm512_set1_epi8(target);
+  std::size_t i = 0;
+
+  for (; i + 256 <= n; i += 256) {
+    uint64_t m1 = _mm512_cmpeq_epi8_mask(x, _mm512_loadu_si512(&data[i]));
+    uint64_t m2 = _mm512_cmpeq_epi8_mask(x, _mm512_loadu_si512(&data[i + 64]));
+    uint64_t m3 = _mm512_cmpeq_epi8_mask(x, _mm512_loadu_si512(&data[i + 128]));
+    uint64_t m4 = _mm512_cmpeq_epi8_mask(x, _mm512_loadu_si512(&data[i + 192]));
+    if ((m1 | m2 | m3 | m4) != 0) {
+      if (m1 != 0) return i + __builtin_ctzll(m1);
+      if (m2 != 0) return i + 64 + __builtin_ctzll(m2);
+      if (m3 != 0) return i + 128 + __builtin_ctzll(m3);
+      return i + 192 + __builtin_ctzll(m4);
+    }
+  }
+  for (; i + 64 <= n; i += 64) {
+    uint64_t mask = _mm512_cmpeq_epi8_mask(x, _mm512_loadu_si512(&data[i]));
+    if (mask != 0) return i + __builtin_ctzll(mask);
+  }
+  if (i == n) return -1;
+
+  // Masked tail, as find_i32: the lanes past n are neither loaded nor compared.
+  __mmask64 k = _bzhi_u64(~uint64_t(0), n - i);
+  uint64_t mask = _mm512_mask_cmpeq_epi8_mask(k, x, _mm512_maskz_loadu_epi8(k, &data[i]));
+  return mask != 0 ? (std::ptrdiff_t) (i + __builtin_ctzll(mask)) : -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches m - 1
+// bytes further on, two loads that far apart; only those are compared in full. Needle bytes that
+// are rare in the text make candidates rare.
+std::ptrdiff_t find_substr_u8(const uint8_t* data, std::size_t n, const uint8_t* needle, std::size_t m) {
+  if (m == 0) return 0;
+  if (m == 1) return find_u8(data, n, needle[0]);
+  __m512i first = _mm512_set1_epi8(needle[0]);
+  __m512i last = _mm512_set1_epi8(needle[m - 1]);
+  std::size_t i = 0;
+
+  for (; i + m - 1 + 64 <= n; i += 64) {
+    __mmask64 candidates = _mm512_cmpeq_epi8_mask(first, _mm512_loadu_si512(&data[i]));
+    uint64_t mask = _mm512_mask_cmpeq_epi8_mask(candidates, last, _mm512_loadu_si512(&data[i + m - 1]));
+    for (; mask != 0; mask &= mask - 1) {
+      std::size_t j = i + __builtin_ctzll(mask);
+      if (std::memcmp(&data[j + 1], needle + 1, m - 2) == 0) return j;
+    }
+  }
+  for (; i + m <= n; ++i) {
+    if (data[i] == needle[0] && std::memcmp(&data[i + 1], needle + 1, m - 1) == 0) return i;
+  }
+  return -1;
+}
+
+// vpcompressd packs the matching indices into the low lanes of a register, which is then stored
+// whole; the count never exceeds i, so that store stays inside out[0, n). Compressing straight to
+// memory (vpcompressd m32) is microcoded on several cores and much slower. The tail stores only
+// the matches.
+std::size_t find_all_i32(const int32_t* data, std::size_t n, int32_t target, uint32_t* out) {
+  __m512i x = _mm512_set1_epi32(target);
+  __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  std::size_t count = 0, i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __mmask16 mask = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(&data[i]));
+    _mm512_storeu_si512(&out[count], _mm512_maskz_compress_epi32(mask, index));
+    count += _mm_popcnt_u32(mask);
+    index = _mm512_add_epi32(index, _mm512_set1_epi32(16));
+  }
+  if (i < n) {
+    __mmask16 mask = _mm512_mask_cmpeq_epi32_mask(first_n(n - i), x, _mm512_maskz_loadu_epi32(first_n(n - i), &data[i]));
+    std::size_t matches = _mm_popcnt_u32(mask);
+    _mm512_mask_storeu_epi32(&out[count], first_n(matches), _mm512_maskz_compress_epi32(mask, index));
+    count += matches;
+  }
+  return count;
+}
+
+// A node is exactly one register, so the keys below x are one compare and a popcount.
+std::size_t btree_lower_bound_i32(const int32_t* tree, std::size_t size, int32_t x) {
+  __m512i y = _mm512_set1_epi32(x);
+  std::size_t nodes = size / btree_node, res = size;
+  for (std::size_t k = 0; k < nodes;) {
+    std::size_t i = __builtin_popcount(_mm512_cmplt_epi32_mask(_mm512_loadu_si512(&tree[k * btree_node]), y));
+    if (i < btree_node) res = k * btree_node + i;
+    k = k * (btree_node + 1) + i + 1;
+  }
+  return res;
+}
+
+template <tail T>
+int32_t sum(const int32_t* data, std::size_t n) {
+  __m512i s1 = _mm512_setzero_si512();
+  __m512i s2 = _mm512_setzero_si512();
+  std::size_t i = 0;
+
+  for (; i + 32 <= n; i += 32) {
+    s1 = _mm512_add_epi32(s1, _mm512_loadu_si512(&data[i]));
+    s2 = _mm512_add_epi32(s2, _mm512_loadu_si512(&data[i + 16]));
+  }
+  if (i + 16 <= n) {
+    s1 = _mm512_add_epi32(s1, _mm512_loadu_si512(&data[i]));
+    i += 16;
+  }
+
+  uint32_t res = 0;
+  if (i < n) {
+    if constexpr (T == tail::masked) {
+      s2 = _mm512_add_epi32(s2, _mm512_maskz_loadu_epi32(first_n(n - i), &data[i]));
+    } else if (T == tail::overlap && n >= 16) {
+      // Keep only the lanes past the ones already summed.
+      __mmask16 fresh = _knot_mask16(first_n(16 - (n - i)));
+      s2 = _mm512_mask_add_epi32(s2, fresh, s2, _mm512_loadu_si512(&data[n - 16]));
+    } else {
+      for (; i < n; ++i)
+        res += data[i];
+    }
+  }
+
+  return res + _mm512_reduce_add_epi32(_mm512_add_epi32(s1, s2));
+}
+
+int32_t sum_i32(const int32_t* data, std::size_t n) {
+  return sum<tail::masked>(data, n);
+}
+
+// vpmovsxdq widens eight int32 from a 256-bit load to eight int64 lanes.
+int64_t sum_i32_i64(const int32_t* data, std::size_t n) {
+  __m512i s1 = _mm512_setzero_si512();
+  __m512i s2 = _mm512_setzero_si512();
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    s1 = _mm512_add_epi64(s1, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*) &data[i])));
+    s2 = _mm512_add_epi64(s2, _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*) &data[i + 8])));
+  }
+  if (i < n) {
+    __m512i x = _mm512_maskz_loadu_epi32(first_n(n - i), &data[i]);
+    s1 = _mm512_add_epi64(s1, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(x)));
+    s2 = _mm512_add_epi64(s2, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(x, 1)));
+  }
+
+  return _mm512_reduce_add_epi64(_mm512_add_epi64(s1, s2));
+}
+
+void reverse_i32(int32_t* data, std::size_t n) {
+  const __m512i reversePermutation = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  std::size_t lo = 0, hi = n;
+
+  // Swap whole vectors from both ends while they do not overlap.
+  for (; hi - lo >= 32; lo += 16, hi -= 16) {
+    __m512i x = _mm512_loadu_si512(&data[lo]);
+    __m512i y = _mm512_loadu_si512(&data[hi - 16]);
+    _mm512_storeu_si512(&data[lo], _mm512_permutexvar_epi32(reversePermutation, y));
+    _mm512_storeu_si512(&data[hi - 16], _mm512_permutexvar_epi32(reversePermutation, x));
+  }
+
+  // Fewer than 32 elements remain: at most one full vector plus a masked one, both loaded before
+  // either store. Lane j of the masked part takes element k - 1 - j.
+  std::size_t r = hi - lo;
+  std::size_t k = r > 16 ? r - 16 : r;
+  __m512i partialPermutation = _mm512_sub_epi32(_mm512_set1_epi32(k - 1), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  __m512i x = _mm512_maskz_loadu_epi32(first_n(k), &data[lo]);
+  if (r > 16) {
+    __m512i y = _mm512_loadu_si512(&data[hi - 16]);
+    _mm512_storeu_si512(&data[lo], _mm512_permutexvar_epi32(reversePermutation, y));
+    lo += 16;
+  }
+  _mm512_mask_storeu_epi32(&data[lo], first_n(k), _mm512_permutexvar_epi32(partialPermutation, x));
+}
+
+// Index registers for kernels-extrema.h, one lane per element.
+struct index32x16 {
+  using index = uint32_t;
+  using ivec = __m512i;
+  static ivec iota() { return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+  static ivec splat_index(index k) { return _mm512_set1_epi32(k); }
+  static ivec add_index(ivec i, ivec j) { return _mm512_add_epi32(i, j); }
+  static void store_index(index* p, ivec i) { _mm512_storeu_si512(p, i); }
+};
+
+struct index64x8 {
+  using index = uint64_t;
+  using ivec = __m512i;
+  static ivec iota() { return _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7); }
+  static ivec splat_index(index k) { return _mm512_set1_epi64(k); }
+  static ivec add_index(ivec i, ivec j) { return _mm512_add_epi64(i, j); }
+  static void store_index(index* p, ivec i) { _mm512_storeu_si512(p, i); }
+};
+
+// Reverse traits for kernels-reverse.h. vpshufb reverses bytes or words inside each 128-bit lane
+// and vshufi64x2 then reverses the four lanes, two cheap shuffles instead of a vpermb/vpermw.
+struct v512 {
+  using vec = __m512i;
+  static vec load(const void* p) { return _mm512_loadu_si512(p); }
+  static void store(void* p, vec v) { _mm512_storeu_si512(p, v); }
+  static void stream(void* p, vec v) { _mm512_stream_si512((__m512i*) p, v); }
+  static void fence() { _mm_sfence(); }
+  static vec reverse_lanes(vec v) { return _mm512_shuffle_i64x2(v, v, 0x1b); }
+};
+
+struct u8x64 : v512 {
+  using T = uint8_t;
+  static constexpr std::size_t lanes = 64;
+  static vec reverse(vec v) {
+    const __m512i inLane = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+    return reverse_lanes(_mm512_shuffle_epi8(v, inLane));
+  }
+};
+
+struct u16x32 : v512 {
+  using T = uint16_t;
+  static constexpr std::size_t lanes = 32;
+  static vec reverse(vec v) {
+    const __m512i inLane = _mm512_broadcast_i32x4(_mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1));
+    return reverse_lanes(_mm512_shuffle_epi8(v, inLane));
+  }
+};
+
+struct i32x16 : v512, index32x16 {
+  using T = int32_t;
+  using mask = __mmask16;
+  static constexpr std::size_t lanes = 16;
+  static vec reverse(vec v) { return _mm512_permutexvar_epi32(_mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), v); }
+  static vec min(vec a, vec b) { return _mm512_min_epi32(a, b); }
+  static vec max(vec a, vec b) { return _mm512_max_epi32(a, b); }
+  static mask less(vec a, vec b) { return _mm512_cmplt_epi32_mask(a, b); }
+  static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_epi32(m, a, b); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm512_mask_blend_epi32(m, i, j); }
+  static vec add(vec a, vec b) { return _mm512_add_epi32(a, b); }
+  static vec splat(T x) { return _mm512_set1_epi32(x); }
+  // valignd over (v, zero) shifts the whole register up by k lanes, so unlike vpslldq there is no
+  // 128-bit boundary to patch up: four shift-and-add steps scan all 16 lanes.
+  static vec scan(vec v) {
+    const __m512i zero = _mm512_setzero_si512();
+    v = _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 15));
+    v = _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 14));
+    v = _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 12));
+    return _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 8));
+  }
+  static vec shift_up(vec v) { return _mm512_alignr_epi32(v, _mm512_setzero_si512(), 15); }
+  static vec broadcast_last(vec v) { return _mm512_permutexvar_epi32(_mm512_set1_epi32(15), v); }
+};
+
+struct u64x8 : v512 {
+  using T = uint64_t;
+  static constexpr std::size_t lanes = 8;
+  static vec reverse(vec v) { return _mm512_permutexvar_epi64(_mm512_setr_epi64(7, 6, 5, 4, 3, 2, 1, 0), v); }
+};
+
+struct f32x16 : index32x16 {
+  using T = float;
+  using vec = __m512;
+  using mask = __mmask16;
+  static constexpr std::size_t lanes = 16;
+  static vec zero() { return _mm512_setzero_ps(); }
+  static vec load(const T* p) { return _mm512_loadu_ps(p); }
+  static vec load_partial(const T* p, std::size_t k) { return _mm512_maskz_loadu_ps(first_n(k), p); }
+  static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) {
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(_mm512_abs_ps(a), _mm512_abs_ps(b), _CMP_GE_OQ), y, x);
+  }
+  static void store(T* p, vec v) { _mm512_storeu_ps(p, v); }
+  static vec min(vec a, vec b) { return _mm512_min_ps(a, b); }
+  static vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+  static mask less(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+  static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, a, b); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm512_mask_blend_epi32(m, i, j); }
+  static vec splat(T x) { return _mm512_set1_ps(x); }
+  // The same valignd steps as i32x16, on the float bits.
+  static vec scan(vec v) {
+    const __m512i zero = _mm512_setzero_si512();
+    v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(v), zero, 15)));
+    v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(v), zero, 14)));
+    v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(v), zero, 12)));
+    return _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(v), zero, 8)));
+  }
+  static vec shift_up(vec v) { return _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(v), _mm512_setzero_si512(), 15)); }
+  static vec broadcast_last(vec v) { return _mm512_permutexvar_ps(_mm512_set1_epi32(15), v); }
+};
+
+struct f64x8 : index64x8 {
+  using T = double;
+  using vec = __m512d;
+  using mask = __mmask8;
+  static constexpr std::size_t lanes = 8;
+  static vec zero() { return _mm512_setzero_pd(); }
+  static vec load(const T* p) { return _mm512_loadu_pd(p); }
+  static vec load_partial(const T* p, std::size_t k) { return _mm512_maskz_loadu_pd(first_n8(k), p); }
+  static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+  static vec sub(vec a, vec b) { return _mm512_sub_pd(a, b); }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) {
+    return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(_mm512_abs_pd(a), _mm512_abs_pd(b), _CMP_GE_OQ), y, x);
+  }
+  static void store(T* p, vec v) { _mm512_storeu_pd(p, v); }
+  static vec splat(T x) { return _mm512_set1_pd(x); }
+  static vec mul_add(vec a, vec b, vec c) { return _mm512_fmadd_pd(a, b, c); }
+  static T mul_add(T a, T b, T c) { return __builtin_fma(a, b, c); }
+  static vec min(vec a, vec b) { return _mm512_min_pd(a, b); }
+  static vec max(vec a, vec b) { return _mm512_max_pd(a, b); }
+  static mask less(vec a, vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+  static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_pd(m, a, b); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm512_mask_blend_epi64(m, i, j); }
+};
+
+float sum_f32(const float* data, std::size_t n, fp_sum method) {
+  return sum_fp<f32x16>(data, n, method);
+}
+
+double sum_f64(const double* data, std::size_t n, fp_sum method) {
+  return sum_fp<f64x8>(data, n, method);
+}
+
+// Records of 4 doubles, two per register: register k holds record k in its low half and record
+// k + 4 in its high half, so the AVX2 4x4 transpose runs in both halves at once and each field
+// comes out as 8 consecutive elements. vpermt2pd stands in for vperm2f128, which has no 512-bit form.
+struct records4_f64 {
+  using T = double;
+  using vec = __m512d;
+  static constexpr std::size_t fields = 4, records = 8;
+  static vec load_records(const T* p) { return _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_loadu_pd(p)), _mm256_loadu_pd(p + 16), 1); }
+  static void store_records(T* p, vec v) {
+    _mm256_storeu_pd(p, _mm512_castpd512_pd256(v));
+    _mm256_storeu_pd(p + 16, _mm512_extractf64x4_pd(v, 1));
+  }
+  static vec load_plane(const T* p) { return _mm512_loadu_pd(p); }
+  static void store_plane(T* p, vec v) { _mm512_storeu_pd(p, v); }
+  static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+  static vec mul(vec a, vec b) { return _mm512_mul_pd(a, b); }
+  static void transpose(vec (&r)[4]) {
+    const __m512i lo = _mm512_setr_epi64(0, 1, 8, 9, 4, 5, 12, 13);
+    const __m512i hi = _mm512_setr_epi64(2, 3, 10, 11, 6, 7, 14, 15);
+    __m512d t0 = _mm512_unpacklo_pd(r[0], r[1]), t1 = _mm512_unpackhi_pd(r[0], r[1]);
+    __m512d t2 = _mm512_unpacklo_pd(r[2], r[3]), t3 = _mm512_unpackhi_pd(r[2], r[3]);
+    r[0] = _mm512_permutex2var_pd(t0, lo, t2);
+    r[1] = _mm512_permutex2var_pd(t1, lo, t3);
+    r[2] = _mm512_permutex2var_pd(t0, hi, t2);
+    r[3] = _mm512_permutex2var_pd(t1, hi, t3);
+  }
+};
+
+// Records of 8 floats, two per register (k and k + 8), with the AVX2 8x8 transpose in both halves.
+struct records8_f32 {
+  using T = float;
+  using vec = __m512;
+  static constexpr std::size_t fields = 8, records = 16;
+  static vec load_records(const T* p) { return _mm512_insertf32x8(_mm512_castps256_ps512(_mm256_loadu_ps(p)), _mm256_loadu_ps(p + 64), 1); }
+  static void store_records(T* p, vec v) {
+    _mm256_storeu_ps(p, _mm512_castps512_ps256(v));
+    _mm256_storeu_ps(p + 64, _mm512_extractf32x8_ps(v, 1));
+  }
+  static vec load_plane(const T* p) { return _mm512_loadu_ps(p); }
+  static void store_plane(T* p, vec v) { _mm512_storeu_ps(p, v); }
+  static void transpose(vec (&r)[8]) {
+    const __m512i lo = _mm512_setr_epi32(0, 1, 2, 3, 16, 17, 18, 19, 8, 9, 10, 11, 24, 25, 26, 27);
+    const __m512i hi = _mm512_setr_epi32(4, 5, 6, 7, 20, 21, 22, 23, 12, 13, 14, 15, 28, 29, 30, 31);
+    __m512 t0 = _mm512_unpacklo_ps(r[0], r[1]), t1 = _mm512_unpackhi_ps(r[0], r[1]);
+    __m512 t2 = _mm512_unpacklo_ps(r[2], r[3]), t3 = _mm512_unpackhi_ps(r[2], r[3]);
+    __m512 t4 = _mm512_unpacklo_ps(r[4], r[5]), t5 = _mm512_unpackhi_ps(r[4], r[5]);
+    __m512 t6 = _mm512_unpacklo_ps(r[6], r[7]), t7 = _mm512_unpackhi_ps(r[6], r[7]);
+    __m512 s0 = _mm512_shuffle_ps(t0, t2, 0x44), s1 = _mm512_shuffle_ps(t0, t2, 0xee);
+    __m512 s2 = _mm512_shuffle_ps(t1, t3, 0x44), s3 = _mm512_shuffle_ps(t1, t3, 0xee);
+    __m512 s4 = _mm512_shuffle_ps(t4, t6, 0x44), s5 = _mm512_shuffle_ps(t4, t6, 0xee);
+    __m512 s6 = _mm512_shuffle_ps(t5, t7, 0x44), s7 = _mm512_shuffle_ps(t5, t7, 0xee);
+    r[0] = _mm512_permutex2var_ps(s0, lo, s4);
+    r[1] = _mm512_permutex2var_ps(s1, lo, s5);
+    r[2] = _mm512_permutex2var_ps(s2, lo, s6);
+    r[3] = _mm512_permutex2var_ps(s3, lo, s7);
+    r[4] = _mm512_permutex2var_ps(s0, hi, s4);
+    r[5] = _mm512_permutex2var_ps(s1, hi, s5);
+    r[6] = _mm512_permutex2var_ps(s2, hi, s6);
+    r[7] = _mm512_permutex2var_ps(s3, hi, s7);
+  }
+};
+
+} // namespace
+
+std::ptrdiff_t find_i32_tail(const int32_t* data, std::size_t n, int32_t target, tail strategy) {
+  switch (strategy) {
+    case tail::masked: return find_from<tail::masked>(data, n, target, 0);
+    case tail::overlap: return find_from<tail::overlap>(data, n, target, 0);
+    default: return find_from<tail::scalar>(data, n, target, 0);
+  }
+}
+
+int32_t sum_i32_tail(const int32_t* data, std::size_t n, tail strategy) {
+  switch (strategy) {
+    case tail::masked: return sum<tail::masked>(data, n);
+    case tail::overlap: return sum<tail::overlap>(data, n);
+    default: return sum<tail::scalar>(data, n);
+  }
+}
+
+const kernel_table table = {isa::avx512, "avx512", add_f64, add_f64_stream, find_i32, find_i32_unrolled, find_all_i32, find_any_i32, find_u8, find_substr_u8, btree_lower_bound_i32, sum_i32, sum_i32_i64,
+                            reverse_in_place<u8x64>, reverse_in_place<u16x32>, reverse_i32, reverse_in_place<u64x8>,
+                            reverse_copy<u8x64>, reverse_copy<u16x32>, reverse_copy<i32x16>, reverse_copy<u64x8>, reverse_copy_stream<i32x16>,
+                            sum_f32, sum_f64, extreme<i32x16>, extreme<f32x16>, extreme<f64x8>,
+                            arg_extreme<i32x16>, arg_extreme<f32x16>, arg_extreme<f64x8>, prefix_sum<i32x16>, prefix_sum<f32x16>,
+                            axpy<f64x8>, multiply_add<f64x8>, triad<f64x8>,
+                            aos_to_soa<records4_f64>, soa_to_aos<records4_f64>, aos_to_soa<records8_f32>, soa_to_aos<records8_f32>,
+                            squared_norm_aos<records4_f64>, squared_norm_soa<records4_f64>};
+
+} // namespace kernels::avx512
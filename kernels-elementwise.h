@@ -0,0 +1,65 @@
+// Element-wise double kernels shared by the per-ISA kernel files.
+//
+// Like kernels-reduce.h, each kernels-<isa>.cpp includes this after its #pragma GCC target and
+// instantiates the templates with its own traits. A traits class V provides:
+//
+//   using T, vec;                     element and register
+//   static constexpr std::size_t lanes;
+//   load(p), store(p, v)              unaligned
+//   splat(x)
+//   mul_add(a, b, c)                  a * b + c, for registers and for single elements; one
+//                                     rounding on levels with FMA, two without
+
+#pragma once
+
+// Standard headers are deliberately not included here: they have to be parsed before the target
+// pragma. kernels.h brings in everything this needs.
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+// Two vectors per step: with one, the loop counter and branch cost as much as the loads and the
+// store when the arrays are in L1. The elements are independent, so nothing else needs hiding.
+template <class V>
+void axpy(double alpha, const double* x, double* y, std::size_t n) {
+  constexpr std::size_t L = V::lanes;
+  const auto va = V::splat(alpha);
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    V::store(&y[i], V::mul_add(va, V::load(&x[i]), V::load(&y[i])));
+    V::store(&y[i + L], V::mul_add(va, V::load(&x[i + L]), V::load(&y[i + L])));
+  }
+  for (; i < n; ++i)
+    y[i] = V::mul_add(alpha, x[i], y[i]);
+}
+
+template <class V>
+void multiply_add(const double* a, const double* x, const double* b, double* out, std::size_t n) {
+  constexpr std::size_t L = V::lanes;
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    V::store(&out[i], V::mul_add(V::load(&a[i]), V::load(&x[i]), V::load(&b[i])));
+    V::store(&out[i + L], V::mul_add(V::load(&a[i + L]), V::load(&x[i + L]), V::load(&b[i + L])));
+  }
+  for (; i < n; ++i)
+    out[i] = V::mul_add(a[i], x[i], b[i]);
+}
+
+template <class V>
+void triad(const double* b, const double* c, double q, double* out, std::size_t n) {
+  constexpr std::size_t L = V::lanes;
+  const auto vq = V::splat(q);
+  std::size_t i = 0;
+  for (; i + 2 * L <= n; i += 2 * L) {
+    V::store(&out[i], V::mul_add(vq, V::load(&c[i]), V::load(&b[i])));
+    V::store(&out[i + L], V::mul_add(vq, V::load(&c[i + L]), V::load(&b[i + L])));
+  }
+  for (; i < n; ++i)
+    out[i] = V::mul_add(q, c[i], b[i]);
+}
+
+} // namespace
+
+} // namespace kernels
@@ -0,0 +1,152 @@
+// Min/max and argmin/argmax algorithms shared by the per-ISA kernel files.
+//
+// Like kernels-reduce.h, each kernels-<isa>.cpp includes this after its #pragma GCC target and
+// instantiates the templates with its own traits, one per element type. A traits class M provides:
+//
+//   using T, vec, mask;               element, register and compare result
+//   using index, ivec;                index lane (uint32_t or uint64_t, as wide as T) and register
+//   static constexpr std::size_t lanes;
+//   load(p), store(p, v)              unaligned
+//   min(a, b), max(a, b)
+//   less(a, b)                        per lane a < b
+//   select(m, a, b)                   per lane m ? b : a
+//   select_index(m, i, j)             the same for index registers
+//   iota(), splat_index(k)            index lanes 0, 1, ..., lanes - 1, and k in every lane
+//   add_index(i, j), store_index(p, i)
+
+#pragma once
+
+// Standard headers are deliberately not included here: they have to be parsed before the target
+// pragma. kernels.h brings in everything this needs.
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+// a comes strictly before b in the order the kernel searches.
+template <bool Max, class T>
+bool beats(T a, T b) {
+  return Max ? b < a : a < b;
+}
+
+template <class M, bool Max>
+typename M::vec better(typename M::vec a, typename M::vec b) {
+  return Max ? M::max(a, b) : M::min(a, b);
+}
+
+// Four independent accumulators, as sum_plain. Min and max are idempotent, so the last n % lanes
+// elements come in as one more vector ending at data[n - 1].
+template <class M, bool Max>
+typename M::T reduce_extreme(const typename M::T* data, std::size_t n) {
+  using T = typename M::T;
+  constexpr std::size_t L = M::lanes;
+  if (n < L) {
+    T res = extremum_identity<T>(Max ? extremum::max : extremum::min);
+    for (std::size_t i = 0; i < n; ++i)
+      res = beats<Max>(data[i], res) ? data[i] : res;
+    return res;
+  }
+
+  auto r1 = M::load(data), r2 = r1, r3 = r1, r4 = r1;
+  std::size_t i = L;
+  for (; i + 4 * L <= n; i += 4 * L) {
+    r1 = better<M, Max>(r1, M::load(&data[i]));
+    r2 = better<M, Max>(r2, M::load(&data[i + L]));
+    r3 = better<M, Max>(r3, M::load(&data[i + 2 * L]));
+    r4 = better<M, Max>(r4, M::load(&data[i + 3 * L]));
+  }
+  for (; i + L <= n; i += L)
+    r1 = better<M, Max>(r1, M::load(&data[i]));
+  if (i < n) r2 = better<M, Max>(r2, M::load(&data[n - L]));
+
+  T t[L];
+  M::store(t, better<M, Max>(better<M, Max>(r1, r2), better<M, Max>(r3, r4)));
+  T res = t[0];
+  for (std::size_t j = 1; j < L; ++j)
+    res = beats<Max>(t[j], res) ? t[j] : res;
+  return res;
+}
+
+// One lane of best values and the index each came from. The compare is strict, so every lane keeps
+// the first of equal values it sees.
+template <class M, bool Max>
+void update_extreme(typename M::vec& best, typename M::ivec& at, typename M::vec x, typename M::ivec i) {
+  auto m = Max ? M::less(best, x) : M::less(x, best);
+  best = M::select(m, best, x);
+  at = M::select_index(m, at, i);
+}
+
+// Folds the lanes of an accumulator into the scalar result. offset is added to every index lane;
+// among equal values the smaller index wins, so the result is the first occurrence.
+template <class M, bool Max>
+void merge_extreme(typename M::vec best, typename M::ivec at, std::size_t offset, typename M::T& res, std::size_t& res_at) {
+  constexpr std::size_t L = M::lanes;
+  typename M::T t[L];
+  typename M::index k[L];
+  M::store(t, best);
+  M::store_index(k, at);
+  for (std::size_t j = 0; j < L; ++j) {
+    std::size_t i = k[j] + offset;
+    if (beats<Max>(t[j], res) || (t[j] == res && i < res_at)) {
+      res = t[j];
+      res_at = i;
+    }
+  }
+}
+
+// Four accumulators hide the compare-and-blend latency. They all share one index register: it holds
+// the indices of the first of the four vectors, and accumulator k adds k * lanes when it is merged,
+// so the loop needs a single index add per 4 * lanes elements.
+template <class M, bool Max>
+std::ptrdiff_t locate_extreme(const typename M::T* data, std::size_t n) {
+  using T = typename M::T;
+  constexpr std::size_t L = M::lanes;
+  if (n == 0) return -1;
+  T res = data[0];
+  std::size_t res_at = 0, i = 0;
+
+  if (n >= 4 * L) {
+    auto b1 = M::load(data), b2 = M::load(&data[L]), b3 = M::load(&data[2 * L]), b4 = M::load(&data[3 * L]);
+    auto base = M::iota();
+    auto a1 = base, a2 = base, a3 = base, a4 = base;
+    const auto step = M::splat_index(4 * L);
+    for (i = 4 * L; i + 4 * L <= n; i += 4 * L) {
+      base = M::add_index(base, step);
+      update_extreme<M, Max>(b1, a1, M::load(&data[i]), base);
+      update_extreme<M, Max>(b2, a2, M::load(&data[i + L]), base);
+      update_extreme<M, Max>(b3, a3, M::load(&data[i + 2 * L]), base);
+      update_extreme<M, Max>(b4, a4, M::load(&data[i + 3 * L]), base);
+    }
+    // The remaining whole vectors go to the first accumulator with their own indices.
+    for (; i + L <= n; i += L)
+      update_extreme<M, Max>(b1, a1, M::load(&data[i]), M::add_index(M::iota(), M::splat_index(i)));
+    merge_extreme<M, Max>(b1, a1, 0, res, res_at);
+    merge_extreme<M, Max>(b2, a2, L, res, res_at);
+    merge_extreme<M, Max>(b3, a3, 2 * L, res, res_at);
+    merge_extreme<M, Max>(b4, a4, 3 * L, res, res_at);
+  }
+
+  // Everything left comes after every index above, so only a strictly better value replaces it.
+  for (; i < n; ++i) {
+    if (beats<Max>(data[i], res)) {
+      res = data[i];
+      res_at = i;
+    }
+  }
+  return res_at;
+}
+
+template <class M>
+typename M::T extreme(const typename M::T* data, std::size_t n, extremum which) {
+  return which == extremum::max ? reduce_extreme<M, true>(data, n) : reduce_extreme<M, false>(data, n);
+}
+
+template <class M>
+std::ptrdiff_t arg_extreme(const typename M::T* data, std::size_t n, extremum which) {
+  return which == extremum::max ? locate_extreme<M, true>(data, n) : locate_extreme<M, false>(data, n);
+}
+
+} // namespace
+
+} // namespace kernels
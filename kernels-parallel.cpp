@@ -0,0 +1,168 @@
+// Thread pool and multi-threaded kernels for kernels-parallel.h.
+
+#include "kernels-parallel.h"
+#include "kernels.h"
+#include "kernels-scan.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace kernels {
+
+namespace {
+
+// Find hands out blocks of this many elements (16 KiB) so that threads can stop between blocks.
+constexpr std::size_t kFindBlock = 4096;
+
+// Chunk boundaries are rounded to whole cache lines so no two threads touch the same line.
+constexpr std::size_t kChunkGranularity = 64 / sizeof(int32_t);
+
+struct chunk {
+  std::size_t begin, end;
+};
+
+chunk chunk_of(std::size_t index, std::size_t chunks, std::size_t n) {
+  std::size_t per_chunk = (n / chunks + kChunkGranularity - 1) / kChunkGranularity * kChunkGranularity;
+  std::size_t begin = std::min(n, index * per_chunk);
+  std::size_t end = index + 1 == chunks ? n : std::min(n, begin + per_chunk);
+  return {begin, end};
+}
+
+// The two passes behind parallel_scan_*: sum(data, n) is the chunk total, scan the table entry.
+template <class T, class Sum, class Scan>
+void parallel_prefix_sum(thread_pool& pool, const T* in, T* out, std::size_t n, T init, prefix kind, Sum sum, Scan scan) {
+  struct alignas(64) partial { T value; };
+  std::vector<partial> partials(pool.size());
+
+  pool.run([&](std::size_t i) {
+    chunk c = chunk_of(i, pool.size(), n);
+    partials[i].value = sum(in + c.begin, c.end - c.begin);
+  });
+
+  // Exclusive scan of the chunk totals: where each chunk starts.
+  T offset = init;
+  for (partial& p : partials) {
+    T total = p.value;
+    p.value = offset;
+    offset = wrapping_add(offset, total);
+  }
+
+  pool.run([&](std::size_t i) {
+    chunk c = chunk_of(i, pool.size(), n);
+    scan(in + c.begin, out + c.begin, c.end - c.begin, partials[i].value, kind);
+  });
+}
+
+} // namespace
+
+thread_pool::thread_pool(std::size_t threads) {
+  for (std::size_t i = 1; i < std::max<std::size_t>(threads, 1); ++i)
+    workers_.emplace_back(&thread_pool::work, this, i);
+}
+
+thread_pool::~thread_pool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& worker : workers_)
+    worker.join();
+}
+
+void thread_pool::run(const std::function<void(std::size_t)>& task) {
+  if (!workers_.empty()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    pending_ = workers_.size();
+    ++generation_;
+  }
+  start_.notify_all();
+
+  task(0);
+
+  if (!workers_.empty()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+  }
+}
+
+void thread_pool::work(std::size_t index) {
+  uint64_t seen = 0;
+  for (;;) {
+    const std::function<void(std::size_t)>* task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+      task = task_;
+    }
+
+    (*task)(index);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) done_.notify_one();
+  }
+}
+
+int32_t parallel_sum_i32(thread_pool& pool, const int32_t* data, std::size_t n) {
+  // One partial per cache line so the threads do not false-share their results.
+  struct alignas(64) partial { int32_t value; };
+  std::vector<partial> partials(pool.size());
+  const kernel_table& table = active();
+
+  pool.run([&](std::size_t i) {
+    chunk c = chunk_of(i, pool.size(), n);
+    partials[i].value = table.sum_i32(data + c.begin, c.end - c.begin);
+  });
+
+  uint32_t res = 0;
+  for (const partial& p : partials)
+    res += p.value;
+  return res;
+}
+
+std::ptrdiff_t parallel_find_i32(thread_pool& pool, const int32_t* data, std::size_t n, int32_t target) {
+  std::size_t blocks = (n + kFindBlock - 1) / kFindBlock;
+  std::atomic<std::size_t> next_block{0};
+  std::atomic<std::size_t> first{n}; // lowest matching index so far, n while there is none
+  const kernel_table& table = active();
+
+  pool.run([&](std::size_t) {
+    for (;;) {
+      std::size_t b = next_block.fetch_add(1, std::memory_order_relaxed);
+      if (b >= blocks) return;
+
+      // Blocks are handed out in array order, so once a match before this block is known, this
+      // block and every later one can only hold later matches.
+      std::size_t begin = b * kFindBlock;
+      if (begin >= first.load(std::memory_order_relaxed)) return;
+
+      std::ptrdiff_t hit = table.find_i32_unrolled(data + begin, std::min(kFindBlock, n - begin), target);
+      if (hit >= 0) {
+        std::size_t index = begin + hit;
+        std::size_t current = first.load(std::memory_order_relaxed);
+        while (index < current && !first.compare_exchange_weak(current, index, std::memory_order_relaxed)) {}
+        return;
+      }
+    }
+  });
+
+  std::size_t res = first.load(std::memory_order_relaxed);
+  return res == n ? -1 : (std::ptrdiff_t) res;
+}
+
+void parallel_scan_i32(thread_pool& pool, const int32_t* in, int32_t* out, std::size_t n, int32_t init, prefix kind) {
+  const kernel_table& table = active();
+  parallel_prefix_sum(pool, in, out, n, init, kind, table.sum_i32, table.scan_i32);
+}
+
+void parallel_scan_f32(thread_pool& pool, const float* in, float* out, std::size_t n, float init, prefix kind) {
+  const kernel_table& table = active();
+  auto sum = [&](const float* data, std::size_t k) { return table.sum_f32(data, k, fp_sum::plain); };
+  parallel_prefix_sum(pool, in, out, n, init, kind, sum, table.scan_f32);
+}
+
+} // namespace kernels
@@ -0,0 +1,66 @@
+// Multi-threaded versions of the kernels.h scans and prefix sums.
+//
+// The array is split into chunks, every chunk runs the dispatched SIMD kernel, and the partial
+// results are combined on the calling thread. The pool is created once and reused so that a call
+// costs one wake-up per worker, not a thread creation.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "kernels.h"
+
+namespace kernels {
+
+class thread_pool {
+ public:
+  // threads counts the calling thread, so thread_pool(1) starts no workers and runs inline.
+  explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency());
+  ~thread_pool();
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  std::size_t size() const { return workers_.size() + 1; }
+
+  // Runs task(i) for every i in [0, size()), index 0 on the calling thread, and returns once all
+  // of them have finished.
+  void run(const std::function<void(std::size_t)>& task);
+
+ private:
+  void work(std::size_t index);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t)>* task_ = nullptr;
+  uint64_t generation_ = 0;
+  std::size_t pending_ = 0;
+  bool stop_ = false;
+};
+
+// Wrapping 32-bit sum, same result as sum_i32. One contiguous chunk per thread.
+int32_t parallel_sum_i32(thread_pool& pool, const int32_t* data, std::size_t n);
+
+// Index of the first element equal to target, or -1, same result as find_i32. The threads take
+// fixed-size blocks in array order and publish the lowest hit through a shared atomic; a thread
+// stops as soon as its next block starts past a known match, so a hit at position p costs about
+// p / threads elements per thread instead of a full scan of every chunk.
+std::ptrdiff_t parallel_find_i32(thread_pool& pool, const int32_t* data, std::size_t n, int32_t target);
+
+// Prefix sums with the same contract as scan_i32 and scan_f32, in two passes over one contiguous
+// chunk per thread: every thread sums its chunk, the calling thread turns the chunk totals into
+// starting offsets, then every thread scans its chunk from its offset. The input is read twice, so
+// this only beats the single-threaded kernel once one core can no longer keep up with memory (arrays
+// well past the last-level cache). The int32 result is identical; float rounds differently again.
+void parallel_scan_i32(thread_pool& pool, const int32_t* in, int32_t* out, std::size_t n, int32_t init, prefix kind);
+void parallel_scan_f32(thread_pool& pool, const float* in, float* out, std::size_t n, float init, prefix kind);
+
+} // namespace kernels
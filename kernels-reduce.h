@@ -0,0 +1,128 @@
+// Floating-point sum algorithms shared by the per-ISA kernel files.
+//
+// Each kernels-<isa>.cpp includes this after its #pragma GCC target and instantiates the templates
+// with its own vector traits, so every instantiation is compiled for that ISA only. A traits class
+// V provides:
+//
+//   using T, vec;                             float or double, and the register type
+//   static constexpr std::size_t lanes;
+//   zero(), load(p), load_partial(p, k)       load_partial reads k < lanes elements, rest are 0
+//   add(a, b), sub(a, b)
+//   pick_by_magnitude(a, b, x, y)             per lane |a| >= |b| ? x : y
+//   store(p, v)
+//
+// Nothing here relies on reassociation, so the files must not be built with -ffast-math.
+
+#pragma once
+
+// Standard headers are deliberately not included here: they have to be parsed before the target
+// pragma. kernels.h brings in everything this needs.
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+// Lanes are folded in halves (0+4, 1+5, ... then 0+2, 1+3, ...), which is itself pairwise.
+template <class V>
+typename V::T horizontal_sum(typename V::vec v) {
+  typename V::T t[V::lanes];
+  V::store(t, v);
+  for (std::size_t width = V::lanes / 2; width > 0; width /= 2) {
+    for (std::size_t j = 0; j < width; ++j)
+      t[j] += t[j + width];
+  }
+  return t[0];
+}
+
+// Four independent accumulators, so each lane adds every 4 * lanes-th element.
+template <class V>
+typename V::T sum_plain(const typename V::T* data, std::size_t n) {
+  constexpr std::size_t L = V::lanes;
+  auto s1 = V::zero(), s2 = V::zero(), s3 = V::zero(), s4 = V::zero();
+  std::size_t i = 0;
+
+  for (; i + 4 * L <= n; i += 4 * L) {
+    s1 = V::add(s1, V::load(&data[i]));
+    s2 = V::add(s2, V::load(&data[i + L]));
+    s3 = V::add(s3, V::load(&data[i + 2 * L]));
+    s4 = V::add(s4, V::load(&data[i + 3 * L]));
+  }
+  for (; i + L <= n; i += L)
+    s1 = V::add(s1, V::load(&data[i]));
+  if (i < n) s2 = V::add(s2, V::load_partial(&data[i], n - i));
+
+  return horizontal_sum<V>(V::add(V::add(s1, s2), V::add(s3, s4)));
+}
+
+// Splits in halves (on whole vectors) down to blocks small enough for sum_plain, so the rounding
+// error grows with log(n) instead of n at nearly the plain throughput.
+template <class V>
+typename V::T sum_pairwise(const typename V::T* data, std::size_t n) {
+  constexpr std::size_t block = 32 * V::lanes;
+  if (n <= block) return sum_plain<V>(data, n);
+  std::size_t half = n / 2 / V::lanes * V::lanes;
+  return sum_pairwise<V>(data, half) + sum_pairwise<V>(data + half, n - half);
+}
+
+template <class T>
+T magnitude(T x) {
+  return x < 0 ? -x : x;
+}
+
+// Neumaier's variant of Kahan summation: the compensation takes the rounding error of whichever
+// operand is smaller, so it also holds when an element is larger than the running sum.
+template <class V>
+void neumaier_step(typename V::vec& s, typename V::vec& c, typename V::vec x) {
+  auto t = V::add(s, x);
+  auto lost = V::pick_by_magnitude(s, x, V::add(V::sub(s, t), x), V::add(V::sub(x, t), s));
+  c = V::add(c, lost);
+  s = t;
+}
+
+template <class V>
+typename V::T sum_compensated(const typename V::T* data, std::size_t n) {
+  using T = typename V::T;
+  constexpr std::size_t L = V::lanes;
+  auto s1 = V::zero(), c1 = V::zero(), s2 = V::zero(), c2 = V::zero();
+  std::size_t i = 0;
+
+  // Two independent sum/compensation pairs hide part of the add latency chain.
+  for (; i + 2 * L <= n; i += 2 * L) {
+    neumaier_step<V>(s1, c1, V::load(&data[i]));
+    neumaier_step<V>(s2, c2, V::load(&data[i + L]));
+  }
+  if (i + L <= n) {
+    neumaier_step<V>(s1, c1, V::load(&data[i]));
+    i += L;
+  }
+  if (i < n) neumaier_step<V>(s2, c2, V::load_partial(&data[i], n - i));
+
+  // Fold the lanes with the same scalar algorithm, then add all compensations at once.
+  T s[2 * L], c[2 * L];
+  V::store(s, s1);
+  V::store(s + L, s2);
+  V::store(c, c1);
+  V::store(c + L, c2);
+  T sum = 0, comp = 0;
+  for (std::size_t j = 0; j < 2 * L; ++j) {
+    T t = sum + s[j];
+    comp += magnitude(sum) >= magnitude(s[j]) ? (sum - t) + s[j] : (s[j] - t) + sum;
+    sum = t;
+    comp += c[j];
+  }
+  return sum + comp;
+}
+
+template <class V>
+typename V::T sum_fp(const typename V::T* data, std::size_t n, fp_sum method) {
+  switch (method) {
+    case fp_sum::pairwise: return sum_pairwise<V>(data, n);
+    case fp_sum::compensated: return sum_compensated<V>(data, n);
+    default: return sum_plain<V>(data, n);
+  }
+}
+
+} // namespace
+
+} // namespace kernels
@@ -0,0 +1,91 @@
+// Element-width-generic reverse algorithms shared by the per-ISA kernel files.
+//
+// Like kernels-reduce.h, each kernels-<isa>.cpp includes this after its #pragma GCC target and
+// instantiates the templates with its own traits, one per element width. A traits class R provides:
+//
+//   using T, vec;                    element and register type
+//   static constexpr std::size_t lanes;
+//   load(p), store(p, v)             unaligned
+//   reverse(v)                       lane order reversed
+//   stream(p, v), fence()            non-temporal store to a vector-aligned p, and sfence
+//                                    (only for reverse_copy_stream)
+
+#pragma once
+
+// Standard headers are deliberately not included here: they have to be parsed before the target
+// pragma. kernels.h brings in everything this needs.
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+template <class R>
+void reverse_in_place(typename R::T* data, std::size_t n) {
+  constexpr std::size_t L = R::lanes;
+  std::size_t lo = 0, hi = n;
+
+  // Swap whole vectors from both ends while they do not overlap.
+  for (; hi - lo >= 2 * L; lo += L, hi -= L) {
+    auto x = R::load(&data[lo]);
+    auto y = R::load(&data[hi - L]);
+    R::store(&data[lo], R::reverse(y));
+    R::store(&data[hi - L], R::reverse(x));
+  }
+
+  // Between L and 2L - 1 elements left: the same swap with overlapping vectors. Both are loaded
+  // before either store, and the overlapped lanes receive the same value from both stores.
+  if (hi - lo >= L) {
+    auto x = R::load(&data[lo]);
+    auto y = R::load(&data[hi - L]);
+    R::store(&data[lo], R::reverse(y));
+    R::store(&data[hi - L], R::reverse(x));
+    return;
+  }
+
+  for (; hi - lo >= 2; ++lo, --hi) {
+    typename R::T t = data[lo];
+    data[lo] = data[hi - 1];
+    data[hi - 1] = t;
+  }
+}
+
+// out[i] = in[n - 1 - i]; in and out must not overlap.
+template <class R>
+void reverse_copy(const typename R::T* in, typename R::T* out, std::size_t n) {
+  constexpr std::size_t L = R::lanes;
+  std::size_t i = 0;
+
+  for (; i + L <= n; i += L)
+    R::store(&out[i], R::reverse(R::load(&in[n - i - L])));
+  if (i == n) return;
+
+  // The last n % L outputs: one vector ending at out[n - 1], rewriting some finished lanes.
+  if (n >= L) {
+    R::store(&out[n - L], R::reverse(R::load(&in[0])));
+    return;
+  }
+  for (; i < n; ++i)
+    out[i] = in[n - 1 - i];
+}
+
+// reverse_copy with non-temporal stores. Those need a vector-aligned destination, so the outputs
+// before the first aligned address and after the last whole vector are written one by one.
+template <class R>
+void reverse_copy_stream(const typename R::T* in, typename R::T* out, std::size_t n) {
+  using T = typename R::T;
+  constexpr std::size_t L = R::lanes;
+  std::size_t i = 0;
+
+  for (; i < n && reinterpret_cast<uintptr_t>(&out[i]) % (L * sizeof(T)) != 0; ++i)
+    out[i] = in[n - 1 - i];
+  for (; i + L <= n; i += L)
+    R::stream(&out[i], R::reverse(R::load(&in[n - i - L])));
+  for (; i < n; ++i)
+    out[i] = in[n - 1 - i];
+  R::fence();
+}
+
+} // namespace
+
+} // namespace kernels
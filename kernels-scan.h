@@ -0,0 +1,68 @@
+// Prefix-sum algorithm shared by the per-ISA kernel files.
+//
+// Like kernels-reduce.h, each kernels-<isa>.cpp includes this after its #pragma GCC target and
+// instantiates the template with its own traits. A traits class V provides:
+//
+//   using T, vec;                     element and register
+//   static constexpr std::size_t lanes;
+//   load(p), store(p, v)              unaligned
+//   add(a, b), splat(x)
+//   scan(v)                           inclusive prefix sum across the lanes of one register
+//   shift_up(v)                       lane j takes lane j - 1, lane 0 becomes 0
+//   broadcast_last(v)                 lane lanes - 1 in every lane
+
+#pragma once
+
+// Standard headers are deliberately not included here: they have to be parsed before the target
+// pragma. kernels.h brings in everything this needs.
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+// The int32 scans wrap like sum_i32, so scalar steps add in the unsigned type.
+template <class T>
+T wrapping_add(T a, T b) {
+  if constexpr (std::is_integral_v<T>) return T(std::make_unsigned_t<T>(a) + std::make_unsigned_t<T>(b));
+  else return a + b;
+}
+
+// The carry holds the running total in every lane. It only depends on the previous carry and the
+// last lane of the current vector's own scan, so consecutive vectors overlap and the loop-carried
+// chain is a single add; the scan and the offsetting of every vector are off that chain.
+template <class V>
+void prefix_sum(const typename V::T* in, typename V::T* out, std::size_t n, typename V::T init, prefix kind) {
+  using T = typename V::T;
+  constexpr std::size_t L = V::lanes;
+  auto carry = V::splat(init);
+  std::size_t i = 0;
+
+  if (kind == prefix::inclusive) {
+    for (; i + L <= n; i += L) {
+      auto p = V::scan(V::load(&in[i]));
+      V::store(&out[i], V::add(p, carry));
+      carry = V::add(carry, V::broadcast_last(p));
+    }
+  } else {
+    for (; i + L <= n; i += L) {
+      auto p = V::scan(V::load(&in[i]));
+      V::store(&out[i], V::add(V::shift_up(p), carry));
+      carry = V::add(carry, V::broadcast_last(p));
+    }
+  }
+
+  T t[L];
+  V::store(t, carry);
+  T acc = t[0];
+  for (; i < n; ++i) {
+    T x = in[i];
+    if (kind == prefix::exclusive) out[i] = acc;
+    acc = wrapping_add(acc, x);
+    if (kind == prefix::inclusive) out[i] = acc;
+  }
+}
+
+} // namespace
+
+} // namespace kernels
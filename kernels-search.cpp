@@ -0,0 +1,72 @@
+// Sorted-array search and search-tree layouts for kernels-search.h.
+
+#include "kernels-search.h"
+
+#include <climits>
+
+namespace kernels {
+
+namespace {
+
+// In-order walk of the implicit tree, handing out the sorted keys one by one.
+void fill_eytzinger(const int32_t* sorted, std::size_t n, int32_t* tree, std::size_t k, std::size_t& next) {
+  if (k > n) return;
+  fill_eytzinger(sorted, n, tree, 2 * k, next);
+  tree[k] = sorted[next++];
+  fill_eytzinger(sorted, n, tree, 2 * k + 1, next);
+}
+
+void fill_btree(const int32_t* sorted, std::size_t n, int32_t* tree, std::size_t nodes, std::size_t k, std::size_t& next) {
+  if (k >= nodes) return;
+  for (std::size_t i = 0; i < btree_node; ++i) {
+    fill_btree(sorted, n, tree, nodes, k * (btree_node + 1) + i + 1, next);
+    tree[k * btree_node + i] = next < n ? sorted[next++] : INT32_MAX;
+  }
+  fill_btree(sorted, n, tree, nodes, k * (btree_node + 1) + btree_node + 1, next);
+}
+
+} // namespace
+
+// The range shrinks to ceil(len / 2) every step whatever the comparison says, so the loop count
+// only depends on n, and the comparison is used as a number (GCC turns a ?: here into a branch).
+// Without a branch there is no speculation into the next level either, so both of its possible
+// probes are prefetched; the last step has no next level, and len / 2 - 1 would wrap there.
+std::size_t lower_bound_branchless(const int32_t* data, std::size_t n, int32_t x) {
+  if (n == 0) return 0;
+  const int32_t* base = data;
+  for (std::size_t len = n; len > 1;) {
+    std::size_t half = len / 2;
+    len -= half;
+    if (len > 1) {
+      __builtin_prefetch(&base[len / 2 - 1]);
+      __builtin_prefetch(&base[half + len / 2 - 1]);
+    }
+    base += (base[half - 1] < x) * half;
+  }
+  return (base - data) + (*base < x);
+}
+
+void to_eytzinger(const int32_t* sorted, std::size_t n, int32_t* tree) {
+  std::size_t next = 0;
+  tree[0] = 0;
+  fill_eytzinger(sorted, n, tree, 1, next);
+}
+
+// Slots 16k ... 16k + 15 are the descendants of k four levels down, one cache line of an aligned
+// tree, so prefetching it hides most of the latency of the levels below. The search always runs
+// to a leaf; the last right turn (the trailing ones of k, plus one) marks the answer.
+std::size_t eytzinger_lower_bound(const int32_t* tree, std::size_t n, int32_t x) {
+  std::size_t k = 1;
+  while (k <= n) {
+    __builtin_prefetch(tree + k * 16);
+    k = 2 * k + (tree[k] < x);
+  }
+  return k >> __builtin_ffsll(~k);
+}
+
+void to_btree(const int32_t* sorted, std::size_t n, int32_t* tree) {
+  std::size_t next = 0;
+  fill_btree(sorted, n, tree, btree_size(n) / btree_node, 0, next);
+}
+
+} // namespace kernels
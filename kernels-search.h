@@ -0,0 +1,45 @@
+// Search over sorted int32 keys.
+//
+// Three ways to find the first key >= x, from least to most preparation:
+//
+//   lower_bound_branchless   the sorted array itself, binary search with a conditional move per step
+//   eytzinger_lower_bound    the keys in breadth-first order, so the next four levels of the search
+//                            share one cache line and can be prefetched
+//   btree_lower_bound_i32    (kernels.h) a 17-ary tree of 16-key nodes, one SIMD compare per node
+//
+// The two layouts are built once from the sorted array by to_eytzinger() and to_btree(). Both
+// expect a 64-byte aligned destination, so that a prefetched block or a node is one cache line.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kernels.h"
+
+namespace kernels {
+
+// Same result as std::lower_bound: the index of the first key >= x, or n.
+std::size_t lower_bound_branchless(const int32_t* data, std::size_t n, int32_t x);
+
+// Slots a to_eytzinger() layout of n keys needs: slot 0 is unused, the children of slot k are
+// 2k and 2k + 1.
+inline std::size_t eytzinger_size(std::size_t n) {
+  return n + 1;
+}
+
+void to_eytzinger(const int32_t* sorted, std::size_t n, int32_t* tree);
+
+// Slot in a to_eytzinger() layout of n keys holding the first key >= x, or 0 if there is none.
+std::size_t eytzinger_lower_bound(const int32_t* tree, std::size_t n, int32_t x);
+
+// Slots a to_btree() layout of n keys needs: n rounded up to whole nodes.
+inline std::size_t btree_size(std::size_t n) {
+  return (n + btree_node - 1) / btree_node * btree_node;
+}
+
+// Node k holds 16 keys in order and has children 17k + 1 ... 17k + 17, child i covering the keys
+// between its separators i - 1 and i. The last node is padded with INT32_MAX.
+void to_btree(const int32_t* sorted, std::size_t n, int32_t* tree);
+
+} // namespace kernels
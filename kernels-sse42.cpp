@@ -0,0 +1,469 @@
+// SSE4.2 (128-bit) kernels for kernels.h.
+
+#include "kernels.h"
+
+#include <cstring>
+#include <immintrin.h>
+
+// Only the code below this line may use SSE4.2, the standard headers above stay baseline x86-64.
+#pragma GCC target("sse4.2,popcnt")
+
+#include "kernels-elementwise.h"
+#include "kernels-extrema.h"
+#include "kernels-reduce.h"
+#include "kernels-reverse.h"
+#include "kernels-scan.h"
+#include "kernels-transpose.h"
+
+namespace kernels::sse42 {
+
+namespace {
+
+void add_f64(const double* a, const double* b, double* out, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(&a[i]);
+    __m128d y = _mm_loadu_pd(&b[i]);
+    _mm_storeu_pd(&out[i], _mm_add_pd(x, y));
+  }
+  for (; i < n; ++i)
+    out[i] = a[i] + b[i];
+}
+
+// Non-temporal stores need a 16-byte aligned destination: scalar adds up to the first aligned
+// element, streaming stores for the body, scalar adds for the tail, then sfence.
+void add_f64_stream(const double* a, const double* b, double* out, std::size_t n) {
+  std::size_t i = 0;
+  for (; i < n && reinterpret_cast<uintptr_t>(&out[i]) % 16 != 0; ++i)
+    out[i] = a[i] + b[i];
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(&a[i]);
+    __m128d y = _mm_loadu_pd(&b[i]);
+    _mm_stream_pd(&out[i], _mm_add_pd(x, y));
+  }
+  for (; i < n; ++i)
+    out[i] = a[i] + b[i];
+  _mm_sfence();
+}
+
+std::ptrdiff_t find_i32(const int32_t* data, std::size_t n, int32_t target) {
+  __m128i x = _mm_set1_epi32(target);
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i y = _mm_loadu_si128((const __m128i*) &data[i]);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, y)));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  for (; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_i32_unrolled(const int32_t* data, std::size_t n, int32_t target) {
+  __m128i x = _mm_set1_epi32(target);
+  std::size_t i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i m1 = _mm_cmpeq_epi32(x, _mm_loadu_si128((const __m128i*) &data[i]));
+    __m128i m2 = _mm_cmpeq_epi32(x, _mm_loadu_si128((const __m128i*) &data[i + 4]));
+    __m128i m3 = _mm_cmpeq_epi32(x, _mm_loadu_si128((const __m128i*) &data[i + 8]));
+    __m128i m4 = _mm_cmpeq_epi32(x, _mm_loadu_si128((const __m128i*) &data[i + 12]));
+    __m128i m = _mm_or_si128(_mm_or_si128(m1, m2), _mm_or_si128(m3, m4));
+    if (!_mm_testz_si128(m, m)) {
+      // Pack the four 4-bit masks into one 16-bit mask so a single ctz finds the first hit.
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(m1))
+               | _mm_movemask_ps(_mm_castsi128_ps(m2)) << 4
+               | _mm_movemask_ps(_mm_castsi128_ps(m3)) << 8
+               | _mm_movemask_ps(_mm_castsi128_ps(m4)) << 12;
+      return i + __builtin_ctz(mask);
+    }
+  }
+  std::ptrdiff_t res = find_i32(&data[i], n - i, target);
+  return res < 0 ? res : res + i;
+}
+
+// Compares every vector against K broadcast keys, K a power of two covering keys.size (the padded
+// keys repeat the first one, which does not change the result).
+template <int K>
+std::ptrdiff_t find_any_broadcast(const int32_t* data, std::size_t n, const key_set& keys) {
+  __m128i x[K];
+  for (int j = 0; j < K; ++j) x[j] = _mm_set1_epi32(keys.padded[j]);
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i y = _mm_loadu_si128((const __m128i*) &data[i]);
+    __m128i m = _mm_cmpeq_epi32(x[0], y);
+    for (int j = 1; j < K; ++j) m = _mm_or_si128(m, _mm_cmpeq_epi32(x[j], y));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(m));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  for (; i < n; ++i) {
+    if (contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+// Without a variable permute there is no vector bitmap lookup, and comparing against every key
+// falls behind the scalar filter beyond about 8 keys, so larger sets use that.
+std::ptrdiff_t find_any_filter(const int32_t* data, std::size_t n, const key_set& keys) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (maybe_contains(keys, data[i]) && contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_any_i32(const int32_t* data, std::size_t n, const key_set& keys) {
+  if (keys.size == 0) return -1;
+  if (keys.size == 1) return find_any_broadcast<1>(data, n, keys);
+  if (keys.size == 2) return find_any_broadcast<2>(data, n, keys);
+  if (keys.size <= 4) return find_any_broadcast<4>(data, n, keys);
+  if (keys.size <= 8) return find_any_broadcast<8>(data, n, keys);
+  return find_any_filter(data, n, keys);
+}
+
+std::ptrdiff_t find_u8(const uint8_t* data, std::size_t n, uint8_t target) {
+  __m128i x = _mm_set1_epi8(target);
+  std::size_t i = 0;
+
+  for (; i + 64 <= n; i += 64) {
+    __m128i m1 = _mm_cmpeq_epi8(x, _mm_loadu_si128((const __m128i*) &data[i]));
+    __m128i m2 = _mm_cmpeq_epi8(x, _mm_loadu_si128((const __m128i*) &data[i + 16]));
+    __m128i m3 = _mm_cmpeq_epi8(x, _mm_loadu_si128((const __m128i*) &data[i + 32]));
+    __m128i m4 = _mm_cmpeq_epi8(x, _mm_loadu_si128((const __m128i*) &data[i + 48]));
+    __m128i m = _mm_or_si128(_mm_or_si128(m1, m2), _mm_or_si128(m3, m4));
+    if (!_mm_testz_si128(m, m)) {
+      uint64_t mask = (uint64_t) _mm_movemask_epi8(m1)
+                    | (uint64_t) _mm_movemask_epi8(m2) << 16
+                    | (uint64_t) _mm_movemask_epi8(m3) << 32
+                    | (uint64_t) _mm_movemask_epi8(m4) << 48;
+      return i + __builtin_ctzll(mask);
+    }
+  }
+  for (; i + 16 <= n; i += 16) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_loadu_si128((const __m128i*) &data[i])));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  for (; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches m - 1
+// bytes further on, two loads that far apart; only those are compared in full. Needle bytes that
+// are rare in the text make candidates rare.
+std::ptrdiff_t find_substr_u8(const uint8_t* data, std::size_t n, const uint8_t* needle, std::size_t m) {
+  if (m == 0) return 0;
+  if (m == 1) return find_u8(data, n, needle[0]);
+  __m128i first = _mm_set1_epi8(needle[0]);
+  __m128i last = _mm_set1_epi8(needle[m - 1]);
+  std::size_t i = 0;
+
+  for (; i + m - 1 + 16 <= n; i += 16) {
+    __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i*) &data[i])),
+                                _mm_cmpeq_epi8(last, _mm_loadu_si128((const __m128i*) &data[i + m - 1])));
+    for (uint32_t mask = _mm_movemask_epi8(hit); mask != 0; mask &= mask - 1) {
+      std::size_t j = i + __builtin_ctz(mask);
+      if (std::memcmp(&data[j + 1], needle + 1, m - 2) == 0) return j;
+    }
+  }
+  for (; i + m <= n; ++i) {
+    if (data[i] == needle[0] && std::memcmp(&data[i + 1], needle + 1, m - 1) == 0) return i;
+  }
+  return -1;
+}
+
+// Row m is a pshufb control that moves the 32-bit lanes selected by the 4-bit mask m to the front.
+struct compress_lut {
+  uint8_t rows[16][16];
+  constexpr compress_lut() : rows() {
+    for (int m = 0; m < 16; ++m) {
+      int k = 0;
+      for (int j = 0; j < 4; ++j) {
+        if (m >> j & 1) {
+          for (int b = 0; b < 4; ++b) rows[m][4 * k + b] = 4 * j + b;
+          ++k;
+        }
+      }
+    }
+  }
+};
+constexpr compress_lut kCompress;
+
+// Every step stores a whole vector of indices and advances by the number of matches. The count
+// never exceeds i, so the full-width store stays inside out[0, n).
+std::size_t find_all_i32(const int32_t* data, std::size_t n, int32_t target, uint32_t* out) {
+  __m128i x = _mm_set1_epi32(target);
+  __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+  std::size_t count = 0, i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i y = _mm_loadu_si128((const __m128i*) &data[i]);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, y)));
+    __m128i selected = _mm_shuffle_epi8(index, _mm_loadu_si128((const __m128i*) kCompress.rows[mask]));
+    _mm_storeu_si128((__m128i*) &out[count], selected);
+    count += _mm_popcnt_u32(mask);
+    index = _mm_add_epi32(index, _mm_set1_epi32(4));
+  }
+  for (; i < n; ++i) {
+    out[count] = i;
+    count += data[i] == target;
+  }
+  return count;
+}
+
+// Keys below x in a node, from four compares packed down to one byte per key.
+std::size_t btree_lower_bound_i32(const int32_t* tree, std::size_t size, int32_t x) {
+  __m128i y = _mm_set1_epi32(x);
+  std::size_t nodes = size / btree_node, res = size;
+  for (std::size_t k = 0; k < nodes;) {
+    const __m128i* node = (const __m128i*) &tree[k * btree_node];
+    __m128i lo = _mm_packs_epi32(_mm_cmpgt_epi32(y, _mm_loadu_si128(node)), _mm_cmpgt_epi32(y, _mm_loadu_si128(node + 1)));
+    __m128i hi = _mm_packs_epi32(_mm_cmpgt_epi32(y, _mm_loadu_si128(node + 2)), _mm_cmpgt_epi32(y, _mm_loadu_si128(node + 3)));
+    std::size_t i = __builtin_popcount(_mm_movemask_epi8(_mm_packs_epi16(lo, hi)));
+    if (i < btree_node) res = k * btree_node + i;
+    k = k * (btree_node + 1) + i + 1;
+  }
+  return res;
+}
+
+int32_t sum_i32(const int32_t* data, std::size_t n) {
+  __m128i s1 = _mm_setzero_si128();
+  __m128i s2 = _mm_setzero_si128();
+  std::size_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    s1 = _mm_add_epi32(s1, _mm_loadu_si128((const __m128i*) &data[i]));
+    s2 = _mm_add_epi32(s2, _mm_loadu_si128((const __m128i*) &data[i + 4]));
+  }
+
+  __m128i s = _mm_add_epi32(s1, s2);
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+  uint32_t res = _mm_cvtsi128_si32(s);
+
+  for (; i < n; ++i)
+    res += data[i];
+  return res;
+}
+
+// pmovsxdq widens two int32 to two int64 per instruction, so each 4-element load feeds two
+// 64-bit accumulators.
+int64_t sum_i32_i64(const int32_t* data, std::size_t n) {
+  __m128i s1 = _mm_setzero_si128();
+  __m128i s2 = _mm_setzero_si128();
+  std::size_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*) &data[i]);
+    s1 = _mm_add_epi64(s1, _mm_cvtepi32_epi64(x));
+    s2 = _mm_add_epi64(s2, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(x, x)));
+  }
+
+  __m128i s = _mm_add_epi64(s1, s2);
+  int64_t res = _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+
+  for (; i < n; ++i)
+    res += data[i];
+  return res;
+}
+
+// Index registers for kernels-extrema.h, one lane per element.
+struct index32x4 {
+  using index = uint32_t;
+  using ivec = __m128i;
+  static ivec iota() { return _mm_setr_epi32(0, 1, 2, 3); }
+  static ivec splat_index(index k) { return _mm_set1_epi32(k); }
+  static ivec add_index(ivec i, ivec j) { return _mm_add_epi32(i, j); }
+  static void store_index(index* p, ivec i) { _mm_storeu_si128((__m128i*) p, i); }
+};
+
+struct index64x2 {
+  using index = uint64_t;
+  using ivec = __m128i;
+  static ivec iota() { return _mm_set_epi64x(1, 0); }
+  static ivec splat_index(index k) { return _mm_set1_epi64x(k); }
+  static ivec add_index(ivec i, ivec j) { return _mm_add_epi64(i, j); }
+  static void store_index(index* p, ivec i) { _mm_storeu_si128((__m128i*) p, i); }
+};
+
+// Reverse traits for kernels-reverse.h: one shuffle reverses a whole register at every width.
+struct v128 {
+  using vec = __m128i;
+  static vec load(const void* p) { return _mm_loadu_si128((const __m128i*) p); }
+  static void store(void* p, vec v) { _mm_storeu_si128((__m128i*) p, v); }
+  static void stream(void* p, vec v) { _mm_stream_si128((__m128i*) p, v); }
+  static void fence() { _mm_sfence(); }
+};
+
+struct u8x16 : v128 {
+  using T = uint8_t;
+  static constexpr std::size_t lanes = 16;
+  static vec reverse(vec v) { return _mm_shuffle_epi8(v, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)); }
+};
+
+struct u16x8 : v128 {
+  using T = uint16_t;
+  static constexpr std::size_t lanes = 8;
+  static vec reverse(vec v) { return _mm_shuffle_epi8(v, _mm_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)); }
+};
+
+struct i32x4 : v128, index32x4 {
+  using T = int32_t;
+  using mask = __m128i;
+  static constexpr std::size_t lanes = 4;
+  static vec reverse(vec v) { return _mm_shuffle_epi32(v, 0x1b); }
+  static vec min(vec a, vec b) { return _mm_min_epi32(a, b); }
+  static vec max(vec a, vec b) { return _mm_max_epi32(a, b); }
+  static mask less(vec a, vec b) { return _mm_cmplt_epi32(a, b); }
+  static vec select(mask m, vec a, vec b) { return _mm_blendv_epi8(a, b, m); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm_blendv_epi8(i, j, m); }
+  static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+  static vec splat(T x) { return _mm_set1_epi32(x); }
+  static vec scan(vec v) {
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    return _mm_add_epi32(v, _mm_slli_si128(v, 8));
+  }
+  static vec shift_up(vec v) { return _mm_slli_si128(v, 4); }
+  static vec broadcast_last(vec v) { return _mm_shuffle_epi32(v, 0xff); }
+};
+
+struct u64x2 : v128 {
+  using T = uint64_t;
+  static constexpr std::size_t lanes = 2;
+  static vec reverse(vec v) { return _mm_shuffle_epi32(v, 0x4e); }
+};
+
+// No masked loads before AVX: the partial vector goes through a zeroed stack buffer.
+struct f32x4 : index32x4 {
+  using T = float;
+  using vec = __m128;
+  using mask = __m128;
+  static constexpr std::size_t lanes = 4;
+  static vec zero() { return _mm_setzero_ps(); }
+  static vec load(const T* p) { return _mm_loadu_ps(p); }
+  static vec load_partial(const T* p, std::size_t k) {
+    T t[lanes] = {};
+    for (std::size_t j = 0; j < k; ++j) t[j] = p[j];
+    return _mm_loadu_ps(t);
+  }
+  static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+  static vec abs(vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) { return _mm_blendv_ps(y, x, _mm_cmpge_ps(abs(a), abs(b))); }
+  static void store(T* p, vec v) { _mm_storeu_ps(p, v); }
+  static vec min(vec a, vec b) { return _mm_min_ps(a, b); }
+  static vec max(vec a, vec b) { return _mm_max_ps(a, b); }
+  static mask less(vec a, vec b) { return _mm_cmplt_ps(a, b); }
+  static vec select(mask m, vec a, vec b) { return _mm_blendv_ps(a, b, m); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(i), _mm_castsi128_ps(j), m)); }
+  static vec splat(T x) { return _mm_set1_ps(x); }
+  static vec scan(vec v) {
+    v = _mm_add_ps(v, shift_up(v));
+    return _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+  }
+  static vec shift_up(vec v) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)); }
+  static vec broadcast_last(vec v) { return _mm_shuffle_ps(v, v, 0xff); }
+};
+
+struct f64x2 : index64x2 {
+  using T = double;
+  using vec = __m128d;
+  using mask = __m128d;
+  static constexpr std::size_t lanes = 2;
+  static vec zero() { return _mm_setzero_pd(); }
+  static vec load(const T* p) { return _mm_loadu_pd(p); }
+  static vec load_partial(const T* p, std::size_t) { return _mm_load_sd(p); } // k is always 1
+  static vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+  static vec sub(vec a, vec b) { return _mm_sub_pd(a, b); }
+  static vec abs(vec a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) { return _mm_blendv_pd(y, x, _mm_cmpge_pd(abs(a), abs(b))); }
+  static void store(T* p, vec v) { _mm_storeu_pd(p, v); }
+  static vec splat(T x) { return _mm_set1_pd(x); }
+  // No FMA at this level.
+  static vec mul_add(vec a, vec b, vec c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+  static T mul_add(T a, T b, T c) { return a * b + c; }
+  static vec min(vec a, vec b) { return _mm_min_pd(a, b); }
+  static vec max(vec a, vec b) { return _mm_max_pd(a, b); }
+  static mask less(vec a, vec b) { return _mm_cmplt_pd(a, b); }
+  static vec select(mask m, vec a, vec b) { return _mm_blendv_pd(a, b, m); }
+  static ivec select_index(mask m, ivec i, ivec j) { return _mm_castpd_si128(_mm_blendv_pd(_mm_castsi128_pd(i), _mm_castsi128_pd(j), m)); }
+};
+
+float sum_f32(const float* data, std::size_t n, fp_sum method) {
+  return sum_fp<f32x4>(data, n, method);
+}
+
+double sum_f64(const double* data, std::size_t n, fp_sum method) {
+  return sum_fp<f64x2>(data, n, method);
+}
+
+// Records of 4 doubles: two registers per record or per plane, and the 4x4 transpose is four 2x2
+// unpacklo/unpackhi blocks.
+struct records4_f64 {
+  using T = double;
+  struct vec {
+    __m128d lo, hi;
+  };
+  static constexpr std::size_t fields = 4, records = 4;
+  static vec load_records(const T* p) { return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)}; }
+  static void store_records(T* p, vec v) {
+    _mm_storeu_pd(p, v.lo);
+    _mm_storeu_pd(p + 2, v.hi);
+  }
+  static vec load_plane(const T* p) { return load_records(p); }
+  static void store_plane(T* p, vec v) { store_records(p, v); }
+  static vec add(vec a, vec b) { return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)}; }
+  static vec mul(vec a, vec b) { return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)}; }
+  static void transpose(vec (&r)[4]) {
+    vec f0 = {_mm_unpacklo_pd(r[0].lo, r[1].lo), _mm_unpacklo_pd(r[2].lo, r[3].lo)};
+    vec f1 = {_mm_unpackhi_pd(r[0].lo, r[1].lo), _mm_unpackhi_pd(r[2].lo, r[3].lo)};
+    vec f2 = {_mm_unpacklo_pd(r[0].hi, r[1].hi), _mm_unpacklo_pd(r[2].hi, r[3].hi)};
+    vec f3 = {_mm_unpackhi_pd(r[0].hi, r[1].hi), _mm_unpackhi_pd(r[2].hi, r[3].hi)};
+    r[0] = f0, r[1] = f1, r[2] = f2, r[3] = f3;
+  }
+};
+
+// Records of 8 floats: two registers each, and the 8x8 transpose is four 4x4 _MM_TRANSPOSE4_PS
+// blocks.
+struct records8_f32 {
+  using T = float;
+  struct vec {
+    __m128 lo, hi;
+  };
+  static constexpr std::size_t fields = 8, records = 8;
+  static vec load_records(const T* p) { return {_mm_loadu_ps(p), _mm_loadu_ps(p + 4)}; }
+  static void store_records(T* p, vec v) {
+    _mm_storeu_ps(p, v.lo);
+    _mm_storeu_ps(p + 4, v.hi);
+  }
+  static vec load_plane(const T* p) { return load_records(p); }
+  static void store_plane(T* p, vec v) { store_records(p, v); }
+  static void transpose(vec (&r)[8]) {
+    __m128 a0 = r[0].lo, a1 = r[1].lo, a2 = r[2].lo, a3 = r[3].lo;
+    __m128 b0 = r[4].lo, b1 = r[5].lo, b2 = r[6].lo, b3 = r[7].lo;
+    __m128 c0 = r[0].hi, c1 = r[1].hi, c2 = r[2].hi, c3 = r[3].hi;
+    __m128 d0 = r[4].hi, d1 = r[5].hi, d2 = r[6].hi, d3 = r[7].hi;
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+    r[0] = {a0, b0}, r[1] = {a1, b1}, r[2] = {a2, b2}, r[3] = {a3, b3};
+    r[4] = {c0, d0}, r[5] = {c1, d1}, r[6] = {c2, d2}, r[7] = {c3, d3};
+  }
+};
+
+} // namespace
+
+const kernel_table table = {isa::sse42, "sse4.2", add_f64, add_f64_stream, find_i32, find_i32_unrolled, find_all_i32, find_any_i32, find_u8, find_substr_u8, btree_lower_bound_i32, sum_i32, sum_i32_i64,
+                            reverse_in_place<u8x16>, reverse_in_place<u16x8>, reverse_in_place<i32x4>, reverse_in_place<u64x2>,
+                            reverse_copy<u8x16>, reverse_copy<u16x8>, reverse_copy<i32x4>, reverse_copy<u64x2>, reverse_copy_stream<i32x4>,
+                            sum_f32, sum_f64, extreme<i32x4>, extreme<f32x4>, extreme<f64x2>,
+                            arg_extreme<i32x4>, arg_extreme<f32x4>, arg_extreme<f64x2>, prefix_sum<i32x4>, prefix_sum<f32x4>,
+                            axpy<f64x2>, multiply_add<f64x2>, triad<f64x2>,
+                            aos_to_soa<records4_f64>, soa_to_aos<records4_f64>, aos_to_soa<records8_f32>, soa_to_aos<records8_f32>,
+                            squared_norm_aos<records4_f64>, squared_norm_soa<records4_f64>};
+
+} // namespace kernels::sse42
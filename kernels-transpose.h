@@ -0,0 +1,117 @@
+// Array-of-structs to struct-of-arrays conversion shared by the per-ISA kernel files.
+//
+// Like kernels-reduce.h, each kernels-<isa>.cpp includes this after its #pragma GCC target and
+// instantiates the templates with its own traits, one per record shape. A record is `fields`
+// elements; field j of record i is aos[i * fields + j] and soa[j * n + i]. A traits class M provides:
+//
+//   using T, vec;                     element and register (or group of registers)
+//   static constexpr std::size_t fields, records;
+//                                     record width, and records converted per step
+//   load_records(p), store_records(p, v)
+//                                     the part of one register's worth of records that starts at p;
+//                                     when records > fields, the register also holds the record
+//                                     `fields` records further on
+//   load_plane(p), store_plane(p, v)  records consecutive elements of one field
+//   transpose(r)                      r[k] from load_records(&aos[(i + k) * fields]) becomes
+//                                     field k of the step's records, and back: it is its own inverse
+//   add(a, b), mul(a, b)              for squared_norm
+
+#pragma once
+
+// Standard headers are deliberately not included here: they have to be parsed before the target
+// pragma. kernels.h brings in everything this needs.
+#include "kernels.h"
+
+namespace kernels {
+
+namespace {
+
+template <class M>
+void aos_to_soa(const typename M::T* aos, typename M::T* soa, std::size_t n) {
+  constexpr std::size_t F = M::fields, G = M::records;
+  std::size_t i = 0;
+  for (; i + G <= n; i += G) {
+    typename M::vec r[F];
+    for (std::size_t k = 0; k < F; ++k)
+      r[k] = M::load_records(&aos[(i + k) * F]);
+    M::transpose(r);
+    for (std::size_t j = 0; j < F; ++j)
+      M::store_plane(&soa[j * n + i], r[j]);
+  }
+  for (; i < n; ++i) {
+    for (std::size_t j = 0; j < F; ++j)
+      soa[j * n + i] = aos[i * F + j];
+  }
+}
+
+template <class M>
+void soa_to_aos(const typename M::T* soa, typename M::T* aos, std::size_t n) {
+  constexpr std::size_t F = M::fields, G = M::records;
+  std::size_t i = 0;
+  for (; i + G <= n; i += G) {
+    typename M::vec r[F];
+    for (std::size_t j = 0; j < F; ++j)
+      r[j] = M::load_plane(&soa[j * n + i]);
+    M::transpose(r);
+    for (std::size_t k = 0; k < F; ++k)
+      M::store_records(&aos[(i + k) * F], r[k]);
+  }
+  for (; i < n; ++i) {
+    for (std::size_t j = 0; j < F; ++j)
+      aos[i * F + j] = soa[j * n + i];
+  }
+}
+
+// Field 0 squared, plus each further field squared in order; the scalar tails add in the same order.
+template <class M>
+typename M::vec sum_of_squares(const typename M::vec (&r)[M::fields]) {
+  auto acc = M::mul(r[0], r[0]);
+  for (std::size_t j = 1; j < M::fields; ++j)
+    acc = M::add(acc, M::mul(r[j], r[j]));
+  return acc;
+}
+
+// The AoS kernel transposes each step's records in registers and then does exactly the SoA
+// kernel's arithmetic, so both write the same results.
+template <class M>
+void squared_norm_aos(const typename M::T* aos, typename M::T* out, std::size_t n) {
+  using T = typename M::T;
+  constexpr std::size_t F = M::fields, G = M::records;
+  std::size_t i = 0;
+  for (; i + G <= n; i += G) {
+    typename M::vec r[F];
+    for (std::size_t k = 0; k < F; ++k)
+      r[k] = M::load_records(&aos[(i + k) * F]);
+    M::transpose(r);
+    M::store_plane(&out[i], sum_of_squares<M>(r));
+  }
+  for (; i < n; ++i) {
+    T acc = aos[i * F] * aos[i * F];
+    for (std::size_t j = 1; j < F; ++j)
+      acc += aos[i * F + j] * aos[i * F + j];
+    out[i] = acc;
+  }
+}
+
+template <class M>
+void squared_norm_soa(const typename M::T* soa, typename M::T* out, std::size_t n) {
+  using T = typename M::T;
+  constexpr std::size_t F = M::fields, G = M::records;
+  std::size_t i = 0;
+  for (; i + G <= n; i += G) {
+    typename M::vec r[F];
+    for (std::size_t j = 0; j < F; ++j)
+      r[j] = M::load_plane(&soa[j * n + i]);
+    M::store_plane(&out[i], sum_of_squares<M>(r));
+  }
+  for (; i < n; ++i) {
+    T acc = soa[i] * soa[i];
+    for (std::size_t j = 1; j < F; ++j)
+      acc += soa[j * n + i] * soa[j * n + i];
+    out[i] = acc;
+  }
+}
+
+} // namespace
+
+} // namespace kernels
@@ -0,0 +1,284 @@
+// Scalar fallback kernels and CPU feature detection for kernels.h.
+
+#include "kernels.h"
+
+#include <algorithm>
+#include <cpuid.h>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "kernels-reduce.h"
+#include "kernels-scan.h"
+
+namespace kernels::scalar {
+
+namespace {
+
+void add_f64(const double* a, const double* b, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = a[i] + b[i];
+}
+
+std::ptrdiff_t find_i32(const int32_t* data, std::size_t n, int32_t target) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+// Every index is written and the count only advances on a match, so there is no branch to mispredict.
+std::size_t find_all_i32(const int32_t* data, std::size_t n, int32_t target, uint32_t* out) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    out[count] = i;
+    count += data[i] == target;
+  }
+  return count;
+}
+
+std::ptrdiff_t find_any_i32(const int32_t* data, std::size_t n, const key_set& keys) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (maybe_contains(keys, data[i]) && contains(keys, data[i])) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_u8(const uint8_t* data, std::size_t n, uint8_t target) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (data[i] == target) return i;
+  }
+  return -1;
+}
+
+std::ptrdiff_t find_substr_u8(const uint8_t* data, std::size_t n, const uint8_t* needle, std::size_t m) {
+  if (m == 0) return 0;
+  std::size_t i = 0;
+  for (; i + m <= n; ++i) {
+    if (data[i] == needle[0] && std::memcmp(&data[i + 1], needle + 1, m - 1) == 0) return i;
+  }
+  return -1;
+}
+
+std::size_t btree_lower_bound_i32(const int32_t* tree, std::size_t size, int32_t x) {
+  std::size_t nodes = size / btree_node, res = size;
+  for (std::size_t k = 0; k < nodes;) {
+    std::size_t i = 0;
+    for (std::size_t j = 0; j < btree_node; ++j)
+      i += tree[k * btree_node + j] < x;
+    if (i < btree_node) res = k * btree_node + i;
+    k = k * (btree_node + 1) + i + 1;
+  }
+  return res;
+}
+
+int32_t sum_i32(const int32_t* data, std::size_t n) {
+  uint32_t res = 0; // unsigned so that overflow wraps like the vector lanes do
+  for (std::size_t i = 0; i < n; ++i)
+    res += data[i];
+  return res;
+}
+
+int64_t sum_i32_i64(const int32_t* data, std::size_t n) {
+  int64_t res = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    res += data[i];
+  return res;
+}
+
+template <class T>
+void reverse(T* data, std::size_t n) {
+  std::reverse(data, data + n);
+}
+
+template <class T>
+void reverse_copy(const T* in, T* out, std::size_t n) {
+  std::reverse_copy(in, in + n, out);
+}
+
+// One-lane "vectors", so the floating-point sums run the same algorithms as the SIMD levels.
+template <class F>
+struct scalar_traits {
+  using T = F;
+  using vec = F;
+  static constexpr std::size_t lanes = 1;
+  static vec zero() { return 0; }
+  static vec load(const T* p) { return *p; }
+  static vec load_partial(const T*, std::size_t) { return 0; }
+  static vec add(vec a, vec b) { return a + b; }
+  static vec sub(vec a, vec b) { return a - b; }
+  static vec pick_by_magnitude(vec a, vec b, vec x, vec y) { return magnitude(a) >= magnitude(b) ? x : y; }
+  static void store(T* p, vec v) { *p = v; }
+};
+
+float sum_f32(const float* data, std::size_t n, fp_sum method) {
+  return sum_fp<scalar_traits<float>>(data, n, method);
+}
+
+double sum_f64(const double* data, std::size_t n, fp_sum method) {
+  return sum_fp<scalar_traits<double>>(data, n, method);
+}
+
+template <class T>
+T extreme(const T* data, std::size_t n, extremum which) {
+  T res = extremum_identity<T>(which);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (which == extremum::max ? res < data[i] : data[i] < res) res = data[i];
+  }
+  return res;
+}
+
+template <class T>
+std::ptrdiff_t arg_extreme(const T* data, std::size_t n, extremum which) {
+  if (n == 0) return -1;
+  std::size_t at = 0;
+  for (std::size_t i = 1; i < n; ++i) {
+    if (which == extremum::max ? data[at] < data[i] : data[i] < data[at]) at = i;
+  }
+  return at;
+}
+
+template <class T>
+void scan(const T* in, T* out, std::size_t n, T init, prefix kind) {
+  T acc = init;
+  for (std::size_t i = 0; i < n; ++i) {
+    T x = in[i];
+    if (kind == prefix::exclusive) out[i] = acc;
+    acc = wrapping_add(acc, x);
+    if (kind == prefix::inclusive) out[i] = acc;
+  }
+}
+
+void axpy(double alpha, const double* x, double* y, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    y[i] = alpha * x[i] + y[i];
+}
+
+void multiply_add(const double* a, const double* x, const double* b, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = a[i] * x[i] + b[i];
+}
+
+void triad(const double* b, const double* c, double q, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = b[i] + q * c[i];
+}
+
+template <class T, std::size_t F>
+void aos_to_soa(const T* aos, T* soa, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < F; ++j)
+      soa[j * n + i] = aos[i * F + j];
+  }
+}
+
+template <class T, std::size_t F>
+void soa_to_aos(const T* soa, T* aos, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < F; ++j)
+      aos[i * F + j] = soa[j * n + i];
+  }
+}
+
+void squared_norm_aos(const double* aos, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double* r = &aos[i * 4];
+    out[i] = r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3];
+  }
+}
+
+void squared_norm_soa(const double* soa, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i)
+    out[i] = soa[i] * soa[i] + soa[n + i] * soa[n + i] + soa[2 * n + i] * soa[2 * n + i] + soa[3 * n + i] * soa[3 * n + i];
+}
+
+} // namespace
+
+// No non-temporal stores at this level: the *_stream entries are the cached kernels.
+const kernel_table table = {isa::scalar, "scalar", add_f64, add_f64, find_i32, find_i32, find_all_i32, find_any_i32, find_u8, find_substr_u8, btree_lower_bound_i32, sum_i32, sum_i32_i64,
+                            reverse<uint8_t>, reverse<uint16_t>, reverse<int32_t>, reverse<uint64_t>,
+                            reverse_copy<uint8_t>, reverse_copy<uint16_t>, reverse_copy<int32_t>, reverse_copy<uint64_t>, reverse_copy<int32_t>,
+                            sum_f32, sum_f64, extreme<int32_t>, extreme<float>, extreme<double>,
+                            arg_extreme<int32_t>, arg_extreme<float>, arg_extreme<double>, scan<int32_t>, scan<float>,
+                            axpy, multiply_add, triad, aos_to_soa<double, 4>, soa_to_aos<double, 4>, aos_to_soa<float, 8>, soa_to_aos<float, 8>,
+                            squared_norm_aos, squared_norm_soa};
+
+} // namespace kernels::scalar
+
+namespace kernels {
+
+namespace {
+
+uint64_t xgetbv(uint32_t index) {
+  uint32_t eax, edx;
+  asm volatile("xgetbv" : "=a" (eax), "=d" (edx) : "c" (index));
+  return ((uint64_t) edx << 32) | eax;
+}
+
+} // namespace
+
+bool cpu_supports(isa level) {
+  unsigned eax, ebx, ecx, edx;
+  if (level == isa::scalar) return true;
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+  if (!(ecx & bit_SSE4_2)) return false;
+  if (level == isa::sse42) return true;
+
+  // AVX state must be enabled by the OS, not just present in the CPU.
+  if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX) || !(ecx & bit_FMA)) return false;
+  uint64_t xcr0 = xgetbv(0);
+  if ((xcr0 & 0x6) != 0x6) return false; // XMM and YMM state
+
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+  if (!(ebx & bit_AVX2) || !(ebx & bit_BMI) || !(ebx & bit_BMI2)) return false;
+  if (level == isa::avx2) return true;
+
+  if ((xcr0 & 0xe0) != 0xe0) return false; // opmask, ZMM0-15 upper halves and ZMM16-31 state
+  return (ebx & bit_AVX512F) && (ebx & bit_AVX512DQ) && (ebx & bit_AVX512BW) && (ebx & bit_AVX512VL);
+}
+
+const kernel_table* table_for(isa level) {
+  if (!cpu_supports(level)) return nullptr;
+  switch (level) {
+    case isa::avx512: return &avx512::table;
+    case isa::avx2: return &avx2::table;
+    case isa::sse42: return &sse42::table;
+    case isa::scalar: return &scalar::table;
+  }
+  return nullptr;
+}
+
+key_set make_key_set(const int32_t* keys, std::size_t k) {
+  if (k > key_set::max_size) throw std::invalid_argument("make_key_set: at most key_set::max_size keys");
+
+  key_set set{};
+  std::copy(keys, keys + k, set.keys);
+  std::sort(set.keys, set.keys + k);
+  set.size = std::unique(set.keys, set.keys + k) - set.keys;
+
+  for (std::size_t j = 0; j < 8 && set.size > 0; ++j)
+    set.padded[j] = set.keys[j < set.size ? j : 0];
+  for (std::size_t j = 0; j < set.size; ++j) {
+    uint32_t h = key_hash(set.keys[j]);
+    for (int f = 0; f < 3; ++f) {
+      uint32_t b = h >> (24 - 8 * f) & 0xff;
+      set.filter[f][b >> 5] |= 1u << (b & 31);
+    }
+  }
+  return set;
+}
+
+std::size_t detect_stream_threshold() {
+  long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  return llc > 0 ? (std::size_t) llc : std::size_t(32) << 20;
+}
+
+const kernel_table& detect() {
+  for (isa level : {isa::avx512, isa::avx2, isa::sse42}) {
+    if (const kernel_table* table = table_for(level)) return *table;
+  }
+  return scalar::table;
+}
+
+} // namespace kernels
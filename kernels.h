@@ -0,0 +1,397 @@
+// Runtime-dispatched SIMD kernels.
+//
+// Every kernel has one implementation per ISA level (kernels.cpp for scalar and CPU detection,
+// kernels-sse42.cpp, kernels-avx2.cpp and kernels-avx512.cpp for the vector versions). The widest
+// level the CPU supports is picked once, on first use, so a single binary built without
+// -march=native runs at full width on every x86-64 host. All kernels accept any length n.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace kernels {
+
+enum class isa { scalar, sse42, avx2, avx512 };
+
+// How the floating-point sums accumulate: plain vector adds, pairwise (recursive halving), or
+// Neumaier-compensated. See kernels-reduce.h.
+enum class fp_sum { plain, pairwise, compensated };
+
+// Which end of the order the min/max kernels look for.
+enum class extremum { min, max };
+
+// What min/max return for an empty range: the identity of the reduction, an infinity for the
+// floating-point types.
+template <class T>
+constexpr T extremum_identity(extremum which) {
+  using limits = std::numeric_limits<T>;
+  if (limits::has_infinity) return which == extremum::min ? limits::infinity() : -limits::infinity();
+  return which == extremum::min ? limits::max() : limits::lowest();
+}
+
+// Which prefix sum the scan kernels write: out[i] includes in[i], or stops just before it.
+enum class prefix { inclusive, exclusive };
+
+// Up to 64 int32 keys prepared once for find_any_i32: sorted without duplicates, the first ones
+// repeated to a power of two for the broadcast compares, and three 256-bit bitmaps over bytes of
+// key_hash() that the vector kernels use as a filter once the set is too large to compare against
+// every key.
+struct key_set {
+  static constexpr std::size_t max_size = 64;
+  int32_t keys[max_size];
+  std::size_t size;
+  int32_t padded[8];
+  uint32_t filter[3][8];
+};
+
+// Throws std::invalid_argument for more than key_set::max_size keys.
+key_set make_key_set(const int32_t* keys, std::size_t k);
+
+// Multiplicative hash; filter[f] is indexed by bits 24 - 8f .. 31 - 8f.
+inline uint32_t key_hash(int32_t x) {
+  return (uint32_t) x * 0x9e3779b1u;
+}
+
+// False only if x is certainly not a key: one bit per filter, no false negatives.
+inline bool maybe_contains(const key_set& set, int32_t x) {
+  uint32_t h = key_hash(x);
+  for (int f = 0; f < 3; ++f) {
+    uint32_t b = h >> (24 - 8 * f) & 0xff;
+    if (!(set.filter[f][b >> 5] >> (b & 31) & 1)) return false;
+  }
+  return true;
+}
+
+// Exact membership by binary search over the sorted keys.
+inline bool contains(const key_set& set, int32_t x) {
+  std::size_t lo = 0, hi = set.size;
+  while (lo < hi) {
+    std::size_t mid = (lo + hi) / 2;
+    if (set.keys[mid] < x) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo < set.size && set.keys[lo] == x;
+}
+
+// Keys per node of the to_btree() search tree (kernels-search.h): one cache line of int32.
+constexpr std::size_t btree_node = 16;
+
+struct kernel_table {
+  isa level;
+  const char* name;
+
+  // out[i] = a[i] + b[i]
+  void (*add_f64)(const double* a, const double* b, double* out, std::size_t n);
+  // Same result with non-temporal stores that bypass the cache, see stream_threshold().
+  void (*add_f64_stream)(const double* a, const double* b, double* out, std::size_t n);
+  // Index of the first element equal to target, or -1. One vector compare per step.
+  std::ptrdiff_t (*find_i32)(const int32_t* data, std::size_t n, int32_t target);
+  // Same result as find_i32, four vector compares per step with a single branch.
+  std::ptrdiff_t (*find_i32_unrolled)(const int32_t* data, std::size_t n, int32_t target);
+  // Writes the index of every element equal to target to out, in increasing order, and returns how
+  // many there are. out must have room for n indices; n must be below 2^32. Branch-free, so the
+  // cost does not depend on how many elements match.
+  std::size_t (*find_all_i32)(const int32_t* data, std::size_t n, int32_t target, uint32_t* out);
+  // Index of the first element that is one of the keys, or -1. Up to 8 keys are broadcast and
+  // compared directly; larger sets go through the hash-bitmap filter, and only the lanes that pass
+  // it are checked exactly.
+  std::ptrdiff_t (*find_any_i32)(const int32_t* data, std::size_t n, const key_set& keys);
+  // Index of the first byte equal to target, or -1: memchr with an index.
+  std::ptrdiff_t (*find_u8)(const uint8_t* data, std::size_t n, uint8_t target);
+  // Index of the first occurrence of the m-byte needle, or -1; an empty needle is found at 0. The
+  // vector kernels only compare the whole needle where its first and last bytes both match.
+  std::ptrdiff_t (*find_substr_u8)(const uint8_t* data, std::size_t n, const uint8_t* needle, std::size_t m);
+  // Index in a to_btree() layout of `size` slots of the first slot >= x in key order, or size if
+  // there is none. All 16 keys of a node are compared at once, so every step narrows the range
+  // 17-fold. Padding slots hold INT32_MAX and can be the result when x is above every real key.
+  std::size_t (*btree_lower_bound_i32)(const int32_t* tree, std::size_t size, int32_t x);
+  // Wrapping 32-bit sum.
+  int32_t (*sum_i32)(const int32_t* data, std::size_t n);
+  // Sum accumulated in 64-bit lanes (sign-extended), exact for any n below 2^32.
+  int64_t (*sum_i32_i64)(const int32_t* data, std::size_t n);
+  // In-place reverse, one entry per element width.
+  void (*reverse_u8)(uint8_t* data, std::size_t n);
+  void (*reverse_u16)(uint16_t* data, std::size_t n);
+  void (*reverse_i32)(int32_t* data, std::size_t n);
+  void (*reverse_u64)(uint64_t* data, std::size_t n);
+  // out[i] = in[n - 1 - i]; in and out must not overlap.
+  void (*reverse_copy_u8)(const uint8_t* in, uint8_t* out, std::size_t n);
+  void (*reverse_copy_u16)(const uint16_t* in, uint16_t* out, std::size_t n);
+  void (*reverse_copy_i32)(const int32_t* in, int32_t* out, std::size_t n);
+  void (*reverse_copy_u64)(const uint64_t* in, uint64_t* out, std::size_t n);
+  // Same result as reverse_copy_i32 with non-temporal stores.
+  void (*reverse_copy_i32_stream)(const int32_t* in, int32_t* out, std::size_t n);
+  // Floating-point sums. The result depends on the method and on the vector width.
+  float (*sum_f32)(const float* data, std::size_t n, fp_sum method);
+  double (*sum_f64)(const double* data, std::size_t n, fp_sum method);
+  // Smallest or largest element, extremum_identity() when n is 0. The data must not contain NaN.
+  int32_t (*extreme_i32)(const int32_t* data, std::size_t n, extremum which);
+  float (*extreme_f32)(const float* data, std::size_t n, extremum which);
+  double (*extreme_f64)(const double* data, std::size_t n, extremum which);
+  // Index of the first smallest or largest element, or -1 when n is 0; no NaN either. One pass: a
+  // vector of indices is blended alongside the best values per lane. The index lanes are as wide as
+  // the elements, so the 32-bit kernels need n below 2^32.
+  std::ptrdiff_t (*arg_extreme_i32)(const int32_t* data, std::size_t n, extremum which);
+  std::ptrdiff_t (*arg_extreme_f32)(const float* data, std::size_t n, extremum which);
+  std::ptrdiff_t (*arg_extreme_f64)(const double* data, std::size_t n, extremum which);
+  // Prefix sums: out[i] = init + in[0] + ... + in[i] (inclusive) or + in[i - 1] (exclusive, so
+  // out[0] = init). in and out may be the same array. Each vector is scanned in registers with
+  // log2(width) shift-and-add steps and then offset by a running total, so the only serial
+  // dependence is one add per vector. The int32 scan wraps; the float scan rounds differently from
+  // a sequential one.
+  void (*scan_i32)(const int32_t* in, int32_t* out, std::size_t n, int32_t init, prefix kind);
+  void (*scan_f32)(const float* in, float* out, std::size_t n, float init, prefix kind);
+  // y[i] = alpha * x[i] + y[i]
+  void (*axpy_f64)(double alpha, const double* x, double* y, std::size_t n);
+  // out[i] = a[i] * x[i] + b[i]
+  void (*fma_f64)(const double* a, const double* x, const double* b, double* out, std::size_t n);
+  // out[i] = b[i] + q * c[i], the STREAM triad. These three are one fused multiply-add per element
+  // on the AVX2 and AVX-512 levels and a multiply and an add below, so the last bit can differ.
+  void (*triad_f64)(const double* b, const double* c, double q, double* out, std::size_t n);
+  // Records of 4 doubles (8 floats) between array-of-structs and struct-of-arrays: field j of
+  // record i is aos[i * 4 + j] and soa[j * n + i]. Each block of records is transposed in registers,
+  // 4x4 (8x8) with unpack and lane permutes, so every element is loaded and stored once.
+  void (*aos_to_soa_f64x4)(const double* aos, double* soa, std::size_t n);
+  void (*soa_to_aos_f64x4)(const double* soa, double* aos, std::size_t n);
+  void (*aos_to_soa_f32x8)(const float* aos, float* soa, std::size_t n);
+  void (*soa_to_aos_f32x8)(const float* soa, float* aos, std::size_t n);
+  // out[i] = x * x + y * y + z * z + w * w for record i of 4 doubles, stored either way. The AoS
+  // kernel transposes each block in registers and then does the SoA kernel's arithmetic.
+  void (*squared_norm_aos_f64x4)(const double* aos, double* out, std::size_t n);
+  void (*squared_norm_soa_f64x4)(const double* soa, double* out, std::size_t n);
+};
+
+namespace scalar { extern const kernel_table table; }
+namespace sse42 { extern const kernel_table table; }
+namespace avx2 { extern const kernel_table table; }
+namespace avx512 { extern const kernel_table table; }
+
+// How a vector kernel finishes the last n % width elements: a scalar loop, a masked load, or one
+// extra full vector ending at data[n - 1] with the already-processed lanes discarded. The tables
+// use the fastest strategy per level; the *_tail entry points exist so the benchmarks can compare
+// them. They must only be called when cpu_supports() is true for their level.
+enum class tail { scalar, masked, overlap };
+
+namespace avx2 {
+std::ptrdiff_t find_i32_tail(const int32_t* data, std::size_t n, int32_t target, tail strategy);
+int32_t sum_i32_tail(const int32_t* data, std::size_t n, tail strategy);
+}
+
+namespace avx512 {
+std::ptrdiff_t find_i32_tail(const int32_t* data, std::size_t n, int32_t target, tail strategy);
+int32_t sum_i32_tail(const int32_t* data, std::size_t n, tail strategy);
+}
+
+// Output size in bytes from which the add_f64 and reverse_copy_i32 wrappers below switch to the
+// *_stream kernels: the last-level cache size, or 32 MiB if it cannot be read. An output that large
+// evicts itself before anyone reads it back, so caching it only costs the read-for-ownership of
+// every destination line plus the eviction of useful data. The streaming kernels fill whole lines
+// in write-combining buffers instead and end with an sfence, so their stores are ordered before
+// the function returns.
+std::size_t detect_stream_threshold();
+
+inline std::size_t stream_threshold() {
+  static const std::size_t bytes = detect_stream_threshold();
+  return bytes;
+}
+
+// True when both the CPU and the OS (XSAVE state) support the given level.
+bool cpu_supports(isa level);
+
+// The table for the given level, or nullptr when the host cannot run it.
+const kernel_table* table_for(isa level);
+
+// The table for the widest supported level.
+const kernel_table& detect();
+
+inline const kernel_table& active() {
+  static const kernel_table& table = detect();
+  return table;
+}
+
+inline void add_f64(const double* a, const double* b, double* out, std::size_t n) {
+  if (n * sizeof(double) >= stream_threshold()) active().add_f64_stream(a, b, out, n);
+  else active().add_f64(a, b, out, n);
+}
+
+inline std::ptrdiff_t find_i32(const int32_t* data, std::size_t n, int32_t target) {
+  return active().find_i32(data, n, target);
+}
+
+inline std::ptrdiff_t find_i32_unrolled(const int32_t* data, std::size_t n, int32_t target) {
+  return active().find_i32_unrolled(data, n, target);
+}
+
+inline std::size_t find_all_i32(const int32_t* data, std::size_t n, int32_t target, uint32_t* out) {
+  return active().find_all_i32(data, n, target, out);
+}
+
+inline std::ptrdiff_t find_any_i32(const int32_t* data, std::size_t n, const key_set& keys) {
+  return active().find_any_i32(data, n, keys);
+}
+
+inline std::ptrdiff_t find_u8(const uint8_t* data, std::size_t n, uint8_t target) {
+  return active().find_u8(data, n, target);
+}
+
+inline std::ptrdiff_t find_substr_u8(const uint8_t* data, std::size_t n, const uint8_t* needle, std::size_t m) {
+  return active().find_substr_u8(data, n, needle, m);
+}
+
+inline std::size_t btree_lower_bound_i32(const int32_t* tree, std::size_t size, int32_t x) {
+  return active().btree_lower_bound_i32(tree, size, x);
+}
+
+inline int32_t sum_i32(const int32_t* data, std::size_t n) {
+  return active().sum_i32(data, n);
+}
+
+inline int64_t sum_i32_i64(const int32_t* data, std::size_t n) {
+  return active().sum_i32_i64(data, n);
+}
+
+inline void reverse_u8(uint8_t* data, std::size_t n) {
+  active().reverse_u8(data, n);
+}
+
+inline void reverse_u16(uint16_t* data, std::size_t n) {
+  active().reverse_u16(data, n);
+}
+
+inline void reverse_i32(int32_t* data, std::size_t n) {
+  active().reverse_i32(data, n);
+}
+
+inline void reverse_u64(uint64_t* data, std::size_t n) {
+  active().reverse_u64(data, n);
+}
+
+inline void reverse_copy_u8(const uint8_t* in, uint8_t* out, std::size_t n) {
+  active().reverse_copy_u8(in, out, n);
+}
+
+inline void reverse_copy_u16(const uint16_t* in, uint16_t* out, std::size_t n) {
+  active().reverse_copy_u16(in, out, n);
+}
+
+inline void reverse_copy_i32(const int32_t* in, int32_t* out, std::size_t n) {
+  if (n * sizeof(int32_t) >= stream_threshold()) active().reverse_copy_i32_stream(in, out, n);
+  else active().reverse_copy_i32(in, out, n);
+}
+
+inline void reverse_copy_u64(const uint64_t* in, uint64_t* out, std::size_t n) {
+  active().reverse_copy_u64(in, out, n);
+}
+
+inline float sum_f32(const float* data, std::size_t n, fp_sum method) {
+  return active().sum_f32(data, n, method);
+}
+
+inline double sum_f64(const double* data, std::size_t n, fp_sum method) {
+  return active().sum_f64(data, n, method);
+}
+
+inline int32_t min_i32(const int32_t* data, std::size_t n) {
+  return active().extreme_i32(data, n, extremum::min);
+}
+
+inline int32_t max_i32(const int32_t* data, std::size_t n) {
+  return active().extreme_i32(data, n, extremum::max);
+}
+
+inline float min_f32(const float* data, std::size_t n) {
+  return active().extreme_f32(data, n, extremum::min);
+}
+
+inline float max_f32(const float* data, std::size_t n) {
+  return active().extreme_f32(data, n, extremum::max);
+}
+
+inline double min_f64(const double* data, std::size_t n) {
+  return active().extreme_f64(data, n, extremum::min);
+}
+
+inline double max_f64(const double* data, std::size_t n) {
+  return active().extreme_f64(data, n, extremum::max);
+}
+
+inline std::ptrdiff_t argmin_i32(const int32_t* data, std::size_t n) {
+  return active().arg_extreme_i32(data, n, extremum::min);
+}
+
+inline std::ptrdiff_t argmax_i32(const int32_t* data, std::size_t n) {
+  return active().arg_extreme_i32(data, n, extremum::max);
+}
+
+inline std::ptrdiff_t argmin_f32(const float* data, std::size_t n) {
+  return active().arg_extreme_f32(data, n, extremum::min);
+}
+
+inline std::ptrdiff_t argmax_f32(const float* data, std::size_t n) {
+  return active().arg_extreme_f32(data, n, extremum::max);
+}
+
+inline std::ptrdiff_t argmin_f64(const double* data, std::size_t n) {
+  return active().arg_extreme_f64(data, n, extremum::min);
+}
+
+inline std::ptrdiff_t argmax_f64(const double* data, std::size_t n) {
+  return active().arg_extreme_f64(data, n, extremum::max);
+}
+
+inline void inclusive_scan_i32(const int32_t* in, int32_t* out, std::size_t n, int32_t init = 0) {
+  active().scan_i32(in, out, n, init, prefix::inclusive);
+}
+
+inline void exclusive_scan_i32(const int32_t* in, int32_t* out, std::size_t n, int32_t init = 0) {
+  active().scan_i32(in, out, n, init, prefix::exclusive);
+}
+
+inline void inclusive_scan_f32(const float* in, float* out, std::size_t n, float init = 0) {
+  active().scan_f32(in, out, n, init, prefix::inclusive);
+}
+
+inline void exclusive_scan_f32(const float* in, float* out, std::size_t n, float init = 0) {
+  active().scan_f32(in, out, n, init, prefix::exclusive);
+}
+
+inline void axpy_f64(double alpha, const double* x, double* y, std::size_t n) {
+  active().axpy_f64(alpha, x, y, n);
+}
+
+inline void fma_f64(const double* a, const double* x, const double* b, double* out, std::size_t n) {
+  active().fma_f64(a, x, b, out, n);
+}
+
+inline void triad_f64(const double* b, const double* c, double q, double* out, std::size_t n) {
+  active().triad_f64(b, c, q, out, n);
+}
+
+inline void aos_to_soa_f64x4(const double* aos, double* soa, std::size_t n) {
+  active().aos_to_soa_f64x4(aos, soa, n);
+}
+
+inline void soa_to_aos_f64x4(const double* soa, double* aos, std::size_t n) {
+  active().soa_to_aos_f64x4(soa, aos, n);
+}
+
+inline void aos_to_soa_f32x8(const float* aos, float* soa, std::size_t n) {
+  active().aos_to_soa_f32x8(aos, soa, n);
+}
+
+inline void soa_to_aos_f32x8(const float* soa, float* aos, std::size_t n) {
+  active().soa_to_aos_f32x8(soa, aos, n);
+}
+
+inline void squared_norm_aos_f64x4(const double* aos, double* out, std::size_t n) {
+  active().squared_norm_aos_f64x4(aos, out, n);
+}
+
+inline void squared_norm_soa_f64x4(const double* soa, double* out, std::size_t n) {
+  active().squared_norm_soa_f64x4(soa, out, n);
+}
+
+} // namespace kernels
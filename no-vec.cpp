@@ -2,17 +2,25 @@
 
 #include <algorithm>
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
 #include <numeric>
 
+namespace {
+
+void AddVectors(const double* data_a, const double* data_b, double* result) {
+  for(int i = 0; i < 4; ++i) {
+    result[i] = data_a[i] + data_b[i];
+  }
+}
+
 void BM_AddVectors(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors)) return;
   double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
   double result[4];
 
-  for (auto _ : state) {
-    for(int i = 0; i < 4; ++i) {
-      result[i] = data_a[i] + data_b[i];
-    }
+  for (auto _ : PerfLoop(state)) {
+    AddVectors(data_a, data_b, result);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
@@ -20,55 +28,504 @@ void BM_AddVectors(benchmark::State& state) {
 }
 BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
 
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors)) return;
+  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  double result[4];
+
+  TimeCycles(state, 4, [&] {
+    AddVectors(data_a, data_b, result);
+
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_AddVectorsCycles)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+// Index of the first target, or -1. Every element is compared, the position of the first match
+// kept as a running minimum, so the loop has no early exit for the compiler to keep scalar.
+int FindInVector(const int* vector, int N, int target) {
+  int res = N;
+  for (int i = 0; i < N; ++i) {
+    int candidate = vector[i] == target ? i : N;
+    res = candidate < res ? candidate : res;
+  }
+  return res == N ? -1 : res;
+}
+
 void BM_FindInVector(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVector", FindInVector)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    for (int i = 0; i < N; ++i) {
-      if(vector[i] == target) res = i;
-    }
-    
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVector(vector, N, target);
+
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVector)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// FindInVector on the FindScenario inputs (see FindScenarioInput in bench-utils.h). It has no early
+// exit, so its time per call should not depend on the scenario: the baseline for the backends that
+// stop at the first match.
+void BM_FindInVectorScenario(benchmark::State& state, FindScenario scenario) {
+  if (!ValidateFind(state, "BM_FindInVector", FindInVector)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = FindInVector(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_position, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, absent, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, near_start, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, duplicates, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_data, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// Every matching index as a selection vector. The branchy loop only writes on a match, so it
+// mispredicts on almost every element once matches are neither rare nor nearly universal; the
+// branchless one writes every index and advances the count by the comparison result.
+int FindAllBranchy(const int* vector, int N, int target, uint32_t* result) {
+  int count = 0;
+  for (int i = 0; i < N; ++i) {
+    if (vector[i] == target) result[count++] = i;
+  }
+  return count;
+}
+
+int FindAllBranchless(const int* vector, int N, int target, uint32_t* result) {
+  int count = 0;
+  for (int i = 0; i < N; ++i) {
+    result[count] = i;
+    count += vector[i] == target;
+  }
+  return count;
+}
+
+void BM_FindAllInVector(benchmark::State& state, const char* variant, int (*find_all)(const int*, int, int, uint32_t*)) {
+  if (!ValidateFindAll(state, std::string("BM_FindAllInVector/") + variant, find_all)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  aligned_buffer<int> buffer(N);
+  aligned_buffer<uint32_t> result(N);
+  int* vector = buffer.data();
+  int64_t matches = FillSelectivity(vector, N, target, state.range(2));
+  int count = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    count = find_all(vector, N, target, result.data());
+
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetSelectivityCounters(state, N, matches);
+}
+BENCHMARK_CAPTURE(BM_FindAllInVector, branchy, "branchy", FindAllBranchy)->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindAllInVector, branchless, "branchless", FindAllBranchless)->Apply(SelectivityArgs)->MinTime(0.5)->Repetitions(10);
+
+// memchr and memmem as plain byte loops: the baseline every SIMD backend has to beat. N counts bytes.
+int FindByte(const uint8_t* text, int N, uint8_t target) {
+  for (int i = 0; i < N; ++i) {
+    if (text[i] == target) return i;
+  }
+  return -1;
+}
+
+int FindSubstring(const uint8_t* text, int N, const uint8_t* needle, int M) {
+  for (int i = 0; i + M <= N; ++i) {
+    int j = 0;
+    while (j < M && text[i + j] == needle[j]) ++j;
+    if (j == M) return i;
+  }
+  return -1;
+}
+
+void BM_FindByte(benchmark::State& state) {
+  if (!ValidateFindByte(state, "BM_FindByte", FindByte)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindByte(text, N, kDelimiter);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != state.range(1)) state.SkipWithError("FindByte returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindByte)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstring(benchmark::State& state) {
+  if (!ValidateFindSubstring(state, "BM_FindSubstring", FindSubstring)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int start = PlaceNeedle(text, state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindSubstring(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("FindSubstring returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstring)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+int SumVector(const int* vector, int N) {
+  int res = 0;
+  for( int i = 0; i < N; ++i ) {
+    res += vector[i];
+  }
+  return res;
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_SumVector(benchmark::State& state) {
+  if (!ValidateSum(state, "BM_SumVector", SumVector)) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
   int res;
 
-  for (auto _ : state) {
-    int res = 0;
-    for( int i = 0; i < N; ++i ) {
-      res += vector[i];
-    }
+  for (auto _ : PerfLoop(state)) {
+    res = SumVector(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+int64_t SumVectorWide(const int* vector, int N) {
+  int64_t res = 0;
+  for( int i = 0; i < N; ++i ) {
+    res += vector[i];
+  }
+  return res;
+}
+
+void BM_SumVectorWide(benchmark::State& state) {
+  if (!ValidateSumWide(state, "BM_SumVectorWide", SumVectorWide)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = SumVectorWide(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVectorWide)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVectorWide)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Min/max of a random column, and the index of its first smallest or largest element, for int,
+// float and double. N must be at least 1.
+template <class T, bool Max>
+T Extreme(const T* vector, int N) {
+  T res = vector[0];
+  for (int i = 1; i < N; ++i) {
+    if (Max ? res < vector[i] : vector[i] < res) res = vector[i];
+  }
+  return res;
+}
+
+template <class T, bool Max>
+int ArgExtreme(const T* vector, int N) {
+  int at = 0;
+  for (int i = 1; i < N; ++i) {
+    if (Max ? vector[at] < vector[i] : vector[i] < vector[at]) at = i;
+  }
+  return at;
+}
+
+template <class T>
+void BM_MinMaxVector(benchmark::State& state, T (*extreme)(const T*, int), bool largest) {
+  if (!ValidateExtreme<T>(state, "BM_MinMaxVector/" + std::string(largest ? "max_" : "min_") + TypeKey<T>(), extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = extreme(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != vector[ReferenceArgExtreme(vector, N, largest)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ArgMinMaxVector(benchmark::State& state, int (*arg_extreme)(const T*, int), bool largest) {
+  if (!ValidateArgExtreme<T>(state, "BM_ArgMinMaxVector/" + std::string(largest ? "argmax_" : "argmin_") + TypeKey<T>(), arg_extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = arg_extreme(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != ReferenceArgExtreme(vector, N, largest)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void ReverseVector(int* vector, int N) {
+  for (int i = 0; i < N / 2; ++i)
+    std::swap(vector[i], vector[N - i - 1]);
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
 void BM_ReverseVector(benchmark::State& state) {
+  if (!ValidateReverse<int>(state, "BM_ReverseVector", ReverseVector)) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
 
-  for (auto _ : state) {
-    for (int i = 0; i < N / 2; ++i)
-      std::swap(vector[i], vector[N - i - 1]);
+  for (auto _ : PerfLoop(state)) {
+    ReverseVector(vector, N);
 
     benchmark::ClobberMemory();
   }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
 }
-BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// The same loops at every element width, in place and into a second buffer. N counts elements;
+// compare bytes_per_second across widths.
+template <class T>
+void ReverseInPlace(T* vector, int N) {
+  for (int i = 0; i < N / 2; ++i)
+    std::swap(vector[i], vector[N - i - 1]);
+}
+
+template <class T>
+void ReverseCopy(const T* vector, T* result, int N) {
+  for (int i = 0; i < N; ++i)
+    result[i] = vector[N - i - 1];
+}
+
+template <class T>
+void BM_ReverseVectorWidth(benchmark::State& state, void (*reverse)(T*, int)) {
+  if (!ValidateReverse<T>(state, "BM_ReverseVectorWidth/" + TypeKey<T>(), reverse)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ReverseCopyVector(benchmark::State& state, void (*reverse_copy)(const T*, T*, int)) {
+  if (!ValidateReverseCopy<T>(state, "BM_ReverseCopyVector/" + TypeKey<T>(), reverse_copy)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Element-wise kernels from L1-resident to DRAM-sized arrays (ElementwiseSweep), with bytes/s and
+// FLOP/s to set against the machine's peaks: add out = a + b, AXPY y = alpha * x + y, FMA
+// out = a * x + b and the triad out = b + q * c.
+// Plain loops, not vectorized in this build: one scalar multiply and add per element, since
+// the baseline target has no FMA.
+void AddArrays(const double* a, const double* b, double* out, int N) {
+  for (int i = 0; i < N; ++i)
+    out[i] = a[i] + b[i];
+}
+
+void Axpy(double alpha, const double* x, double* y, int N) {
+  for (int i = 0; i < N; ++i)
+    y[i] = alpha * x[i] + y[i];
+}
+
+void MultiplyAdd(const double* a, const double* x, const double* b, double* out, int N) {
+  for (int i = 0; i < N; ++i)
+    out[i] = a[i] * x[i] + b[i];
+}
+
+void Triad(const double* b, const double* c, double q, double* out, int N) {
+  for (int i = 0; i < N; ++i)
+    out[i] = b[i] + q * c[i];
+}
+
+void BM_AddArrays(benchmark::State& state) {
+  if (!ValidateAdd(state, "BM_AddArrays", AddArrays)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    AddArrays(v.a.data(), v.b.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 1);
+}
+BENCHMARK(BM_AddArrays)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Axpy(benchmark::State& state) {
+  if (!ValidateAxpy(state, "BM_Axpy", Axpy)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Axpy(kElementwiseScale, v.a.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Axpy)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_MultiplyAdd(benchmark::State& state) {
+  if (!ValidateMultiplyAdd(state, "BM_MultiplyAdd", MultiplyAdd)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    MultiplyAdd(v.a.data(), v.b.data(), v.c.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 4, 2);
+}
+BENCHMARK(BM_MultiplyAdd)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Triad(benchmark::State& state) {
+  if (!ValidateTriad(state, "BM_Triad", Triad)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Triad(v.b.data(), v.c.data(), kElementwiseScale, v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Triad)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+} // namespace
 
-BENCHMARK_MAIN();
+BACKEND_MAIN();
@@ -0,0 +1,180 @@
+// Hardware performance counters around the timed loop of a benchmark, through perf_event_open.
+//
+// Benchmarks write `for (auto _ : PerfLoop(state))` instead of `for (auto _ : state)`. The counters
+// are reset and enabled just before the timer starts and read just after it stops, and each run
+// reports cycles, instructions, IPC, L1D_misses, LLC_misses and branch_misses per iteration as user
+// counters, so they land in the JSON output next to real_time and cpu_time.
+//
+// Only user-space events of the thread running the loop are counted (exclude_kernel), which needs
+// no privileges up to perf_event_paranoid 2. The worker threads of the parallel benchmarks are not
+// included. Where the counters cannot be opened at all (no PMU in a VM, paranoid 3, seccomp) the
+// loop runs unchanged and reports none; the perf_counters context line says why. An event the CPU
+// lacks is dropped on its own.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+class PerfCounters {
+ public:
+  // The counters of the calling thread, opened on first use.
+  static PerfCounters& ForThisThread() {
+    thread_local PerfCounters counters;
+    return counters;
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  bool available() const { return !fds_.empty(); }
+
+  // The events being counted, or why there are none.
+  const std::string& description() const { return description_; }
+
+  void Start() {
+#ifdef __linux__
+    if (!available()) return;
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  // Stops the counters and reports them per iteration of state. When the kernel had to multiplex
+  // the group, the counts are scaled up by time enabled / time running, as perf stat does.
+  void Stop(benchmark::State& state) {
+#ifdef __linux__
+    if (!available()) return;
+    ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // nr, time_enabled, time_running, then one value per event in the order they were opened.
+    std::vector<uint64_t> data(3 + fds_.size());
+    ssize_t bytes = read(fds_[0], data.data(), data.size() * sizeof(uint64_t));
+    if (bytes < ssize_t(3 * sizeof(uint64_t)) || data[0] != fds_.size() || data[2] == 0 || state.iterations() == 0) return;
+
+    double scale = double(data[1]) / double(data[2]);
+    double cycles = 0, instructions = 0;
+    for (std::size_t i = 0; i < fds_.size(); ++i) {
+      double value = double(data[3 + i]) * scale;
+      state.counters[names_[i]] = benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+      if (std::strcmp(names_[i], "cycles") == 0) cycles = value;
+      if (std::strcmp(names_[i], "instructions") == 0) instructions = value;
+    }
+    if (cycles > 0 && instructions > 0) state.counters["IPC"] = instructions / cycles;
+#else
+    (void) state;
+#endif
+  }
+
+ private:
+#ifdef __linux__
+  struct Event {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+  // The first event leads the group, so all of them are scheduled on the PMU together.
+  PerfCounters() {
+    const Event events[] = {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"L1D_misses", PERF_TYPE_HW_CACHE,
+         PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {"LLC_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    for (const Event& event : events) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = event.type;
+      attr.config = event.config;
+      attr.disabled = fds_.empty();
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      int leader = fds_.empty() ? -1 : fds_[0];
+      int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+      if (fd < 0) {
+        if (fds_.empty()) {
+          description_ = std::string("unavailable (") + event.name + ": " + std::strerror(errno) + ")";
+          return;
+        }
+        continue;
+      }
+      fds_.push_back(fd);
+      names_.push_back(event.name);
+      description_ += description_.empty() ? event.name : std::string(",") + event.name;
+    }
+  }
+
+  ~PerfCounters() {
+    for (int fd : fds_)
+      close(fd);
+  }
+#else
+  PerfCounters() : description_("unavailable (perf_event_open is Linux-only)") {}
+#endif
+
+  std::vector<int> fds_;  // fds_[0] is the group leader
+  std::vector<const char*> names_;
+  std::string description_;
+};
+
+// Records which counters this run collects in the benchmark context, before any benchmark runs. In
+// all-backends every backend file has its own copy of this header, so all-backends.cpp records it
+// once instead.
+#ifndef BENCH_BACKEND
+const bool kPerfCountersContext = (benchmark::AddCustomContext("perf_counters", PerfCounters::ForThisThread().description()), true);
+#endif
+
+// The range a benchmark iterates instead of its State, bracketing the timed loop with
+// PerfCounters. A range-for calls begin() and then end(), and State::end() starts the timer, so
+// the counters start in end(); they stop when the last != comparison has stopped the timer.
+class PerfLoop {
+ public:
+  explicit PerfLoop(benchmark::State& state) : state_(state), counters_(PerfCounters::ForThisThread()) {}
+
+  class iterator {
+   public:
+    iterator(benchmark::State::StateIterator it, PerfLoop* loop) : it_(it), loop_(loop) {}
+    auto operator*() const { return *it_; }
+    iterator& operator++() {
+      ++it_;
+      return *this;
+    }
+    bool operator!=(const iterator& other) {
+      if (it_ != other.it_) return true;
+      loop_->counters_.Stop(loop_->state_);
+      return false;
+    }
+
+   private:
+    benchmark::State::StateIterator it_;
+    PerfLoop* loop_;
+  };
+
+  iterator begin() { return iterator(state_.begin(), this); }
+  iterator end() {
+    counters_.Start();
+    return iterator(state_.end(), this);
+  }
+
+ private:
+  benchmark::State& state_;
+  PerfCounters& counters_;
+};
+
+} // namespace
@@ -0,0 +1,223 @@
+// Noise control for the all-backends executable: CPU pinning, frequency checks, warm-up and one
+// JSON file per backend. all-backends.cpp strips these flags before Google Benchmark sees the rest:
+//
+//   --runner_cpus=<list>        CPUs to run on, e.g. 3 or 2,3 or 8-11; none leaves the affinity
+//                               alone. Defaults to /sys/devices/system/cpu/isolated (isolcpus=), or
+//                               to the highest CPU the process may use, as CPU 0 takes most
+//                               interrupts. Worker threads inherit the pin, so the thread-scaling
+//                               benchmarks skip every thread count above the number of CPUs; give
+//                               them a list with enough CPUs, or none, for their scaling curves.
+//   --runner_require_quiet      exit instead of warning when a CPU is not on the performance
+//                               governor or turbo is on
+//   --runner_warmup_max=<s>     seconds to wait at most for the clock to settle, default 10
+//   --runner_out_dir=<dir>      also write <dir>/<backend>-data for every backend, in the schema and
+//                               with the benchmark names of the single-backend executables, so
+//                               json-to-csv.py and the plots read them unchanged
+//
+// The governor and turbo are only read, never changed: the run records what it got in the
+// governor and turbo context entries instead of assuming cpupower worked.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "backend-registry.h"
+
+struct RunnerOptions {
+  std::string cpus;  // empty: the default above
+  bool require_quiet = false;
+  double warmup_max = 10;
+  std::string out_dir;
+};
+
+// If arg is --<flag>=<value>, stores the value and returns true.
+inline bool FlagValue(const std::string& arg, const std::string& flag, std::string* value) {
+  std::string prefix = "--" + flag + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+  *value = arg.substr(prefix.size());
+  return true;
+}
+
+// Removes the --runner_ flags from argv and returns them.
+inline RunnerOptions ParseRunnerFlags(int* argc, char** argv) {
+  RunnerOptions options;
+  std::string warmup_max;
+  int kept = 1;
+  for (int i = 1; i < *argc; ++i) {
+    std::string arg = argv[i];
+    if (FlagValue(arg, "runner_cpus", &options.cpus) || FlagValue(arg, "runner_out_dir", &options.out_dir)) continue;
+    if (FlagValue(arg, "runner_warmup_max", &warmup_max)) {
+      options.warmup_max = std::stod(warmup_max);
+      continue;
+    }
+    if (arg == "--runner_require_quiet") {
+      options.require_quiet = true;
+      continue;
+    }
+    argv[kept++] = argv[i];
+  }
+  *argc = kept;
+  return options;
+}
+
+// The first line of a sysfs file, or "" when it does not exist.
+inline std::string ReadSysfs(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+// "2,3,8-11" as {2, 3, 8, 9, 10, 11}, the format of isolcpus= and the sysfs CPU lists.
+inline std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    if (range.empty()) continue;
+    std::size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+inline std::string FormatCpuList(const std::vector<int>& cpus) {
+  std::string list;
+  for (int cpu : cpus)
+    list += (list.empty() ? "" : ",") + std::to_string(cpu);
+  return list;
+}
+
+// Pins the process, and so every thread it starts later, to the CPUs of options. Returns them;
+// empty when the affinity was left alone. The pool and OpenMP workers of the parallel benchmarks are
+// among those threads, which is why they skip thread counts the pinned set cannot hold
+// (SkipOversubscribed in bench-utils.h) rather than report time-sliced runs.
+inline std::vector<int> PinToCpus(const RunnerOptions& options) {
+  if (options.cpus == "none") return {};
+  std::vector<int> cpus = ParseCpuList(options.cpus.empty() ? ReadSysfs("/sys/devices/system/cpu/isolated") : options.cpus);
+  if (cpus.empty()) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return {};
+    for (int cpu = CPU_SETSIZE - 1; cpu >= 0 && cpus.empty(); --cpu) {
+      if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus)
+    CPU_SET(cpu, &set);
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    std::perror("sched_setaffinity");
+    return {};
+  }
+  return cpus;
+}
+
+// The scaling governors of cpus, comma separated when they differ, or "unknown" without cpufreq.
+inline std::string Governors(const std::vector<int>& cpus) {
+  std::set<std::string> governors;
+  for (int cpu : cpus) {
+    std::string governor = ReadSysfs("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+    governors.insert(governor.empty() ? "unknown" : governor);
+  }
+  std::string list;
+  for (const std::string& governor : governors)
+    list += (list.empty() ? "" : ",") + governor;
+  return list.empty() ? "unknown" : list;
+}
+
+// "on", "off" or "unknown", from intel_pstate or else the generic cpufreq boost switch.
+inline std::string TurboState() {
+  std::string no_turbo = ReadSysfs("/sys/devices/system/cpu/intel_pstate/no_turbo");
+  if (!no_turbo.empty()) return no_turbo == "1" ? "off" : "on";
+  std::string boost = ReadSysfs("/sys/devices/system/cpu/cpufreq/boost");
+  if (!boost.empty()) return boost == "1" ? "on" : "off";
+  return "unknown";
+}
+
+// Times a fixed chain of dependent multiply-adds until the last 10 timings are within 1% of each
+// other, i.e. the core has left its idle clock and settled at the frequency the benchmarks will see.
+// Returns the seconds that took, or a negative number after max_seconds without settling.
+inline double WarmUp(double max_seconds) {
+  using clock = std::chrono::steady_clock;
+  const auto start = clock::now();
+  std::vector<double> window;
+  while (std::chrono::duration<double>(clock::now() - start).count() < max_seconds) {
+    const auto t0 = clock::now();
+    uint64_t x = 1;
+    for (int i = 0; i < 1 << 20; ++i) {
+      x = x * 6364136223846793005u + 1442695040888963407u;
+      benchmark::DoNotOptimize(x);
+    }
+    window.push_back(std::chrono::duration<double>(clock::now() - t0).count());
+    if (window.size() > 10) window.erase(window.begin());
+    if (window.size() == 10 && *std::max_element(window.begin(), window.end()) <= 1.01 * *std::min_element(window.begin(), window.end()))
+      return std::chrono::duration<double>(clock::now() - start).count();
+  }
+  return -1;
+}
+
+// The console output as usual, plus every run again in <dir>/<backend>-data with the backend taken
+// off its name, as if the backend's own executable had written it with --benchmark_out.
+class BackendFilesReporter : public benchmark::ConsoleReporter {
+ public:
+  explicit BackendFilesReporter(const std::string& dir) : ConsoleReporter(isatty(STDOUT_FILENO) ? OO_Color : OO_None) {
+    for (const std::string& backend : Backends()) {
+      auto& file = files_[backend];
+      file.stream = std::make_unique<std::ofstream>(dir + "/" + backend + "-data");
+      file.reporter.SetOutputStream(file.stream.get());
+      file.reporter.SetErrorStream(&std::cerr);
+    }
+  }
+
+  bool ReportContext(const Context& context) override {
+    for (auto& [backend, file] : files_)
+      file.reporter.ReportContext(context);
+    return ConsoleReporter::ReportContext(context);
+  }
+
+  void ReportRuns(const std::vector<Run>& runs) override {
+    ConsoleReporter::ReportRuns(runs);
+    std::map<std::string, std::vector<Run>> by_backend;
+    for (Run run : runs) {
+      std::string& name = run.run_name.function_name;
+      std::size_t slash = name.find('/');
+      if (slash == std::string::npos || !files_.count(name.substr(0, slash))) continue;
+      std::string backend = name.substr(0, slash);
+      name.erase(0, slash + 1);
+      by_backend[backend].push_back(run);
+    }
+    for (auto& [backend, backend_runs] : by_backend)
+      files_[backend].reporter.ReportRuns(backend_runs);
+  }
+
+  void Finalize() override {
+    for (auto& [backend, file] : files_)
+      file.reporter.Finalize();
+    ConsoleReporter::Finalize();
+  }
+
+ private:
+  struct File {
+    std::unique_ptr<std::ofstream> stream;
+    benchmark::JSONReporter reporter;
+  };
+  std::map<std::string, File> files_;
+};
@@ -2,20 +2,30 @@
 
 #include <algorithm>
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
 #include <experimental/simd>
 #include <numeric>
 
+namespace {
+
+// simd<double> is the ABI-compatible width, two doubles on x86, so the four take a fixed size.
+// Its vector_aligned loads and store need the 32-byte alignment of the arrays in BM_AddVectors.
+void AddVectors(const double* data_a, const double* data_b, double* result) {
+  std::experimental::fixed_size_simd<double, 4> a, b;
+  a.copy_from(data_a, std::experimental::vector_aligned);
+  b.copy_from(data_b, std::experimental::vector_aligned);
+  auto simd_result = a + b;
+  simd_result.copy_to(result, std::experimental::vector_aligned);
+}
+
 void BM_AddVectors(benchmark::State& state) {
-  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
-  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
-  double result[4];
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors, 32)) return;
+  alignas(32) double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double result[4];
 
-  for (auto _ : state) {
-    std::experimental::simd<double> a, b;
-    a.copy_from(data_a, std::experimental::vector_aligned);
-    b.copy_from(data_b, std::experimental::vector_aligned);
-    auto simd_result = a + b;
-    simd_result.copy_to(result, std::experimental::vector_aligned);
+  for (auto _ : PerfLoop(state)) {
+    AddVectors(data_a, data_b, result);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
@@ -23,167 +33,775 @@ void BM_AddVectors(benchmark::State& state) {
 }
 BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
 
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors, 32)) return;
+  alignas(32) double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double result[4];
+
+  TimeCycles(state, 4, [&] {
+    AddVectors(data_a, data_b, result);
+
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_AddVectorsCycles)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+int FindInVector(const int* vector, int N, int target) {
+  int res = -1;
+  std::experimental::fixed_size_simd<int, 8> simd_target(target);
+
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    std::experimental::fixed_size_simd<int, 8> simd_vector(&vector[i], std::experimental::vector_aligned);
+    auto mask = simd_vector == simd_target;
+
+    if (std::experimental::any_of(mask)) {
+      for (int j = 0; j < 8; ++j) {
+        if (mask[j]) {
+          res = i + j;
+          break;
+        }
+      }
+      break;
+    }
+  }
+
+  // Scalar epilogue for the last N % 8 elements.
+  for (; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
+  }
+  return res;
+}
+
 void BM_FindInVector(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVector", FindInVector, 32)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    std::experimental::fixed_size_simd<int, 8> simd_target(target);
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVector(vector, N, target);
 
-    for (int i = 0; i < N; i += 8) {
-      std::experimental::fixed_size_simd<int, 8> simd_vector(&vector[i], std::experimental::vector_aligned);
-      auto mask = simd_vector == simd_target;
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVector)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
 
-      if (std::experimental::any_of(mask)) {
+int FindInVectorFaster(const int* vector, int N, int target) {
+  int res = -1;
+  std::experimental::fixed_size_simd<int, 8> simd_target(target);
+
+  int i = 0;
+  for (; i + 32 <= N; i += 32) {
+    std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
+    std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[i + 8], std::experimental::vector_aligned);
+    std::experimental::fixed_size_simd<int, 8> simd_vector3(&vector[i + 16], std::experimental::vector_aligned);
+    std::experimental::fixed_size_simd<int, 8> simd_vector4(&vector[i + 24], std::experimental::vector_aligned);
+    auto mask1 = simd_vector1 == simd_target;
+    auto mask2 = simd_vector2 == simd_target;
+    auto mask12 = mask1 || mask2;
+    auto mask3 = simd_vector3 == simd_target;
+    auto mask4 = simd_vector4 == simd_target;
+    auto mask23 = mask3 || mask4;
+    auto mask = mask12 || mask23;
+    if (std::experimental::any_of(mask)) {
+      if (std::experimental::any_of(mask1)) {
         for (int j = 0; j < 8; ++j) {
-          if (mask[j]) {
+          if (mask1[j]) {
             res = i + j;
             break;
           }
         }
         break;
       }
+      if (std::experimental::any_of(mask2)) {
+        for (int j = 0; j < 8; ++j) {
+          if (mask2[j]) {
+            res = i + j + 8;
+            break;
+          }
+        }
+        break;
+      }
+      if (std::experimental::any_of(mask3)) {
+        for (int j = 0; j < 8; ++j) {
+          if (mask3[j]) {
+            res = i + j + 16;
+            break;
+          }
+        }
+        break;
+      }
+      if (std::experimental::any_of(mask4)) {
+        for (int j = 0; j < 8; ++j) {
+          if (mask4[j]) {
+            res = i + j + 24;
+            break;
+          }
+        }
+        break;
+      }
     }
+  }
 
-    benchmark::DoNotOptimize(res);
-    benchmark::ClobberMemory();
+  // Scalar epilogue for the last N % 32 elements.
+  for (; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
   }
+  return res;
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_FindInVectorFaster(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster, 32)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  for (auto _ : state) {
-    std::experimental::fixed_size_simd<int, 8> simd_target(target);
-
-    for (int i = 0; i < N; i += 32) {
-      std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
-      std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[i + 8], std::experimental::vector_aligned);
-      std::experimental::fixed_size_simd<int, 8> simd_vector3(&vector[i + 16], std::experimental::vector_aligned);
-      std::experimental::fixed_size_simd<int, 8> simd_vector4(&vector[i + 24], std::experimental::vector_aligned);
-      auto mask1 = simd_vector1 == simd_target;
-      auto mask2 = simd_vector2 == simd_target;
-      auto mask12 = mask1 || mask2;
-      auto mask3 = simd_vector3 == simd_target;
-      auto mask4 = simd_vector4 == simd_target;
-      auto mask23 = mask3 || mask4;
-      auto mask = mask12 || mask23;
-      if (std::experimental::any_of(mask)) {
-        if (std::experimental::any_of(mask1)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask1[j]) {
-              res = i + j;
-              break;
-            }
-          }
-          break;
-        }
-        if (std::experimental::any_of(mask2)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask2[j]) {
-              res = i + j + 8;
-              break;
-            }
-          }
-          break;
-        }
-        if (std::experimental::any_of(mask3)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask3[j]) {
-              res = i + j + 16;
-              break;
-            }
-          }
-          break;
-        }
-        if (std::experimental::any_of(mask4)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask4[j]) {
-              res = i + j + 24;
-              break;
-            }
-          }
-          break;
-        }
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVectorFaster)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// The early-exit find on the FindScenario inputs, which move the target on every call so the exit
+// cannot be learned (see FindScenarioInput in bench-utils.h).
+void BM_FindInVectorScenario(benchmark::State& state, FindScenario scenario) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster, 32)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_position, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, absent, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, near_start, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, duplicates, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_data, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// memchr and a first/last-byte-filtered substring search over native byte vectors. N counts bytes.
+using byte_simd = std::experimental::native_simd<uint8_t>;
+
+int FindByte(const uint8_t* text, int N, uint8_t target) {
+  constexpr int L = byte_simd::size();
+  byte_simd simd_target(target);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto mask = byte_simd(&text[i], std::experimental::element_aligned) == simd_target;
+    if (std::experimental::any_of(mask)) return i + std::experimental::find_first_set(mask);
+  }
+
+  // Scalar epilogue for the last N % L bytes.
+  for (; i < N; ++i) {
+    if (text[i] == target) return i;
+  }
+  return -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches M - 1
+// bytes further on; only those are compared in full.
+int FindSubstring(const uint8_t* text, int N, const uint8_t* needle, int M) {
+  if (M == 0) return 0;
+  constexpr int L = byte_simd::size();
+  byte_simd first(needle[0]);
+  byte_simd last(needle[M - 1]);
+  int i = 0;
+
+  for (; i + M - 1 + L <= N; i += L) {
+    auto mask = (byte_simd(&text[i], std::experimental::element_aligned) == first) && (byte_simd(&text[i + M - 1], std::experimental::element_aligned) == last);
+    if (std::experimental::any_of(mask)) {
+      for (int j = 0; j < L; ++j) {
+        if (mask[j] && std::equal(needle + 1, needle + M, &text[i + j + 1])) return i + j;
       }
     }
+  }
+
+  for (; i + M <= N; ++i) {
+    if (std::equal(needle, needle + M, &text[i])) return i;
+  }
+  return -1;
+}
+
+void BM_FindByte(benchmark::State& state) {
+  if (!ValidateFindByte(state, "BM_FindByte", FindByte)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindByte(text, N, kDelimiter);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != state.range(1)) state.SkipWithError("FindByte returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindByte)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstring(benchmark::State& state) {
+  if (!ValidateFindSubstring(state, "BM_FindSubstring", FindSubstring)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int start = PlaceNeedle(text, state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindSubstring(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("FindSubstring returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstring)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+int SumVector(const int* vector, int N) {
+  int res = 0;
+  std::experimental::fixed_size_simd<int, 8> s1(0);
+  std::experimental::fixed_size_simd<int, 8> s2(0);
+  
+
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
+    std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[i + 8], std::experimental::vector_aligned);
+    s1 = s1 + simd_vector1;
+    s2 = s2 + simd_vector2;
+  }
+
+  std::experimental::fixed_size_simd<int, 8> s = s1 + s2;
+  alignas(std::experimental::memory_alignment_v<std::experimental::fixed_size_simd<int, 8>>) int t[8];
+
+  s.copy_to(t, std::experimental::vector_aligned);
+  
+  for (int i = 0; i < 8; ++i) 
+    res += t[i];
+
+  // Scalar epilogue for the last N % 16 elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
 }
-BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_SumVector(benchmark::State& state) {
+  if (!ValidateSum(state, "BM_SumVector", SumVector, 32)) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
   int res;
 
-  for (auto _ : state) {
-    res = 0;
-    std::experimental::fixed_size_simd<int, 8> s1(0);
-    std::experimental::fixed_size_simd<int, 8> s2(0);
-    
-
-    for (int i = 0; i < N; i += 16) {
-      std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
-      std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[i + 8], std::experimental::vector_aligned);
-      s1 = s1 + simd_vector1;
-      s2 = s2 + simd_vector2;
+  for (auto _ : PerfLoop(state)) {
+    res = SumVector(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+int64_t SumVectorWide(const int* vector, int N) {
+  int64_t res = 0;
+  std::experimental::fixed_size_simd<int64_t, 8> s1(0);
+  std::experimental::fixed_size_simd<int64_t, 8> s2(0);
+
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
+    std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[i + 8], std::experimental::vector_aligned);
+    // Sign-extends each lane to 64 bits (vpmovsxdq).
+    s1 = s1 + std::experimental::static_simd_cast<std::experimental::fixed_size_simd<int64_t, 8>>(simd_vector1);
+    s2 = s2 + std::experimental::static_simd_cast<std::experimental::fixed_size_simd<int64_t, 8>>(simd_vector2);
+  }
+
+  res = std::experimental::reduce(s1 + s2);
+
+  // Scalar epilogue for the last N % 16 elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
+}
+
+void BM_SumVectorWide(benchmark::State& state) {
+  if (!ValidateSumWide(state, "BM_SumVectorWide", SumVectorWide, 32)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = SumVectorWide(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVectorWide)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVectorWide)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Min/max of a random column, and the index of its first smallest or largest element, for int,
+// float and double. N must be at least 1.
+template <class T, bool Max>
+std::experimental::native_simd<T> Better(const std::experimental::native_simd<T>& a, const std::experimental::native_simd<T>& b) {
+  return Max ? std::experimental::max(a, b) : std::experimental::min(a, b);
+}
+
+template <class T, bool Max>
+T Extreme(const T* vector, int N) {
+  using simd_type = std::experimental::native_simd<T>;
+  constexpr int L = simd_type::size();
+  if (N < L) return Max ? *std::max_element(vector, vector + N) : *std::min_element(vector, vector + N);
+
+  simd_type r1(vector, std::experimental::element_aligned), r2 = r1, r3 = r1, r4 = r1;
+  int i = L;
+  for (; i + 4 * L <= N; i += 4 * L) {
+    r1 = Better<T, Max>(r1, simd_type(&vector[i], std::experimental::element_aligned));
+    r2 = Better<T, Max>(r2, simd_type(&vector[i + L], std::experimental::element_aligned));
+    r3 = Better<T, Max>(r3, simd_type(&vector[i + 2 * L], std::experimental::element_aligned));
+    r4 = Better<T, Max>(r4, simd_type(&vector[i + 3 * L], std::experimental::element_aligned));
+  }
+  for (; i + L <= N; i += L)
+    r1 = Better<T, Max>(r1, simd_type(&vector[i], std::experimental::element_aligned));
+  // Min and max are idempotent, so the last N % L elements come in as one vector ending at vector[N - 1].
+  if (i < N) r2 = Better<T, Max>(r2, simd_type(&vector[N - L], std::experimental::element_aligned));
+
+  simd_type r = Better<T, Max>(Better<T, Max>(r1, r2), Better<T, Max>(r3, r4));
+  return Max ? std::experimental::hmax(r) : std::experimental::hmin(r);
+}
+
+// Two accumulators, each with the index every lane's best value came from, in integers as wide as T.
+// The TS has no mask conversion between element types; libstdc++ provides one as
+// __proposed::static_simd_cast. Both accumulators share one index vector holding the indices of the
+// first of the pair; the second adds L when the lanes are folded.
+template <class T, bool Max>
+int ArgExtreme(const T* vector, int N) {
+  using simd_type = std::experimental::native_simd<T>;
+  using I = std::conditional_t<sizeof(T) == 8, int64_t, int32_t>;
+  using index_type = std::experimental::rebind_simd_t<I, simd_type>;
+  constexpr int L = simd_type::size();
+  T res = vector[0];
+  int res_at = 0, i = 0;
+
+  if (N >= 2 * L) {
+    simd_type b1(vector, std::experimental::element_aligned);
+    simd_type b2(&vector[L], std::experimental::element_aligned);
+    index_type base([](auto lane) { return I(lane); }), a1 = base, a2 = base;
+    const index_type step(I(2 * L));
+
+    for (i = 2 * L; i + 2 * L <= N; i += 2 * L) {
+      base += step;
+      simd_type x1(&vector[i], std::experimental::element_aligned);
+      simd_type x2(&vector[i + L], std::experimental::element_aligned);
+      // Strict compares, so every lane keeps the first of equal values it sees.
+      auto m1 = Max ? b1 < x1 : x1 < b1;
+      auto m2 = Max ? b2 < x2 : x2 < b2;
+      std::experimental::where(m1, b1) = x1;
+      std::experimental::where(m2, b2) = x2;
+      std::experimental::where(std::experimental::__proposed::static_simd_cast<typename index_type::mask_type>(m1), a1) = base;
+      std::experimental::where(std::experimental::__proposed::static_simd_cast<typename index_type::mask_type>(m2), a2) = base;
     }
 
-    std::experimental::fixed_size_simd<int, 8> s = s1 + s2;
-    alignas(std::experimental::memory_alignment_v<std::experimental::fixed_size_simd<int, 8>>) int t[8];
+    // Among equal values the smaller index wins, so the result is the first occurrence.
+    T best[2 * L];
+    I at[2 * L];
+    b1.copy_to(&best[0], std::experimental::element_aligned);
+    b2.copy_to(&best[L], std::experimental::element_aligned);
+    a1.copy_to(&at[0], std::experimental::element_aligned);
+    (a2 + I(L)).copy_to(&at[L], std::experimental::element_aligned);
+    for (int j = 0; j < 2 * L; ++j) {
+      if ((Max ? res < best[j] : best[j] < res) || (best[j] == res && at[j] < res_at)) {
+        res = best[j];
+        res_at = int(at[j]);
+      }
+    }
+  }
+
+  // Everything left comes after every index above, so only a strictly better value replaces it.
+  for (; i < N; ++i) {
+    if (Max ? res < vector[i] : vector[i] < res) {
+      res = vector[i];
+      res_at = i;
+    }
+  }
+  return res_at;
+}
+
+template <class T>
+void BM_MinMaxVector(benchmark::State& state, T (*extreme)(const T*, int), bool largest) {
+  if (!ValidateExtreme<T>(state, "BM_MinMaxVector/" + std::string(largest ? "max_" : "min_") + TypeKey<T>(), extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
 
-    s.copy_to(t, std::experimental::vector_aligned);
-    
-    for (int i = 0; i < 8; ++i) 
-      res += t[i];
+  for (auto _ : PerfLoop(state)) {
+    res = extreme(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != vector[ReferenceArgExtreme(vector, N, largest)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ArgMinMaxVector(benchmark::State& state, int (*arg_extreme)(const T*, int), bool largest) {
+  if (!ValidateArgExtreme<T>(state, "BM_ArgMinMaxVector/" + std::string(largest ? "argmax_" : "argmin_") + TypeKey<T>(), arg_extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = arg_extreme(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != ReferenceArgExtreme(vector, N, largest)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void ReverseVector(int* vector, int N) {
+  int i = 0;
+  for (; i + 8 <= N / 2; i += 8) {
+    std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
+    std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[N - i - 8], std::experimental::element_aligned); // not vector aligned when N % 8 != 0
+
+    std::array<int, 8> temp1, temp2;
+    for (int j = 0; j < 8; ++j) {
+        temp1[j] = simd_vector1[j];
+        temp2[j] = simd_vector2[j];
+    }
+    for (int j = 0; j < 8; ++j) {
+        simd_vector1[j] = temp2[7 - j];
+        simd_vector2[j] = temp1[7 - j];
+    }
+
+    simd_vector1.copy_to(&vector[i], std::experimental::vector_aligned);
+    simd_vector2.copy_to(&vector[N - i - 8], std::experimental::element_aligned);
+  }
+  std::reverse(&vector[i], &vector[N - i]);
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
 void BM_ReverseVector(benchmark::State& state) {
+  if (!ValidateReverse<int>(state, "BM_ReverseVector", ReverseVector, 32)) return;
   int N = state.range(1) - state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
 
-  for (auto _ : state) {
-    for (int i = 0; i < N / 2; i += 8) {
-      std::experimental::fixed_size_simd<int, 8> simd_vector1(&vector[i], std::experimental::vector_aligned);
-      std::experimental::fixed_size_simd<int, 8> simd_vector2(&vector[N - i - 8], std::experimental::vector_aligned);
+  for (auto _ : PerfLoop(state)) {
+    ReverseVector(vector, N);
 
-      std::array<int, 8> temp1, temp2;
-      for (int j = 0; j < 8; ++j) {
-          temp1[j] = simd_vector1[j];
-          temp2[j] = simd_vector2[j];
-      }
-      for (int j = 0; j < 8; ++j) {
-          simd_vector1[j] = temp2[7 - j];
-          simd_vector2[j] = temp1[7 - j];
-      }
+    benchmark::ClobberMemory();
+  }
 
-      simd_vector1.copy_to(&vector[i], std::experimental::vector_aligned);
-      simd_vector2.copy_to(&vector[N - i - 8], std::experimental::vector_aligned);
-    }
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_ReverseVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
 
+// std::experimental::simd has no permute, so the reverse goes through the generator constructor,
+// which GCC builds lane by lane. The gap to the other backends is the cost of that missing API.
+template <class T>
+std::experimental::native_simd<T> ReverseSimd(const std::experimental::native_simd<T>& x) {
+  constexpr int L = std::experimental::native_simd<T>::size();
+  return std::experimental::native_simd<T>([&](auto j) { return x[L - 1 - j]; });
+}
+
+// In-place reverse at any width. The middle uses two overlapping vectors, both loaded before
+// either store, so only fewer than L elements go through the scalar loop.
+template <class T>
+void ReverseInPlace(T* vector, int N) {
+  using simd_type = std::experimental::native_simd<T>;
+  constexpr int L = simd_type::size();
+  int lo = 0, hi = N;
+
+  for (; hi - lo >= 2 * L; lo += L, hi -= L) {
+    simd_type simd_vector1(&vector[lo], std::experimental::element_aligned);
+    simd_type simd_vector2(&vector[hi - L], std::experimental::element_aligned);
+    ReverseSimd(simd_vector2).copy_to(&vector[lo], std::experimental::element_aligned);
+    ReverseSimd(simd_vector1).copy_to(&vector[hi - L], std::experimental::element_aligned);
+  }
+  if (hi - lo >= L) {
+    simd_type simd_vector1(&vector[lo], std::experimental::element_aligned);
+    simd_type simd_vector2(&vector[hi - L], std::experimental::element_aligned);
+    ReverseSimd(simd_vector2).copy_to(&vector[lo], std::experimental::element_aligned);
+    ReverseSimd(simd_vector1).copy_to(&vector[hi - L], std::experimental::element_aligned);
+    return;
+  }
+  std::reverse(&vector[lo], &vector[hi]);
+}
+
+// result[i] = vector[N - 1 - i]. The last N % L outputs come from one vector ending at result[N - 1].
+template <class T>
+void ReverseCopy(const T* vector, T* result, int N) {
+  using simd_type = std::experimental::native_simd<T>;
+  constexpr int L = simd_type::size();
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    ReverseSimd(simd_type(&vector[N - i - L], std::experimental::element_aligned)).copy_to(&result[i], std::experimental::element_aligned);
+  if (i < N && N >= L) {
+    ReverseSimd(simd_type(&vector[0], std::experimental::element_aligned)).copy_to(&result[N - L], std::experimental::element_aligned);
+    return;
+  }
+  std::reverse_copy(&vector[0], &vector[N - i], &result[i]);
+}
+
+// Reverse at every element width, in place and into a second buffer. N counts elements; compare
+// bytes_per_second across widths.
+template <class T>
+void BM_ReverseVectorWidth(benchmark::State& state, void (*reverse)(T*, int)) {
+  if (!ValidateReverse<T>(state, "BM_ReverseVectorWidth/" + TypeKey<T>(), reverse)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ReverseCopyVector(benchmark::State& state, void (*reverse_copy)(const T*, T*, int)) {
+  if (!ValidateReverseCopy<T>(state, "BM_ReverseCopyVector/" + TypeKey<T>(), reverse_copy)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Element-wise kernels from L1-resident to DRAM-sized arrays (ElementwiseSweep), with bytes/s and
+// FLOP/s to set against the machine's peaks: add out = a + b, AXPY y = alpha * x + y, FMA
+// out = a * x + b and the triad out = b + q * c.
+// libstdc++'s std::experimental::fma goes lane by lane through scalar vfmadd132sd, several times
+// slower than plain arithmetic on L1-resident arrays. a * x + b on simd values is contracted into one
+// vector vfmadd instead, since GCC defaults to -ffp-contract=fast.
+void AddArrays(const double* a, const double* b, double* out, int N) {
+  using simd_type = std::experimental::native_simd<double>;
+  constexpr int L = simd_type::size();
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    simd_type av(&a[i], std::experimental::element_aligned), bv(&b[i], std::experimental::element_aligned);
+    (av + bv).copy_to(&out[i], std::experimental::element_aligned);
+  }
+  for (; i < N; ++i)
+    out[i] = a[i] + b[i];
+}
+
+void Axpy(double alpha, const double* x, double* y, int N) {
+  using simd_type = std::experimental::native_simd<double>;
+  constexpr int L = simd_type::size();
+  const simd_type va(alpha);
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    simd_type xv(&x[i], std::experimental::element_aligned), yv(&y[i], std::experimental::element_aligned);
+    (va * xv + yv).copy_to(&y[i], std::experimental::element_aligned);
+  }
+  for (; i < N; ++i)
+    y[i] = alpha * x[i] + y[i];
+}
+
+void MultiplyAdd(const double* a, const double* x, const double* b, double* out, int N) {
+  using simd_type = std::experimental::native_simd<double>;
+  constexpr int L = simd_type::size();
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    simd_type av(&a[i], std::experimental::element_aligned), xv(&x[i], std::experimental::element_aligned), bv(&b[i], std::experimental::element_aligned);
+    (av * xv + bv).copy_to(&out[i], std::experimental::element_aligned);
+  }
+  for (; i < N; ++i)
+    out[i] = a[i] * x[i] + b[i];
+}
+
+void Triad(const double* b, const double* c, double q, double* out, int N) {
+  using simd_type = std::experimental::native_simd<double>;
+  constexpr int L = simd_type::size();
+  const simd_type vq(q);
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    simd_type bv(&b[i], std::experimental::element_aligned), cv(&c[i], std::experimental::element_aligned);
+    (bv + vq * cv).copy_to(&out[i], std::experimental::element_aligned);
+  }
+  for (; i < N; ++i)
+    out[i] = b[i] + q * c[i];
+}
+
+void BM_AddArrays(benchmark::State& state) {
+  if (!ValidateAdd(state, "BM_AddArrays", AddArrays)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    AddArrays(v.a.data(), v.b.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 1);
+}
+BENCHMARK(BM_AddArrays)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Axpy(benchmark::State& state) {
+  if (!ValidateAxpy(state, "BM_Axpy", Axpy)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Axpy(kElementwiseScale, v.a.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Axpy)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_MultiplyAdd(benchmark::State& state) {
+  if (!ValidateMultiplyAdd(state, "BM_MultiplyAdd", MultiplyAdd)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    MultiplyAdd(v.a.data(), v.b.data(), v.c.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
     benchmark::ClobberMemory();
   }
+
+  SetElementwiseCounters(state, N, 4, 2);
 }
-BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_MultiplyAdd)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Triad(benchmark::State& state) {
+  if (!ValidateTriad(state, "BM_Triad", Triad)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Triad(v.b.data(), v.c.data(), kElementwiseScale, v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Triad)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+} // namespace
 
-BENCHMARK_MAIN();
+BACKEND_MAIN();
@@ -0,0 +1,659 @@
+// Differential validation of the kernels against scalar references, run before the timed loop.
+//
+// A benchmark calls e.g. `if (!ValidateFind(state, "BM_FindInVector", kernel)) return;` first. The
+// kernel then runs on randomized inputs from a fixed seed: every size up to 80 (all vector tails of
+// every width), the sizes around 128 and 256, the headline sizes 4096 and 4097 with 4111 and 4127,
+// and random sizes up to 10000, each at another offset from a 64-byte boundary. The sizes are fixed
+// rather than taken from the running benchmark: one check per key serves every argument, so the
+// larger sweep sizes and the offsets of the alignment benchmarks are not validated themselves.
+// Output buffers have guard elements after the end.
+// On the first result that differs from the reference, or a guard that was overwritten, the
+// benchmark skips with an error describing the input, and Google Benchmark reports the error instead
+// of a timing. Each key is validated once per process, as the benchmark function runs again for
+// every repetition. Floating-point kernels get inputs on which the order of the additions and a
+// fused or separate multiply-add cannot change the result, so they are compared exactly too.
+//
+// alignment is the alignment the kernel requires of its pointers, e.g. 32 for one that uses aligned
+// 256-bit loads; the offsets are its multiples below 64, so every kernel sees every position within
+// a cache line that it supports.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "aligned-buffer.h"
+
+namespace {
+
+struct ValidationCase {
+  int n;
+  std::size_t offset;  // bytes past a 64-byte boundary
+};
+
+// The same sizes for every kernel, independent of any benchmark's arguments; the offsets step through
+// the multiples of alignment below 64 bytes.
+inline std::vector<ValidationCase> ValidationCases(std::size_t alignment) {
+  std::vector<int> sizes;
+  for (int n = 0; n <= 80; ++n)
+    sizes.push_back(n);
+  for (int n : {127, 128, 129, 255, 256, 257, 4096, 4097, 4111, 4127})
+    sizes.push_back(n);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> size(81, 10000);
+  for (int k = 0; k < 16; ++k)
+    sizes.push_back(size(rng));
+
+  std::vector<ValidationCase> cases;
+  std::size_t slots = std::max<std::size_t>(64 / alignment, 1);
+  for (std::size_t i = 0; i < sizes.size(); ++i)
+    cases.push_back({sizes[i], i % slots * alignment});
+  return cases;
+}
+
+// Elements past the end of every output buffer that a kernel must leave alone.
+constexpr int kValidationGuard = 16;
+
+// Fills data[n, n + kValidationGuard) with a pattern, and checks it is still there.
+template <class T>
+void SetGuard(T* data, int n) {
+  std::memset(static_cast<void*>(data + n), 0xa5, kValidationGuard * sizeof(T));
+}
+
+template <class T>
+bool GuardIntact(const T* data, int n) {
+  const unsigned char* guard = reinterpret_cast<const unsigned char*>(data + n);
+  return std::all_of(guard, guard + kValidationGuard * sizeof(T), [](unsigned char b) { return b == 0xa5; });
+}
+
+inline std::string Mismatch(const ValidationCase& c, const std::string& what) {
+  return "differs from the scalar reference at n=" + std::to_string(c.n) + ", offset " + std::to_string(c.offset) + " B: " + what;
+}
+
+// Runs check() the first time key is seen, and skips state with its message if it found a
+// mismatch. The key names the kernel under test, by convention the benchmark function and whatever
+// picks the kernel in it, e.g. "BM_SumVector/avx2" or "BM_SumVectorParallel/8": each benchmark
+// function runs once per argument and repetition, but each kernel only needs checking once.
+template <class Check>
+bool Validated(benchmark::State& state, const std::string& key, Check check) {
+  static std::map<std::string, std::string> results;
+  auto [it, inserted] = results.try_emplace(key);
+  if (inserted) it->second = check();
+  if (!it->second.empty()) state.SkipWithError(it->second.c_str());
+  return it->second.empty();
+}
+
+// "i32", "u8", "f64" and so on, for the keys of kernels templated on their element type.
+template <class T>
+std::string TypeKey() {
+  return (std::is_floating_point_v<T> ? "f" : std::is_signed_v<T> ? "i" : "u") + std::to_string(sizeof(T) * 8);
+}
+
+// Where the find validators put their matches in a buffer of n: nowhere, first, last, at a random
+// position, and at two random positions.
+inline std::vector<std::vector<int>> FindPlacements(int n, std::mt19937_64& rng) {
+  std::vector<std::vector<int>> placements = {{}};
+  if (n > 0) {
+    std::uniform_int_distribution<int> position(0, n - 1);
+    int p = position(rng), q = position(rng);
+    placements.insert(placements.end(), {{0}, {n - 1}, {p}, {std::min(p, q), std::max(p, q)}});
+  }
+  return placements;
+}
+
+// find(data, n, target) returns the index of the first target, or -1. Every size runs with the
+// target absent, first, last, at a random position, and twice, on random background values.
+template <class Find>
+bool ValidateFind(benchmark::State& state, const std::string& key, Find find, std::size_t alignment = alignof(int)) {
+  return Validated(state, key, [&] {
+    const int target = 456;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> other(-1000, 1000);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<int> buffer(c.n, 64, c.offset);
+      int* data = buffer.data();
+      for (const std::vector<int>& positions : FindPlacements(c.n, rng)) {
+        for (int i = 0; i < c.n; ++i) {
+          int x = other(rng);
+          data[i] = x == target ? x + 1 : x;
+        }
+        for (int p : positions)
+          data[p] = target;
+        int64_t expected = positions.empty() ? -1 : positions.front();
+        int64_t res = find(data, c.n, target);
+        if (res != expected) return Mismatch(c, "returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+      }
+    }
+    return std::string();
+  });
+}
+
+// find_all(data, n, target, out) writes the index of every target to out in increasing order and
+// returns how many there are. Every size runs with no, 1/16, half and all elements matching; out
+// has room for n indices and a guard after them.
+template <class FindAll>
+bool ValidateFindAll(benchmark::State& state, const std::string& key, FindAll find_all, std::size_t alignment = alignof(int)) {
+  return Validated(state, key, [&] {
+    const int target = 456;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> other(-1000, 1000);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<int> buffer(c.n, 64, c.offset);
+      aligned_buffer<uint32_t> out(c.n + kValidationGuard, 64, c.offset);
+      int* data = buffer.data();
+      for (double density : {0.0, 1.0 / 16, 0.5, 1.0}) {
+        std::bernoulli_distribution match(density);
+        std::vector<uint32_t> expected;
+        for (int i = 0; i < c.n; ++i) {
+          int x = other(rng);
+          data[i] = match(rng) ? target : x == target ? x + 1 : x;
+          if (data[i] == target) expected.push_back(i);
+        }
+        SetGuard(out.data(), c.n);
+        int64_t count = find_all(data, c.n, target, out.data());
+        if (count != int64_t(expected.size())) return Mismatch(c, "returned " + std::to_string(count) + " matches, expected " + std::to_string(expected.size()));
+        if (!std::equal(expected.begin(), expected.end(), out.data())) return Mismatch(c, "wrong indices");
+        if (!GuardIntact(out.data(), c.n)) return Mismatch(c, "wrote past the end");
+      }
+    }
+    return std::string();
+  });
+}
+
+// find_any(data, n, keys, k) returns the index of the first element that is one of the k keys, or
+// -1. Every size runs with 1 to 64 keys drawn from the background range, so the hash filters of the
+// larger sets see false positives, and the matches placed as in ValidateFind.
+template <class FindAny>
+bool ValidateFindAny(benchmark::State& state, const std::string& key, FindAny find_any, std::size_t alignment = alignof(int)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-1000, 1000);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<int> buffer(c.n, 64, c.offset);
+      int* data = buffer.data();
+      for (int k : {1, 2, 8, 9, 16, 64}) {
+        std::vector<int> keys;
+        while (int(keys.size()) < k) {
+          int x = value(rng);
+          if (std::find(keys.begin(), keys.end(), x) == keys.end()) keys.push_back(x);
+        }
+        std::uniform_int_distribution<int> key(0, k - 1);
+        for (const std::vector<int>& positions : FindPlacements(c.n, rng)) {
+          for (int i = 0; i < c.n; ++i) {
+            do data[i] = value(rng);
+            while (std::find(keys.begin(), keys.end(), data[i]) != keys.end());
+          }
+          for (int p : positions)
+            data[p] = keys[key(rng)];
+          int64_t expected = positions.empty() ? -1 : positions.front();
+          int64_t res = find_any(data, c.n, keys.data(), k);
+          if (res != expected) return Mismatch(c, std::to_string(k) + " keys returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+        }
+      }
+    }
+    return std::string();
+  });
+}
+
+// find(data, n, target) returns the index of the first byte equal to target, or -1, placed as in
+// ValidateFind, for a target below 0x80 and one above.
+template <class FindByte>
+bool ValidateFindByte(benchmark::State& state, const std::string& key, FindByte find, std::size_t alignment = 1) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> other(0, 255);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<uint8_t> buffer(c.n, 64, c.offset);
+      uint8_t* data = buffer.data();
+      for (uint8_t target : {uint8_t('\n'), uint8_t(0xe9)}) {
+        for (const std::vector<int>& positions : FindPlacements(c.n, rng)) {
+          for (int i = 0; i < c.n; ++i) {
+            uint8_t x = other(rng);
+            data[i] = x == target ? x + 1 : x;
+          }
+          for (int p : positions)
+            data[p] = target;
+          int64_t expected = positions.empty() ? -1 : positions.front();
+          int64_t res = find(data, c.n, target);
+          if (res != expected) return Mismatch(c, "byte " + std::to_string(target) + " returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+        }
+      }
+    }
+    return std::string();
+  });
+}
+
+// find(text, n, needle, m) returns the index of the first occurrence of the needle, or -1, for
+// needles of 1 to 33 bytes. The text only has the letters a and b, so first and last bytes keep
+// matching where the needle does not; each needle is taken from a random position of the text,
+// from its end, or made up, and the expected index is that of a naive search.
+template <class FindSubstring>
+bool ValidateFindSubstring(benchmark::State& state, const std::string& key, FindSubstring find, std::size_t alignment = 1) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> letter('a', 'b');
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<uint8_t> buffer(c.n, 64, c.offset);
+      uint8_t* text = buffer.data();
+      for (int i = 0; i < c.n; ++i)
+        text[i] = letter(rng);
+      for (int m : {1, 2, 3, 5, 8, 16, 17, 32, 33}) {
+        for (int source = 0; source < 3; ++source) {
+          std::vector<uint8_t> needle(m);
+          if (source < 2 && m <= c.n) {
+            int start = source == 0 ? std::uniform_int_distribution<int>(0, c.n - m)(rng) : c.n - m;
+            std::copy(text + start, text + start + m, needle.begin());
+          } else {
+            for (uint8_t& b : needle)
+              b = letter(rng);
+          }
+          int64_t expected = -1;
+          for (int i = 0; i + m <= c.n && expected < 0; ++i) {
+            if (std::equal(needle.begin(), needle.end(), text + i)) expected = i;
+          }
+          int64_t res = find(text, c.n, needle.data(), m);
+          if (res != expected) return Mismatch(c, std::to_string(m) + "-byte needle returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+        }
+      }
+    }
+    return std::string();
+  });
+}
+
+// sum(data, n) returns the int sum of data, wrapping on overflow.
+template <class Sum>
+bool ValidateSum(benchmark::State& state, const std::string& key, Sum sum, std::size_t alignment = alignof(int)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-1000, 1000);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<int> buffer(c.n, 64, c.offset);
+      uint32_t expected = 0;
+      for (int i = 0; i < c.n; ++i) {
+        buffer[i] = value(rng);
+        expected += uint32_t(buffer[i]);
+      }
+      int res = sum(buffer.data(), c.n);
+      if (res != int(expected)) return Mismatch(c, "returned " + std::to_string(res) + ", expected " + std::to_string(int(expected)));
+    }
+    return std::string();
+  });
+}
+
+// sum(data, n) returns the exact int64 sum. Each size runs on values from the whole int range, on
+// values just below INT32_MAX and just above INT32_MIN, where any 32-bit partial sum overflows
+// within two elements, and on iota from 0, the benchmark input. Two more sizes, 70000 and 2^20, go
+// past the ~65k elements at which the iota sum leaves int.
+template <class Sum>
+bool ValidateSumWide(benchmark::State& state, const std::string& key, Sum sum, std::size_t alignment = alignof(int)) {
+  return Validated(state, key, [&] {
+    using limits = std::numeric_limits<int>;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> any(limits::min(), limits::max());
+    std::uniform_int_distribution<int> large(limits::max() - 1000, limits::max());
+    std::vector<ValidationCase> cases = ValidationCases(alignment);
+    cases.insert(cases.end(), {{70000, 0}, {1 << 20, 0}});
+    for (const ValidationCase& c : cases) {
+      aligned_buffer<int> buffer(c.n, 64, c.offset);
+      const char* inputs[] = {"any int", "near INT32_MAX", "near INT32_MIN", "iota"};
+      for (int input = 0; input < 4; ++input) {
+        int64_t expected = 0;
+        for (int i = 0; i < c.n; ++i) {
+          buffer[i] = input == 0 ? any(rng) : input == 1 ? large(rng) : input == 2 ? -large(rng) - 1 : i;
+          expected += buffer[i];
+        }
+        int64_t res = sum(buffer.data(), c.n);
+        if (res != expected) return Mismatch(c, std::string(inputs[input]) + " returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+      }
+    }
+    return std::string();
+  });
+}
+
+// sum(data, n) returns the floating-point sum of data. The values are small integers, so every
+// partial sum is exact and any order of summation, pairwise and compensated included, has to
+// agree with the sequential one to the last bit.
+template <class T, class Sum>
+bool ValidateSumFloat(benchmark::State& state, const std::string& key, Sum sum, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-100, 100);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<T> buffer(c.n, 64, c.offset);
+      T expected = 0;
+      for (int i = 0; i < c.n; ++i) {
+        buffer[i] = T(value(rng));
+        expected += buffer[i];
+      }
+      T res = sum(buffer.data(), c.n);
+      if (res != expected) return Mismatch(c, "returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+    }
+    return std::string();
+  });
+}
+
+// extreme(data, n) returns the smallest element, or the largest one if largest is set, for n >= 1.
+// The values come from a range of 201 integers, so sizes past that have ties.
+template <class T, class Extreme>
+bool ValidateExtreme(benchmark::State& state, const std::string& key, Extreme extreme, bool largest, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-100, 100);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      if (c.n == 0) continue;
+      aligned_buffer<T> buffer(c.n, 64, c.offset);
+      for (int i = 0; i < c.n; ++i)
+        buffer[i] = T(value(rng));
+      T expected = largest ? *std::max_element(buffer.data(), buffer.data() + c.n) : *std::min_element(buffer.data(), buffer.data() + c.n);
+      T res = extreme(buffer.data(), c.n);
+      if (res != expected) return Mismatch(c, "returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+    }
+    return std::string();
+  });
+}
+
+// arg_extreme(data, n) returns the index of the first smallest element, or of the first largest one
+// if largest is set, for n >= 1, on the values of ValidateExtreme, so ties check the "first".
+template <class T, class ArgExtreme>
+bool ValidateArgExtreme(benchmark::State& state, const std::string& key, ArgExtreme arg_extreme, bool largest, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-100, 100);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      if (c.n == 0) continue;
+      aligned_buffer<T> buffer(c.n, 64, c.offset);
+      for (int i = 0; i < c.n; ++i)
+        buffer[i] = T(value(rng));
+      const T* best = largest ? std::max_element(buffer.data(), buffer.data() + c.n) : std::min_element(buffer.data(), buffer.data() + c.n);
+      int64_t expected = best - buffer.data();
+      int64_t res = arg_extreme(buffer.data(), c.n);
+      if (res != expected) return Mismatch(c, "returned " + std::to_string(res) + ", expected " + std::to_string(expected));
+    }
+    return std::string();
+  });
+}
+
+// scan(in, out, n) writes the inclusive prefix sums of in to out, or the exclusive ones starting at
+// 0. The values are small integers, so float scans are exact in any order as well.
+template <class T, class Scan>
+bool ValidateScan(benchmark::State& state, const std::string& key, Scan scan, bool inclusive, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-100, 100);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<T> in(c.n, 64, c.offset), out(c.n + kValidationGuard, 64, c.offset);
+      for (int i = 0; i < c.n; ++i)
+        in[i] = T(value(rng));
+      SetGuard(out.data(), c.n);
+      scan(in.data(), out.data(), c.n);
+      T total = 0;
+      for (int i = 0; i < c.n; ++i) {
+        if (inclusive) total += in[i];
+        if (out[i] != total) return Mismatch(c, "element " + std::to_string(i) + " is " + std::to_string(out[i]) + ", expected " + std::to_string(total));
+        if (!inclusive) total += in[i];
+      }
+      if (!GuardIntact(out.data(), c.n)) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+// reverse(data, n) reverses data in place.
+template <class T, class Reverse>
+bool ValidateReverse(benchmark::State& state, const std::string& key, Reverse reverse, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<T> buffer(c.n + kValidationGuard, 64, c.offset);
+      std::vector<T> expected(c.n);
+      for (int i = 0; i < c.n; ++i)
+        buffer[i] = expected[c.n - 1 - i] = T(rng());
+      SetGuard(buffer.data(), c.n);
+      reverse(buffer.data(), c.n);
+      if (!std::equal(expected.begin(), expected.end(), buffer.data())) return Mismatch(c, "wrong order");
+      if (!GuardIntact(buffer.data(), c.n)) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+// reverse_copy(in, out, n) writes in reversed to out.
+template <class T, class ReverseCopy>
+bool ValidateReverseCopy(benchmark::State& state, const std::string& key, ReverseCopy reverse_copy, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<T> in(c.n, 64, c.offset), out(c.n + kValidationGuard, 64, c.offset);
+      for (int i = 0; i < c.n; ++i)
+        in[i] = T(rng());
+      SetGuard(out.data(), c.n);
+      reverse_copy(in.data(), out.data(), c.n);
+      if (!std::equal(in.data(), in.data() + c.n, std::reverse_iterator<T*>(out.data() + c.n))) return Mismatch(c, "wrong order");
+      if (!GuardIntact(out.data(), c.n)) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+// add(a, b, result) adds the four doubles of a and b, as BM_AddVectors does. Only the offsets vary;
+// the kernels over n elements are ValidateAdd's.
+template <class Add>
+bool ValidateAddVectors(benchmark::State& state, const std::string& key, Add add, std::size_t alignment = alignof(double)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> value(-1000, 1000);
+    for (ValidationCase c : ValidationCases(alignment)) {
+      c.n = 4;
+      aligned_buffer<double> a(4, 64, c.offset), b(4, 64, c.offset), result(4 + kValidationGuard, 64, c.offset);
+      for (int i = 0; i < 4; ++i) {
+        a[i] = value(rng);
+        b[i] = value(rng);
+      }
+      SetGuard(result.data(), 4);
+      add(a.data(), b.data(), result.data());
+      for (int i = 0; i < 4; ++i) {
+        if (result[i] != a[i] + b[i]) return Mismatch(c, "element " + std::to_string(i) + " is " + std::to_string(result[i]) + ", expected " + std::to_string(a[i] + b[i]));
+      }
+      if (!GuardIntact(result.data(), 4)) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+// The operands of the element-wise validators: arrays of n doubles k / 4 for integers k up to 4000
+// in magnitude, all at the case's offset. The product of two of them, or of one and a scale like
+// 1.5, plus a third is exact in a double, so a fused multiply-add and a multiply and an add both
+// match the reference to the last bit.
+class ElementwiseOperands {
+ public:
+  ElementwiseOperands(const ValidationCase& c, int arrays, std::mt19937_64& rng)
+      : n_(c.n), stride_((c.n + kValidationGuard + 7) / 8 * 8), buffer_(arrays * stride_, 64, c.offset) {
+    std::uniform_int_distribution<int> value(-4000, 4000);
+    for (int k = 0; k < arrays; ++k) {
+      for (int i = 0; i < n_; ++i)
+        (*this)[k][i] = value(rng) / 4.0;
+    }
+  }
+
+  double* operator[](int k) { return buffer_.data() + k * stride_; }
+
+  // Compares out with expected(i) and checks the guard that SetGuard(out, n) left after it.
+  template <class Expected>
+  std::string Check(const ValidationCase& c, const double* out, Expected expected) const {
+    for (int i = 0; i < n_; ++i) {
+      if (out[i] != expected(i)) return Mismatch(c, "element " + std::to_string(i) + " is " + std::to_string(out[i]) + ", expected " + std::to_string(expected(i)));
+    }
+    if (!GuardIntact(out, n_)) return Mismatch(c, "wrote past the end");
+    return std::string();
+  }
+
+ private:
+  int n_;
+  int stride_;  // a multiple of 64 bytes, so every array has the same offset
+  aligned_buffer<double> buffer_;
+};
+
+// add(a, b, out, n): out[i] = a[i] + b[i].
+template <class Add>
+bool ValidateAdd(benchmark::State& state, const std::string& key, Add add, std::size_t alignment = alignof(double)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      ElementwiseOperands v(c, 3, rng);
+      double *a = v[0], *b = v[1], *out = v[2];
+      SetGuard(out, c.n);
+      add(a, b, out, c.n);
+      if (std::string error = v.Check(c, out, [&](int i) { return a[i] + b[i]; }); !error.empty()) return error;
+    }
+    return std::string();
+  });
+}
+
+// axpy(alpha, x, y, n): y[i] = alpha * x[i] + y[i], with alpha 1.5.
+template <class Axpy>
+bool ValidateAxpy(benchmark::State& state, const std::string& key, Axpy axpy, std::size_t alignment = alignof(double)) {
+  return Validated(state, key, [&] {
+    const double alpha = 1.5;
+    std::mt19937_64 rng(42);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      ElementwiseOperands v(c, 2, rng);
+      double *x = v[0], *y = v[1];
+      std::vector<double> y0(y, y + c.n);
+      SetGuard(y, c.n);
+      axpy(alpha, x, y, c.n);
+      if (std::string error = v.Check(c, y, [&](int i) { return alpha * x[i] + y0[i]; }); !error.empty()) return error;
+    }
+    return std::string();
+  });
+}
+
+// fma(a, x, b, out, n): out[i] = a[i] * x[i] + b[i].
+template <class MultiplyAdd>
+bool ValidateMultiplyAdd(benchmark::State& state, const std::string& key, MultiplyAdd fma, std::size_t alignment = alignof(double)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      ElementwiseOperands v(c, 4, rng);
+      double *a = v[0], *x = v[1], *b = v[2], *out = v[3];
+      SetGuard(out, c.n);
+      fma(a, x, b, out, c.n);
+      if (std::string error = v.Check(c, out, [&](int i) { return a[i] * x[i] + b[i]; }); !error.empty()) return error;
+    }
+    return std::string();
+  });
+}
+
+// triad(b, c, q, out, n): out[i] = b[i] + q * c[i], with q 1.5.
+template <class Triad>
+bool ValidateTriad(benchmark::State& state, const std::string& key, Triad triad, std::size_t alignment = alignof(double)) {
+  return Validated(state, key, [&] {
+    const double q = 1.5;
+    std::mt19937_64 rng(42);
+    for (const ValidationCase& vc : ValidationCases(alignment)) {
+      ElementwiseOperands v(vc, 3, rng);
+      double *b = v[0], *c = v[1], *out = v[2];
+      SetGuard(out, vc.n);
+      triad(b, c, q, out, vc.n);
+      if (std::string error = v.Check(vc, out, [&](int i) { return b[i] + q * c[i]; }); !error.empty()) return error;
+    }
+    return std::string();
+  });
+}
+
+// convert(from, to, n) transposes n records of Fields values of T from array-of-structs (field j
+// of record i at aos[i * Fields + j]) to struct-of-arrays (at soa[j * n + i]), or back if to_soa is
+// not set.
+template <class T, int Fields, class Transpose>
+bool ValidateTranspose(benchmark::State& state, const std::string& key, Transpose convert, bool to_soa, std::size_t alignment = alignof(T)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-1000000, 1000000);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      int size = Fields * c.n;
+      aligned_buffer<T> from(size, 64, c.offset), to(size + kValidationGuard, 64, c.offset);
+      for (int i = 0; i < size; ++i)
+        from[i] = T(value(rng));
+      SetGuard(to.data(), size);
+      convert(from.data(), to.data(), c.n);
+      for (int i = 0; i < c.n; ++i) {
+        for (int j = 0; j < Fields; ++j) {
+          T aos = to_soa ? from[i * Fields + j] : to[i * Fields + j];
+          T soa = to_soa ? to[j * c.n + i] : from[j * c.n + i];
+          if (aos != soa) return Mismatch(c, "field " + std::to_string(j) + " of record " + std::to_string(i) + " moved wrong");
+        }
+      }
+      if (!GuardIntact(to.data(), size)) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+// norm(records, out, n): out[i] = x * x + y * y + z * z + w * w for n records of 4 doubles, stored
+// as struct-of-arrays if soa is set and as array-of-structs otherwise. The values are integers up
+// to 1000, so the sum is exact in any order.
+template <class SquaredNorm>
+bool ValidateSquaredNorm(benchmark::State& state, const std::string& key, SquaredNorm norm, bool soa, std::size_t alignment = alignof(double)) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> value(-1000, 1000);
+    for (const ValidationCase& c : ValidationCases(alignment)) {
+      aligned_buffer<double> records(4 * c.n, 64, c.offset), out(c.n + kValidationGuard, 64, c.offset);
+      for (int i = 0; i < 4 * c.n; ++i)
+        records[i] = value(rng);
+      SetGuard(out.data(), c.n);
+      norm(records.data(), out.data(), c.n);
+      for (int i = 0; i < c.n; ++i) {
+        double expected = 0;
+        for (int j = 0; j < 4; ++j) {
+          double x = soa ? records[j * c.n + i] : records[i * 4 + j];
+          expected += x * x;
+        }
+        if (out[i] != expected) return Mismatch(c, "record " + std::to_string(i) + " is " + std::to_string(out[i]) + ", expected " + std::to_string(expected));
+      }
+      if (!GuardIntact(out.data(), c.n)) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+// search(sorted, n, queries, q, found) writes to found[j] the first of the n sorted keys that is not
+// below queries[j], or INT32_MAX if there is none, building whatever layout it searches first. The
+// keys are increasing with random gaps; the queries are every key, the values on either side of it,
+// and values below and above all keys.
+template <class LowerBound>
+bool ValidateLowerBound(benchmark::State& state, const std::string& key, LowerBound search) {
+  return Validated(state, key, [&] {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> gap(1, 3);
+    for (const ValidationCase& c : ValidationCases(alignof(int))) {
+      std::vector<int> sorted(c.n), queries = {std::numeric_limits<int>::min(), -1000000};
+      int key = -100000;
+      for (int i = 0; i < c.n; ++i) {
+        sorted[i] = key += gap(rng);
+        queries.insert(queries.end(), {key - 1, key, key + 1});
+      }
+      queries.push_back(key + 1000000);
+      std::vector<int> found(queries.size() + kValidationGuard);
+      SetGuard(found.data(), queries.size());
+      search(sorted.data(), c.n, queries.data(), queries.size(), found.data());
+      for (std::size_t j = 0; j < queries.size(); ++j) {
+        const int* first = std::lower_bound(sorted.data(), sorted.data() + c.n, queries[j]);
+        int expected = first == sorted.data() + c.n ? std::numeric_limits<int>::max() : *first;
+        if (found[j] != expected) return Mismatch(c, "query " + std::to_string(queries[j]) + " found " + std::to_string(found[j]) + ", expected " + std::to_string(expected));
+      }
+      if (!GuardIntact(found.data(), queries.size())) return Mismatch(c, "wrote past the end");
+    }
+    return std::string();
+  });
+}
+
+} // namespace
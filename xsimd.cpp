@@ -1,22 +1,32 @@
 //TO COMPILE: g++ xsimd.cpp -isystem benchmark/include -Lbenchmark/build/src -lbenchmark -lpthread -std=c++2a -O3 -fno-tree-vectorize -march=native -DNDEBUG -I/usr/local/include/xsimd -o xsimd
 
 #define XSIMD_DEFAULT_ARCH xsimd::avx2
+#include <cmath>
 #include <numeric>
 #include <algorithm>
 #include "xsimd/xsimd.hpp"
 #include <benchmark/benchmark.h>
+#include "bench-utils.h"
 
-void BM_AddVectors(benchmark::State& state) {
-  double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
-  double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
-  double result[4];
+namespace {
+
+// The stack arrays of BM_AddVectors are aligned for the aligned loads and store.
+void AddVectors(const double* data_a, const double* data_b, double* result) {
+  xsimd::batch<double, xsimd::avx2> a = xsimd::load_aligned(&data_a[0]);
+  xsimd::batch<double, xsimd::avx2> b = xsimd::load_aligned(&data_b[0]);
+  xsimd::batch<double, xsimd::avx2> res = a + b;
 
-  for (auto _ : state) {
-    xsimd::batch<double, xsimd::avx2> a = xsimd::load_aligned(&data_a[0]);
-    xsimd::batch<double, xsimd::avx2> b = xsimd::load_aligned(&data_a[0]);
-    xsimd::batch<double, xsimd::avx2> res = a + b;
+  res.store_aligned(&result[0]);
+}
+
+void BM_AddVectors(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors, 32)) return;
+  alignas(32) double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double result[4];
 
-    res.store_aligned(&result[0]);
+  for (auto _ : PerfLoop(state)) {
+    AddVectors(data_a, data_b, result);
 
     benchmark::DoNotOptimize(result);
     benchmark::ClobberMemory();
@@ -24,163 +34,998 @@ void BM_AddVectors(benchmark::State& state) {
 }
 BENCHMARK(BM_AddVectors)->Args({1, 2, 3, 4})->MinTime(0.5)->Repetitions(1000);
 
+// BM_AddVectors timed call by call in TSC cycles, see cycle-timer.h.
+void BM_AddVectorsCycles(benchmark::State& state) {
+  if (!ValidateAddVectors(state, "BM_AddVectors", AddVectors, 32)) return;
+  alignas(32) double data_a[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double data_b[4] = {(double) state.range(0), (double) state.range(1), (double) state.range(2), (double) state.range(3)};
+  alignas(32) double result[4];
+
+  TimeCycles(state, 4, [&] {
+    AddVectors(data_a, data_b, result);
+
+    benchmark::DoNotOptimize(result);
+    benchmark::ClobberMemory();
+  });
+}
+BENCHMARK(BM_AddVectorsCycles)->Args({1, 2, 3, 4})->Iterations(kCycleSamples)->Repetitions(10);
+
+int FindInVector(const int* vector, int N, int target) {
+  using batch_type = xsimd::batch<int, xsimd::avx2>;
+  int res = -1;
+  batch_type simd_target(target);
+
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    batch_type simd_vector = xsimd::load_aligned(&vector[i]);
+    auto mask = simd_vector == simd_target;
+
+    if (xsimd::any(mask)) {
+      for (int j = 0; j < 8; ++j) {
+        if (mask.get(j)) {
+          res = i + j;
+          break;
+        }
+      }
+      break;
+    }
+  }
+
+  // Scalar epilogue for the last N % 8 elements.
+  for (; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
+  }
+  return res;
+}
+
 void BM_FindInVector(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVector", FindInVector, 32)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  using batch_type = xsimd::batch<int, xsimd::avx2>;
-  for (auto _ : state) {
-    batch_type simd_target(target);
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVector(vector, N, target);
 
-    for (int i = 0; i < N; i += 8) {
-      batch_type simd_vector = xsimd::load_aligned(&vector[i]);
-      auto mask = simd_vector == simd_target;
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
 
-      if (xsimd::any(mask)) {
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVector)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+int FindInVectorFaster(const int* vector, int N, int target) {
+  using batch_type = xsimd::batch<int, xsimd::avx2>;
+  int res = -1;
+  batch_type simd_target(target);
+
+  int i = 0;
+  for (; i + 32 <= N; i += 32) {
+    batch_type simd_vector1 = xsimd::load_aligned(&vector[i]);
+    batch_type simd_vector2 = xsimd::load_aligned(&vector[i + 8]);
+    batch_type simd_vector3 = xsimd::load_aligned(&vector[i + 16]);
+    batch_type simd_vector4 = xsimd::load_aligned(&vector[i + 24]);
+    auto mask1 = simd_vector1 == simd_target;
+    auto mask2 = simd_vector2 == simd_target;
+    auto mask12 = mask1 || mask2;
+    auto mask3 = simd_vector3 == simd_target;
+    auto mask4 = simd_vector4 == simd_target;
+    auto mask23 = mask3 || mask4;
+    auto mask = mask12 || mask23;
+    if (xsimd::any(mask)) {
+      if (xsimd::any(mask1)) {
         for (int j = 0; j < 8; ++j) {
-          if (mask.get(j)) {
+          if (mask1.get(j)) {
             res = i + j;
             break;
           }
         }
         break;
       }
+      if (xsimd::any(mask2)) {
+        for (int j = 0; j < 8; ++j) {
+          if (mask2.get(j)) {
+            res = i + j + 8;
+            break;
+          }
+        }
+        break;
+      }
+      if (xsimd::any(mask3)) {
+        for (int j = 0; j < 8; ++j) {
+          if (mask3.get(j)) {
+            res = i + j + 16;
+            break;
+          }
+        }
+        break;
+      }
+      if (xsimd::any(mask4)) {
+        for (int j = 0; j < 8; ++j) {
+          if (mask4.get(j)) {
+            res = i + j + 24;
+            break;
+          }
+        }
+        break;
+      }
     }
+  }
 
-    benchmark::DoNotOptimize(res);
-    benchmark::ClobberMemory();
+  // Scalar epilogue for the last N % 32 elements.
+  for (; res == -1 && i < N; ++i) {
+    if (vector[i] == target) res = i;
   }
+  return res;
 }
-BENCHMARK(BM_FindInVector)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_FindInVectorFaster(benchmark::State& state) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster, 32)) return;
   int target = state.range(0);
   int N = state.range(1);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::fill(vector, vector + N, 0);
   vector[state.range(2)] = target;
   int res = -1;
 
-  using batch_type = xsimd::batch<int, xsimd::avx2>;
-  for (auto _ : state) {
-    batch_type simd_target(target);
-
-    for (int i = 0; i < N; i += 32) {
-      batch_type simd_vector1 = xsimd::load_aligned(&vector[i]);
-      batch_type simd_vector2 = xsimd::load_aligned(&vector[i + 8]);
-      batch_type simd_vector3 = xsimd::load_aligned(&vector[i + 16]);
-      batch_type simd_vector4 = xsimd::load_aligned(&vector[i + 24]);
-      auto mask1 = simd_vector1 == simd_target;
-      auto mask2 = simd_vector2 == simd_target;
-      auto mask12 = mask1 || mask2;
-      auto mask3 = simd_vector3 == simd_target;
-      auto mask4 = simd_vector4 == simd_target;
-      auto mask23 = mask3 || mask4;
-      auto mask = mask12 || mask23;
-      if (xsimd::any(mask)) {
-        if (xsimd::any(mask1)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask1.get(j)) {
-              res = i + j;
-              break;
-            }
-          }
-          break;
-        }
-        if (xsimd::any(mask2)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask2.get(j)) {
-              res = i + j + 8;
-              break;
-            }
-          }
-          break;
-        }
-        if (xsimd::any(mask3)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask3.get(j)) {
-              res = i + j + 16;
-              break;
-            }
-          }
-          break;
-        }
-        if (xsimd::any(mask4)) {
-          for (int j = 0; j < 8; ++j) {
-            if (mask4.get(j)) {
-              res = i + j + 24;
-              break;
-            }
-          }
-          break;
-        }
+  for (auto _ : PerfLoop(state)) {
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  // Elements the kernel has to look at to find the first match.
+  SetThroughput(state, state.range(2) + 1, (state.range(2) + 1) * sizeof(int));
+}
+BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->Args({456, 4097, 4096})->Args({456, 4111, 4110})->Args({456, 4127, 4126})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_FindInVectorFaster)->Apply(FindSweep)->MinTime(0.5)->Repetitions(10);
+
+// The early-exit find on the FindScenario inputs, which move the target on every call so the exit
+// cannot be learned (see FindScenarioInput in bench-utils.h).
+void BM_FindInVectorScenario(benchmark::State& state, FindScenario scenario) {
+  if (!ValidateFind(state, "BM_FindInVectorFaster", FindInVectorFaster, 32)) return;
+  int target = state.range(0);
+  int N = state.range(1);
+  FindScenarioInput input(scenario, target, N);
+  int* vector = input.data();
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    input.Next();
+    res = FindInVectorFaster(vector, N, target);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  input.SetThroughput(state);
+}
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_position, FindScenario::random_position)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, absent, FindScenario::absent)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, near_start, FindScenario::near_start)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, duplicates, FindScenario::duplicates)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_FindInVectorScenario, random_data, FindScenario::random_data)->Apply(FindScenarioArgs)->MinTime(0.5)->Repetitions(10);
+
+// memchr and a first/last-byte-filtered substring search over 32-byte batches. N counts bytes.
+using byte_batch = xsimd::batch<uint8_t, xsimd::avx2>;
+
+int FindByte(const uint8_t* text, int N, uint8_t target) {
+  constexpr int L = byte_batch::size;
+  byte_batch simd_target(target);
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    auto mask = byte_batch::load_unaligned(&text[i]) == simd_target;
+    if (xsimd::any(mask)) {
+      for (int j = 0; j < L; ++j) {
+        if (mask.get(j)) return i + j;
+      }
+    }
+  }
+
+  // Scalar epilogue for the last N % 32 bytes.
+  for (; i < N; ++i) {
+    if (text[i] == target) return i;
+  }
+  return -1;
+}
+
+// Candidates are the positions where the first needle byte matches and the last one matches M - 1
+// bytes further on; only those are compared in full.
+int FindSubstring(const uint8_t* text, int N, const uint8_t* needle, int M) {
+  if (M == 0) return 0;
+  constexpr int L = byte_batch::size;
+  byte_batch first(needle[0]);
+  byte_batch last(needle[M - 1]);
+  int i = 0;
+
+  for (; i + M - 1 + L <= N; i += L) {
+    auto mask = (byte_batch::load_unaligned(&text[i]) == first) && (byte_batch::load_unaligned(&text[i + M - 1]) == last);
+    if (xsimd::any(mask)) {
+      for (int j = 0; j < L; ++j) {
+        if (mask.get(j) && std::equal(needle + 1, needle + M, &text[i + j + 1])) return i + j;
       }
     }
+  }
+
+  for (; i + M <= N; ++i) {
+    if (std::equal(needle, needle + M, &text[i])) return i;
+  }
+  return -1;
+}
+
+void BM_FindByte(benchmark::State& state) {
+  if (!ValidateFindByte(state, "BM_FindByte", FindByte)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  text[state.range(1)] = kDelimiter;
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindByte(text, N, kDelimiter);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != state.range(1)) state.SkipWithError("FindByte returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindByte)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+void BM_FindSubstring(benchmark::State& state) {
+  if (!ValidateFindSubstring(state, "BM_FindSubstring", FindSubstring)) return;
+  int N = state.range(0);
+  aligned_buffer<uint8_t> buffer(N);
+  uint8_t* text = buffer.data();
+  FillLogText(text, N);
+  int start = PlaceNeedle(text, state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = FindSubstring(text, N, reinterpret_cast<const uint8_t*>(kNeedle), kNeedleSize);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != start) state.SkipWithError("FindSubstring returned the wrong index");
+  SetThroughput(state, state.range(1) + 1, state.range(1) + 1);
+}
+BENCHMARK(BM_FindSubstring)->Apply(ByteSearchArgs)->MinTime(0.5)->Repetitions(10);
+
+int SumVector(const int* vector, int N) {
+  using batch_type = xsimd::batch<int, xsimd::avx2>;
+  int res = 0;
+  batch_type s1(0);
+  batch_type s2(0);
+  
+  int i = 0;
+  for (; i + 16 <= N; i += 16) {
+    batch_type simd_vector1 = xsimd::load_aligned(&vector[i]);
+    batch_type simd_vector2 = xsimd::load_aligned(&vector[i + 8]);
+    s1 = s1 + simd_vector1;
+    s2 = s2 + simd_vector2;
+  }
+
+  batch_type s = s1 + s2;
+  alignas(32) int t[8];
+
+  s.store_aligned(&t[0]);
+  
+  for (int i = 0; i < 8; ++i) 
+    res += t[i];
+
+  // Scalar epilogue for the last N % 16 elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
 }
-BENCHMARK(BM_FindInVectorFaster)->Args({456, 4096, 3254})->MinTime(0.5)->Repetitions(1000);
 
 void BM_SumVector(benchmark::State& state) {
+  if (!ValidateSum(state, "BM_SumVector", SumVector, 32)) return;
   int N = state.range(1)-state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
   int res;
 
+  for (auto _ : PerfLoop(state)) {
+    res = SumVector(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Same sum accumulated in 64-bit lanes, exact where BM_SumVector wraps (iota inputs past ~65k
+// elements). Compare the two to see what the widening costs.
+int64_t SumVectorWide(const int* vector, int N) {
   using batch_type = xsimd::batch<int, xsimd::avx2>;
-  for (auto _ : state) {
-    res = 0;
-    batch_type s1(0);
-    batch_type s2(0);
-    
-    for (int i = 0; i < N; i += 16) {
-      batch_type simd_vector1 = xsimd::load_aligned(&vector[i]);
-      batch_type simd_vector2 = xsimd::load_aligned(&vector[i + 8]);
-      s1 = s1 + simd_vector1;
-      s2 = s2 + simd_vector2;
+  using wide_type = xsimd::batch<uint64_t, xsimd::avx2>;
+  int64_t res = 0;
+  // xsimd has no int32 -> int64 widening, so each batch of 8 ints is reinterpreted as 4 uint64
+  // pairs. Flipping the sign bit makes every int32 an unsigned value v + 2^31, which the low
+  // mask and the logical shift split into two zero-extended uint64 lanes. The bias is removed
+  // once at the end.
+  batch_type sign(INT32_MIN);
+  wide_type low_mask(0xffffffffu);
+  wide_type s1(0);
+  wide_type s2(0);
+
+  int i = 0;
+  for (; i + 8 <= N; i += 8) {
+    wide_type x = xsimd::bitwise_cast<uint64_t>(xsimd::load_aligned(&vector[i]) ^ sign);
+    s1 = s1 + (x & low_mask);
+    s2 = s2 + (x >> 32);
+  }
+
+  uint64_t t[4];
+
+  (s1 + s2).store_unaligned(&t[0]);
+
+  for (int i = 0; i < 4; ++i)
+    res += t[i];
+  res -= int64_t(i) << 31;
+
+  // Scalar epilogue for the last N % 8 elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
+}
+
+void BM_SumVectorWide(benchmark::State& state) {
+  if (!ValidateSumWide(state, "BM_SumVectorWide", SumVectorWide, 32)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
+  std::iota (vector, vector + N, state.range(0));
+  int64_t res;
+
+  for (auto _ : PerfLoop(state)) {
+    res = SumVectorWide(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_SumVectorWide)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_SumVectorWide)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Floating-point sums for float and double columns: plain vector accumulation, pairwise, and
+// Neumaier-compensated. Each reports its relative error against a long double reference.
+template <class T>
+T SumPlain(const T* vector, int N) {
+  using batch_type = xsimd::batch<T, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  batch_type s1(T(0)), s2(T(0)), s3(T(0)), s4(T(0));
+
+  int i = 0;
+  for (; i + 4 * L <= N; i += 4 * L) {
+    s1 = s1 + xsimd::load_unaligned(&vector[i]);
+    s2 = s2 + xsimd::load_unaligned(&vector[i + L]);
+    s3 = s3 + xsimd::load_unaligned(&vector[i + 2 * L]);
+    s4 = s4 + xsimd::load_unaligned(&vector[i + 3 * L]);
+  }
+  for (; i + L <= N; i += L)
+    s1 = s1 + xsimd::load_unaligned(&vector[i]);
+
+  T res = xsimd::reduce_add((s1 + s2) + (s3 + s4));
+
+  // Scalar epilogue for the last N % L elements.
+  for (; i < N; ++i)
+    res += vector[i];
+  return res;
+}
+
+// Halves on whole batches down to 32-batch blocks, so the error grows with log(N).
+template <class T>
+T SumPairwise(const T* vector, int N) {
+  constexpr int L = xsimd::batch<T, xsimd::avx2>::size;
+  if (N <= 32 * L) return SumPlain(vector, N);
+  int half = N / 2 / L * L;
+  return SumPairwise(vector, half) + SumPairwise(&vector[half], N - half);
+}
+
+// One Neumaier step per lane: the compensation keeps the rounding error of the smaller operand.
+template <class B>
+void NeumaierStep(B& s, B& c, B x) {
+  B t = s + x;
+  c = c + xsimd::select(xsimd::abs(s) >= xsimd::abs(x), (s - t) + x, (x - t) + s);
+  s = t;
+}
+
+template <class T>
+T SumCompensated(const T* vector, int N) {
+  using batch_type = xsimd::batch<T, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  batch_type s1(T(0)), c1(T(0)), s2(T(0)), c2(T(0));
+
+  int i = 0;
+  for (; i + 2 * L <= N; i += 2 * L) {
+    NeumaierStep(s1, c1, xsimd::load_unaligned(&vector[i]));
+    NeumaierStep(s2, c2, xsimd::load_unaligned(&vector[i + L]));
+  }
+
+  // Fold the lanes with the scalar algorithm and continue it over the scalar epilogue.
+  T s[2 * L], c[2 * L];
+  s1.store_unaligned(&s[0]);
+  s2.store_unaligned(&s[L]);
+  c1.store_unaligned(&c[0]);
+  c2.store_unaligned(&c[L]);
+  T sum = 0, comp = 0;
+  auto step = [&](T x) {
+    T t = sum + x;
+    comp += std::abs(sum) >= std::abs(x) ? (sum - t) + x : (x - t) + sum;
+    sum = t;
+  };
+  for (int j = 0; j < 2 * L; ++j) {
+    step(s[j]);
+    comp += c[j];
+  }
+  for (; i < N; ++i)
+    step(vector[i]);
+  return sum + comp;
+}
+
+template <class T>
+void SumFloatingPoint(benchmark::State& state, const std::string& key, T (*sum)(const T*, int)) {
+  if (!ValidateSumFloat<T>(state, key, sum)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillColumn(vector, N);
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = sum(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+  SetRelativeError(state, res, ReferenceSum(vector, N));
+}
+
+void BM_SumVectorFloat(benchmark::State& state, const char* variant, float (*sum)(const float*, int)) {
+  SumFloatingPoint(state, std::string("BM_SumVectorFloat/") + variant, sum);
+}
+BENCHMARK_CAPTURE(BM_SumVectorFloat, plain, "plain", SumPlain<float>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, plain, "plain", SumPlain<float>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, pairwise, "pairwise", SumPairwise<float>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, pairwise, "pairwise", SumPairwise<float>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, compensated, "compensated", SumCompensated<float>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorFloat, compensated, "compensated", SumCompensated<float>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_SumVectorDouble(benchmark::State& state, const char* variant, double (*sum)(const double*, int)) {
+  SumFloatingPoint(state, std::string("BM_SumVectorDouble/") + variant, sum);
+}
+BENCHMARK_CAPTURE(BM_SumVectorDouble, plain, "plain", SumPlain<double>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, plain, "plain", SumPlain<double>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, pairwise, "pairwise", SumPairwise<double>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, pairwise, "pairwise", SumPairwise<double>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, compensated, "compensated", SumCompensated<double>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_SumVectorDouble, compensated, "compensated", SumCompensated<double>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Min/max of a random column, and the index of its first smallest or largest element, for int,
+// float and double. N must be at least 1.
+template <class T, bool Max>
+xsimd::batch<T, xsimd::avx2> Better(xsimd::batch<T, xsimd::avx2> a, xsimd::batch<T, xsimd::avx2> b) {
+  return Max ? xsimd::max(a, b) : xsimd::min(a, b);
+}
+
+template <class T, bool Max>
+T Extreme(const T* vector, int N) {
+  using batch_type = xsimd::batch<T, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  if (N < L) return Max ? *std::max_element(vector, vector + N) : *std::min_element(vector, vector + N);
+
+  batch_type r1 = batch_type::load_unaligned(vector), r2 = r1, r3 = r1, r4 = r1;
+  int i = L;
+  for (; i + 4 * L <= N; i += 4 * L) {
+    r1 = Better<T, Max>(r1, batch_type::load_unaligned(&vector[i]));
+    r2 = Better<T, Max>(r2, batch_type::load_unaligned(&vector[i + L]));
+    r3 = Better<T, Max>(r3, batch_type::load_unaligned(&vector[i + 2 * L]));
+    r4 = Better<T, Max>(r4, batch_type::load_unaligned(&vector[i + 3 * L]));
+  }
+  for (; i + L <= N; i += L)
+    r1 = Better<T, Max>(r1, batch_type::load_unaligned(&vector[i]));
+  // Min and max are idempotent, so the last N % L elements come in as one batch ending at vector[N - 1].
+  if (i < N) r2 = Better<T, Max>(r2, batch_type::load_unaligned(&vector[N - L]));
+
+  batch_type r = Better<T, Max>(Better<T, Max>(r1, r2), Better<T, Max>(r3, r4));
+  return Max ? xsimd::reduce_max(r) : xsimd::reduce_min(r);
+}
+
+// Two accumulators, each with the index every lane's best value came from. The indices are integers
+// as wide as T, so the compare mask casts straight to them. Both accumulators share one index batch
+// holding the indices of the first of the pair; the second adds L when the lanes are folded.
+template <class T, bool Max>
+int ArgExtreme(const T* vector, int N) {
+  using batch_type = xsimd::batch<T, xsimd::avx2>;
+  using I = xsimd::as_integer_t<T>;
+  using index_type = xsimd::batch<I, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  T res = vector[0];
+  int res_at = 0, i = 0;
+
+  if (N >= 2 * L) {
+    alignas(32) I lanes[L];
+    std::iota(lanes, lanes + L, I(0));
+    batch_type b1 = batch_type::load_unaligned(vector), b2 = batch_type::load_unaligned(&vector[L]);
+    index_type base = index_type::load_aligned(lanes), a1 = base, a2 = base;
+    const index_type step(I(2 * L));
+
+    for (i = 2 * L; i + 2 * L <= N; i += 2 * L) {
+      base = base + step;
+      batch_type x1 = batch_type::load_unaligned(&vector[i]);
+      batch_type x2 = batch_type::load_unaligned(&vector[i + L]);
+      // Strict compares, so every lane keeps the first of equal values it sees.
+      auto m1 = Max ? b1 < x1 : x1 < b1;
+      auto m2 = Max ? b2 < x2 : x2 < b2;
+      b1 = xsimd::select(m1, x1, b1);
+      b2 = xsimd::select(m2, x2, b2);
+      a1 = xsimd::select(xsimd::batch_bool_cast<I>(m1), base, a1);
+      a2 = xsimd::select(xsimd::batch_bool_cast<I>(m2), base, a2);
     }
 
-    batch_type s = s1 + s2;
-    int t[8];
+    // Among equal values the smaller index wins, so the result is the first occurrence.
+    T best[2 * L];
+    I at[2 * L];
+    b1.store_unaligned(&best[0]);
+    b2.store_unaligned(&best[L]);
+    a1.store_unaligned(&at[0]);
+    (a2 + index_type(I(L))).store_unaligned(&at[L]);
+    for (int j = 0; j < 2 * L; ++j) {
+      if ((Max ? res < best[j] : best[j] < res) || (best[j] == res && at[j] < res_at)) {
+        res = best[j];
+        res_at = int(at[j]);
+      }
+    }
+  }
 
-    s.store_aligned(&t[0]);
-    
-    for (int i = 0; i < 8; ++i) 
-      res += t[i];
+  // Everything left comes after every index above, so only a strictly better value replaces it.
+  for (; i < N; ++i) {
+    if (Max ? res < vector[i] : vector[i] < res) {
+      res = vector[i];
+      res_at = i;
+    }
+  }
+  return res_at;
+}
+
+template <class T>
+void BM_MinMaxVector(benchmark::State& state, T (*extreme)(const T*, int), bool largest) {
+  if (!ValidateExtreme<T>(state, "BM_MinMaxVector/" + std::string(largest ? "max_" : "min_") + TypeKey<T>(), extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  T res = 0;
+
+  for (auto _ : PerfLoop(state)) {
+    res = extreme(vector, N);
 
     benchmark::DoNotOptimize(res);
     benchmark::ClobberMemory();
   }
+
+  if (res != vector[ReferenceArgExtreme(vector, N, largest)]) state.SkipWithError("wrong min/max");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_i32, Extreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_i32, Extreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f32, Extreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f32, Extreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, min_f64, Extreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_MinMaxVector, max_f64, Extreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ArgMinMaxVector(benchmark::State& state, int (*arg_extreme)(const T*, int), bool largest) {
+  if (!ValidateArgExtreme<T>(state, "BM_ArgMinMaxVector/" + std::string(largest ? "argmax_" : "argmin_") + TypeKey<T>(), arg_extreme, largest)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  FillRandomRange(vector, state.range(0), state.range(1));
+  int res = -1;
+
+  for (auto _ : PerfLoop(state)) {
+    res = arg_extreme(vector, N);
+
+    benchmark::DoNotOptimize(res);
+    benchmark::ClobberMemory();
+  }
+
+  if (res != ReferenceArgExtreme(vector, N, largest)) state.SkipWithError("wrong argmin/argmax");
+  SetThroughput(state, N, int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_i32, ArgExtreme<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_i32, ArgExtreme<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f32, ArgExtreme<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f32, ArgExtreme<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmin_f64, ArgExtreme<double, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ArgMinMaxVector, argmax_f64, ArgExtreme<double, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Inclusive and exclusive prefix sums of row lengths (int) and of a [0, 1) column (float), checked
+// against a sequential scan, next to std::inclusive_scan / std::exclusive_scan on the same data.
+// Each batch is scanned in registers and offset by the running total, which every lane holds.
+struct LastIndex {
+  static constexpr unsigned get(unsigned, unsigned size) { return size - 1; }
+};
+
+// slide_left moves the whole batch up by that many bytes and shifts in zeros, so log2(L)
+// shift-and-add steps leave lane j holding x[0] + ... + x[j].
+template <class T>
+xsimd::batch<T, xsimd::avx2> ScanBatch(xsimd::batch<T, xsimd::avx2> x) {
+  static_assert(xsimd::batch<T, xsimd::avx2>::size == 8, "three steps scan 8 lanes");
+  x = x + xsimd::slide_left<sizeof(T)>(x);
+  x = x + xsimd::slide_left<2 * sizeof(T)>(x);
+  return x + xsimd::slide_left<4 * sizeof(T)>(x);
+}
+
+// The carry only depends on the previous carry and the current batch's own scan, so the
+// loop-carried chain is one add per batch.
+template <class T, bool Inclusive>
+void PrefixSum(const T* in, T* out, int N) {
+  using batch_type = xsimd::batch<T, xsimd::avx2>;
+  using index_type = xsimd::batch<xsimd::as_unsigned_integer_t<T>, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  batch_type carry(T(0));
+  int i = 0;
+
+  for (; i + L <= N; i += L) {
+    batch_type p = ScanBatch(batch_type::load_unaligned(&in[i]));
+    ((Inclusive ? p : xsimd::slide_left<sizeof(T)>(p)) + carry).store_unaligned(&out[i]);
+    carry = carry + xsimd::swizzle(p, xsimd::make_batch_constant<index_type, LastIndex>());
+  }
+
+  // Scalar epilogue for the last N % L elements.
+  T acc = carry.get(0);
+  for (; i < N; ++i) {
+    if (!Inclusive) out[i] = acc;
+    acc += in[i];
+    if (Inclusive) out[i] = acc;
+  }
+}
+
+template <class T>
+void PrefixSumOf(benchmark::State& state, const std::string& key, void (*scan)(const T*, T*, int), bool inclusive) {
+  if (!ValidateScan<T>(state, key, scan, inclusive)) return;
+  int N = state.range(1)-state.range(0);
+  aligned_buffer<T> in_buffer(N);
+  aligned_buffer<T> out_buffer(N);
+  T* in = in_buffer.data();
+  T* out = out_buffer.data();
+  if constexpr (std::is_integral_v<T>) FillLengths(in, N);
+  else FillColumn(in, N);
+
+  for (auto _ : PerfLoop(state)) {
+    scan(in, out, N);
+
+    benchmark::ClobberMemory();
+  }
+
+  CheckPrefixSum(state, in, out, N, inclusive);
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+
+template <class T>
+void BM_ScanVector(benchmark::State& state, void (*scan)(const T*, T*, int), bool inclusive) {
+  PrefixSumOf(state, "BM_ScanVector/" + std::string(inclusive ? "inclusive_" : "exclusive_") + TypeKey<T>(), scan, inclusive);
+}
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_i32, PrefixSum<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_i32, PrefixSum<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_i32, PrefixSum<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_i32, PrefixSum<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_f32, PrefixSum<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, inclusive_f32, PrefixSum<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_f32, PrefixSum<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVector, exclusive_f32, PrefixSum<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// The sequential baseline: every output depends on the one before it.
+template <class T, bool Inclusive>
+void StdPrefixSum(const T* in, T* out, int N) {
+  if (Inclusive) std::inclusive_scan(in, in + N, out);
+  else std::exclusive_scan(in, in + N, out, T(0));
+}
+
+template <class T>
+void BM_ScanVectorStd(benchmark::State& state, void (*scan)(const T*, T*, int), bool inclusive) {
+  PrefixSumOf(state, "BM_ScanVectorStd/" + std::string(inclusive ? "inclusive_" : "exclusive_") + TypeKey<T>(), scan, inclusive);
+}
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_i32, StdPrefixSum<int, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_i32, StdPrefixSum<int, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_i32, StdPrefixSum<int, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_i32, StdPrefixSum<int, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_f32, StdPrefixSum<float, true>, true)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, inclusive_f32, StdPrefixSum<float, true>, true)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_f32, StdPrefixSum<float, false>, false)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ScanVectorStd, exclusive_f32, StdPrefixSum<float, false>, false)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Lane i of the swizzled batch takes lane size - 1 - i; xsimd picks the shuffle for each width.
+struct ReverseIndex {
+  static constexpr unsigned get(unsigned index, unsigned size) { return size - 1 - index; }
+};
+
+template <class T>
+xsimd::batch<T, xsimd::avx2> ReverseBatch(xsimd::batch<T, xsimd::avx2> x) {
+  using index_type = xsimd::batch<xsimd::as_unsigned_integer_t<T>, xsimd::avx2>;
+  return xsimd::swizzle(x, xsimd::make_batch_constant<index_type, ReverseIndex>());
+}
+
+void ReverseVector(int* vector, int N) {
+  using batch_type = xsimd::batch<int, xsimd::avx2>;
+  int i = 0;
+  for (; i + 8 <= N / 2; i += 8) {
+    batch_type simd_vector1 = xsimd::load_aligned(&vector[i]);
+    batch_type simd_vector2 = xsimd::load_unaligned(&vector[N - i - 8]); // not 32-byte aligned when N % 8 != 0
+
+    simd_vector1 = ReverseBatch(simd_vector1);
+    simd_vector2 = ReverseBatch(simd_vector2);
+
+    simd_vector2.store_aligned(&vector[i]);
+    simd_vector1.store_unaligned(&vector[N - i - 8]);
+  }
+  std::reverse(&vector[i], &vector[N - i]);
 }
-BENCHMARK(BM_SumVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
 
 void BM_ReverseVector(benchmark::State& state) {
+  if (!ValidateReverse<int>(state, "BM_ReverseVector", ReverseVector, 32)) return;
   int N = state.range(1) - state.range(0);
-  int vector[N];
+  aligned_buffer<int> buffer(N);
+  int* vector = buffer.data();
   std::iota (vector, vector + N, state.range(0));
 
-  using batch_type = xsimd::batch<int, xsimd::avx2>;
-  for (auto _ : state) {
-    for (int i = 0; i < N / 2; i += 8) {
-      batch_type simd_vector1 = xsimd::load_aligned(&vector[i]);
-      batch_type simd_vector2 = xsimd::load_aligned(&vector[N - i - 8]);
+  for (auto _ : PerfLoop(state)) {
+    ReverseVector(vector, N);
 
-      simd_vector1 = xsimd::rotate_left<8>(simd_vector1);
-      simd_vector2 = xsimd::rotate_left<8>(simd_vector2);
+    benchmark::ClobberMemory();
+  }
 
-      simd_vector2.store_aligned(&vector[i]);
-      simd_vector1.store_aligned(&vector[N - i - 8]);
-    }
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(int));
+}
+BENCHMARK(BM_ReverseVector)->Args({0, 4096})->Args({0, 4097})->Args({0, 4111})->Args({0, 4127})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK(BM_ReverseVector)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// In-place reverse at any width. The middle uses two overlapping batches, both loaded before
+// either store, so only fewer than L elements go through the scalar loop.
+template <class T>
+void ReverseInPlace(T* vector, int N) {
+  constexpr int L = xsimd::batch<T, xsimd::avx2>::size;
+  int lo = 0, hi = N;
+
+  for (; hi - lo >= 2 * L; lo += L, hi -= L) {
+    auto simd_vector1 = xsimd::batch<T, xsimd::avx2>::load_unaligned(&vector[lo]);
+    auto simd_vector2 = xsimd::batch<T, xsimd::avx2>::load_unaligned(&vector[hi - L]);
+    ReverseBatch(simd_vector2).store_unaligned(&vector[lo]);
+    ReverseBatch(simd_vector1).store_unaligned(&vector[hi - L]);
+  }
+  if (hi - lo >= L) {
+    auto simd_vector1 = xsimd::batch<T, xsimd::avx2>::load_unaligned(&vector[lo]);
+    auto simd_vector2 = xsimd::batch<T, xsimd::avx2>::load_unaligned(&vector[hi - L]);
+    ReverseBatch(simd_vector2).store_unaligned(&vector[lo]);
+    ReverseBatch(simd_vector1).store_unaligned(&vector[hi - L]);
+    return;
+  }
+  std::reverse(&vector[lo], &vector[hi]);
+}
+
+// result[i] = vector[N - 1 - i]. The last N % L outputs come from one batch ending at result[N - 1].
+template <class T>
+void ReverseCopy(const T* vector, T* result, int N) {
+  constexpr int L = xsimd::batch<T, xsimd::avx2>::size;
+  int i = 0;
+
+  for (; i + L <= N; i += L)
+    ReverseBatch(xsimd::batch<T, xsimd::avx2>::load_unaligned(&vector[N - i - L])).store_unaligned(&result[i]);
+  if (i < N && N >= L) {
+    ReverseBatch(xsimd::batch<T, xsimd::avx2>::load_unaligned(&vector[0])).store_unaligned(&result[N - L]);
+    return;
+  }
+  std::reverse_copy(&vector[0], &vector[N - i], &result[i]);
+}
+
+// Reverse at every element width, in place and into a second buffer. N counts elements; compare
+// bytes_per_second across widths.
+template <class T>
+void BM_ReverseVectorWidth(benchmark::State& state, void (*reverse)(T*, int)) {
+  if (!ValidateReverse<T>(state, "BM_ReverseVectorWidth/" + TypeKey<T>(), reverse)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse(vector, N);
 
     benchmark::ClobberMemory();
   }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
 }
-BENCHMARK(BM_ReverseVector)->Args({0, 4096})->MinTime(0.5)->Repetitions(1000);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u8, ReverseInPlace<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u16, ReverseInPlace<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u32, ReverseInPlace<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseVectorWidth, u64, ReverseInPlace<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+template <class T>
+void BM_ReverseCopyVector(benchmark::State& state, void (*reverse_copy)(const T*, T*, int)) {
+  if (!ValidateReverseCopy<T>(state, "BM_ReverseCopyVector/" + TypeKey<T>(), reverse_copy)) return;
+  int N = state.range(1) - state.range(0);
+  aligned_buffer<T> buffer(N), result(N);
+  T* vector = buffer.data();
+  std::iota (vector, vector + N, T(state.range(0)));
+
+  for (auto _ : PerfLoop(state)) {
+    reverse_copy(vector, result.data(), N);
+
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetThroughput(state, N, 2 * int64_t(N) * sizeof(T));
+}
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u8, ReverseCopy<uint8_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u16, ReverseCopy<uint16_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u32, ReverseCopy<uint32_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Args({0, 4096})->Args({0, 4097})->MinTime(0.5)->Repetitions(10);
+BENCHMARK_CAPTURE(BM_ReverseCopyVector, u64, ReverseCopy<uint64_t>)->Apply(RangeSweep)->MinTime(0.5)->Repetitions(10);
+
+// Element-wise kernels from L1-resident to DRAM-sized arrays (ElementwiseSweep), with bytes/s and
+// FLOP/s to set against the machine's peaks: add out = a + b, AXPY y = alpha * x + y, FMA
+// out = a * x + b and the triad out = b + q * c.
+// One xsimd::fma per AVX2 batch, the library spelling of _mm256_fmadd_pd.
+void AddArrays(const double* a, const double* b, double* out, int N) {
+  using batch_type = xsimd::batch<double, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    batch_type av = batch_type::load_unaligned(&a[i]), bv = batch_type::load_unaligned(&b[i]);
+    (av + bv).store_unaligned(&out[i]);
+  }
+  for (; i < N; ++i)
+    out[i] = a[i] + b[i];
+}
+
+void Axpy(double alpha, const double* x, double* y, int N) {
+  using batch_type = xsimd::batch<double, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  const batch_type va(alpha);
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    batch_type xv = batch_type::load_unaligned(&x[i]), yv = batch_type::load_unaligned(&y[i]);
+    xsimd::fma(va, xv, yv).store_unaligned(&y[i]);
+  }
+  for (; i < N; ++i)
+    y[i] = alpha * x[i] + y[i];
+}
+
+void MultiplyAdd(const double* a, const double* x, const double* b, double* out, int N) {
+  using batch_type = xsimd::batch<double, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    batch_type av = batch_type::load_unaligned(&a[i]), xv = batch_type::load_unaligned(&x[i]), bv = batch_type::load_unaligned(&b[i]);
+    xsimd::fma(av, xv, bv).store_unaligned(&out[i]);
+  }
+  for (; i < N; ++i)
+    out[i] = a[i] * x[i] + b[i];
+}
+
+void Triad(const double* b, const double* c, double q, double* out, int N) {
+  using batch_type = xsimd::batch<double, xsimd::avx2>;
+  constexpr int L = batch_type::size;
+  const batch_type vq(q);
+  int i = 0;
+  for (; i + L <= N; i += L) {
+    batch_type bv = batch_type::load_unaligned(&b[i]), cv = batch_type::load_unaligned(&c[i]);
+    xsimd::fma(vq, cv, bv).store_unaligned(&out[i]);
+  }
+  for (; i < N; ++i)
+    out[i] = b[i] + q * c[i];
+}
+
+void BM_AddArrays(benchmark::State& state) {
+  if (!ValidateAdd(state, "BM_AddArrays", AddArrays)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    AddArrays(v.a.data(), v.b.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 1);
+}
+BENCHMARK(BM_AddArrays)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Axpy(benchmark::State& state) {
+  if (!ValidateAxpy(state, "BM_Axpy", Axpy)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Axpy(kElementwiseScale, v.a.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Axpy)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_MultiplyAdd(benchmark::State& state) {
+  if (!ValidateMultiplyAdd(state, "BM_MultiplyAdd", MultiplyAdd)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    MultiplyAdd(v.a.data(), v.b.data(), v.c.data(), v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 4, 2);
+}
+BENCHMARK(BM_MultiplyAdd)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+void BM_Triad(benchmark::State& state) {
+  if (!ValidateTriad(state, "BM_Triad", Triad)) return;
+  int N = state.range(0);
+  ElementwiseArrays v(N);
+
+  for (auto _ : PerfLoop(state)) {
+    Triad(v.b.data(), v.c.data(), kElementwiseScale, v.out.data(), N);
+
+    benchmark::DoNotOptimize(v.out.data());
+    benchmark::ClobberMemory();
+  }
+
+  SetElementwiseCounters(state, N, 3, 2);
+}
+BENCHMARK(BM_Triad)->Apply(ElementwiseSweep)->MinTime(0.5)->Repetitions(10);
+
+} // namespace
 
-BENCHMARK_MAIN();
+BACKEND_MAIN();